@@ -0,0 +1,70 @@
+/**
+MIT License
+
+Copyright (c) 2018 NVIDIA CORPORATION. All rights reserved.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*
+*/
+
+#include "mapped_file.h"
+
+#include <cassert>
+#include <fcntl.h>
+#include <iostream>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+MappedFile::MappedFile(const std::string& filePath) :
+    m_FilePath(filePath),
+    m_Data(nullptr),
+    m_Size(0)
+{
+    const int fd = open(m_FilePath.c_str(), O_RDONLY);
+    if (fd < 0)
+    {
+        std::cout << "Unable to open file : " << m_FilePath << std::endl;
+        assert(0);
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size <= 0)
+    {
+        std::cout << "Unable to map empty or unreadable file : " << m_FilePath << std::endl;
+        close(fd);
+        assert(0);
+    }
+    m_Size = static_cast<size_t>(st.st_size);
+    void* addr = mmap(nullptr, m_Size, PROT_READ, MAP_PRIVATE, fd, 0);
+    // the mapping holds its own reference to the file
+    close(fd);
+    if (addr == MAP_FAILED)
+    {
+        std::cout << "mmap failed for file : " << m_FilePath << std::endl;
+        assert(0);
+    }
+    // the file is consumed front to back, let the kernel read ahead aggressively
+    madvise(addr, m_Size, MADV_SEQUENTIAL);
+    m_Data = static_cast<const uint8_t*>(addr);
+}
+
+MappedFile::~MappedFile()
+{
+    if (m_Data) munmap(const_cast<uint8_t*>(m_Data), m_Size);
+}
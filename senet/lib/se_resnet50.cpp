@@ -299,13 +299,10 @@ void SE_ResNet50::createSE_Resnet50Engine(const unsigned int maxBatchSize,
     assert(modelStream != nullptr);
 
     // write data to output file
-    std::stringstream gieModelStream;
-    gieModelStream.seekg(0, gieModelStream.beg);
-    gieModelStream.write(static_cast<const char*>(modelStream->data()), modelStream->size());
-    std::ofstream outFile;
-    outFile.open(m_PlanFilePath);
-    outFile << gieModelStream.rdbuf();
+    std::ofstream outFile(m_PlanFilePath, std::ios_base::binary | std::ios_base::trunc);
+    outFile.write(static_cast<const char*>(modelStream->data()), modelStream->size());
     outFile.close();
+    assert(outFile.good());
     std::cout << "Serialized plan file cached at location : " << m_PlanFilePath << std::endl;
 
     // Don't need the network any more
@@ -24,7 +24,9 @@ SOFTWARE.
 */
 
 #include "trt_utils.h"
+#include "mapped_file.h"
 
+#include <chrono>
 #include <experimental/filesystem>
 #include <fstream>
 
@@ -99,29 +101,20 @@ std::vector<std::string> getSynsets( std::string fileName){
 
 nvinfer1::ICudaEngine* loadTRTEngine(const std::string planFilePath, nvinfer1::ILogger& logger)
 {
-    // reading the model in memory
+    // the plan is deserialized straight out of a read-only mapping of the file
     std::cout << "Loading TRT Engine..." << std::endl;
     assert(fileExists(planFilePath));
-    std::stringstream trtModelStream;
-    trtModelStream.seekg(0, trtModelStream.beg);
-    std::ifstream cache(planFilePath);
-    assert(cache.good());
-    trtModelStream << cache.rdbuf();
-    cache.close();
-
-    // calculating model size
-    trtModelStream.seekg(0, std::ios::end);
-    const int modelSize = trtModelStream.tellg();
-    trtModelStream.seekg(0, std::ios::beg);
-    void* modelMem = malloc(modelSize);
-    trtModelStream.read((char*) modelMem, modelSize);
+    auto start = std::chrono::steady_clock::now();
+    MappedFile plan(planFilePath);
 
     nvinfer1::IRuntime* runtime = nvinfer1::createInferRuntime(logger);
     nvinfer1::ICudaEngine* engine
-        = runtime->deserializeCudaEngine(modelMem, modelSize, nullptr);
-    free(modelMem);
+        = runtime->deserializeCudaEngine(plan.data(), plan.size(), nullptr);
     runtime->destroy();
-    std::cout << "Loading Complete!" << std::endl;
+    auto end = std::chrono::steady_clock::now();
+    std::cout << "Loading Complete! Read " << plan.size() << " bytes from " << planFilePath
+              << " in " << std::chrono::duration<double, std::milli>(end - start).count()
+              << " ms" << std::endl;
 
     return engine;
 }
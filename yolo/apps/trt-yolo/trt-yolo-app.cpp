@@ -23,6 +23,7 @@ SOFTWARE.
 *
 */
 #include "ds_image.h"
+#include "pipeline.h"
 #include "trt_utils.h"
 #include "yolo.h"
 #include "yolo_config_parser.h"
@@ -31,8 +32,35 @@ SOFTWARE.
 
 #include <experimental/filesystem>
 #include <fstream>
+#include <memory>
 #include <string>
 #include <sys/time.h>
+#include <thread>
+
+// A batch of test images on its way through the stages of the pipeline
+struct Batch
+{
+    // Position of the batch in the image list, used to write results in order
+    uint index = 0;
+    std::vector<std::string> imagePaths;
+    std::vector<DsImage> images;
+    cv::Mat blob;
+    std::vector<DetectionArena> arenas;
+    std::vector<std::string> jsonStrings;
+    double inferMs = 0;
+    double postMs = 0;
+};
+typedef std::unique_ptr<Batch> BatchPtr;
+
+static void printStageStats(const PipelineStageStats& stats)
+{
+    std::cout << "Stage : " << stats.name << " Threads : " << stats.numThreads
+              << " Busy time per image : "
+              << (stats.numItems ? stats.busyMs / stats.numItems : 0) << " ms"
+              << " Waiting on input : " << stats.starvedMs << " ms"
+              << " Waiting on output : " << stats.blockedMs << " ms"
+              << " Throughput : " << stats.getThroughput() << " images/s" << std::endl;
+}
 
 int main(int argc, char** argv)
 {
@@ -56,6 +84,7 @@ int main(int argc, char** argv)
     std::string saveDetectionsPath = getSaveDetectionsPath();
     uint batchSize = getBatchSize();
     bool shuffleTestSet = getShuffleTestSet();
+    bool reducedJpegDecode = getReducedJpegDecode();
 
     srand(unsigned(seed));
 
@@ -86,57 +115,138 @@ int main(int argc, char** argv)
     {
         std::random_shuffle(imageList.begin(), imageList.end(), [](int i) { return rand() % i; });
     }
-    std::vector<DsImage> dsImages;
     const int barWidth = 70;
     double inferElapsed = 0;
+    double postElapsed = 0;
 
     std::ofstream fout;
     bool written = false;
     if (doBenchmark)
     {
         size_t extIndex = testImages.find_last_of(".txt");
+        // Results of the different suppression rules are kept apart so they can be compared
+        std::string nmsSuffix
+            = yoloInferParams.nmsType == "hard" ? "" : "_" + yoloInferParams.nmsType;
         fout.open(testImages.substr(0, extIndex - 3) + "_" + networkType + "_" + precision
-                  + "_results.json");
+                  + nmsSuffix + "_results.json");
         fout << "[";
     }
-    // Batched inference loop
-    for (uint loopIdx = 0; loopIdx < imageList.size(); loopIdx += batchSize)
-    {
-        // Load a new batch
-        dsImages.clear();
-        for (uint imageIdx = loopIdx;
-             imageIdx < std::min((loopIdx + batchSize), static_cast<uint>(imageList.size()));
-             ++imageIdx)
+
+    // Batches flow through load -> preprocess -> infer -> post on their own threads and are
+    // written in order on this one, so loading batch N + 1 overlaps the inference of batch N.
+    // Inference runs on a single thread as the engine reuses its input and output buffers.
+    struct timeval pipelineStart, pipelineEnd;
+    gettimeofday(&pipelineStart, NULL);
+    const uint pipelineDepth = getPipelineDepth();
+    BoundedQueue<BatchPtr> loadQueue(pipelineDepth), preprocessQueue(pipelineDepth),
+        inferQueue(pipelineDepth), postQueue(pipelineDepth), writeQueue(pipelineDepth);
+    std::thread batchFeeder([&]() {
+        for (uint loopIdx = 0; loopIdx < imageList.size(); loopIdx += batchSize)
         {
-            dsImages.emplace_back(imageList.at(imageIdx), inferNet->getInputH(),
-                                  inferNet->getInputW());
+            BatchPtr batch{new Batch};
+            batch->index = loopIdx / batchSize;
+            batch->imagePaths.assign(
+                imageList.begin() + loopIdx,
+                imageList.begin()
+                    + std::min(loopIdx + batchSize, static_cast<uint>(imageList.size())));
+            loadQueue.push(std::move(batch));
         }
+        loadQueue.close();
+    });
+    const PipelineStage<BatchPtr>::ItemCount batchImages
+        = [](const BatchPtr& batch) { return static_cast<uint>(batch->imagePaths.size()); };
 
-        cv::Mat trtInput = blobFromDsImages(dsImages, inferNet->getInputH(), inferNet->getInputW());
-        struct timeval inferStart, inferEnd;
-        gettimeofday(&inferStart, NULL);
-        inferNet->doInference(trtInput.data, dsImages.size());
-        gettimeofday(&inferEnd, NULL);
-        inferElapsed += ((inferEnd.tv_sec - inferStart.tv_sec)
-                         + (inferEnd.tv_usec - inferStart.tv_usec) / 1000000.0)
-            * 1000;
+    PipelineStage<BatchPtr> loadStage(
+        "load", getLoadThreads(), loadQueue, preprocessQueue,
+        [&](BatchPtr& batch) {
+            for (auto& path : batch->imagePaths)
+                batch->images.emplace_back(path, inferNet->getInputH(), inferNet->getInputW(),
+                                           reducedJpegDecode, inferNet->getLetterboxFilter());
+        },
+        batchImages);
+    PipelineStage<BatchPtr> preprocessStage(
+        "preprocess", getPreprocessThreads(), preprocessQueue, inferQueue,
+        [&](BatchPtr& batch) {
+            // every preprocess thread spreads its batches over a pool of its own
+            static thread_local WorkerPool preProcessPool(getPreProcessWorkers());
+            batch->blob = blobFromDsImages(batch->images, inferNet->getInputH(),
+                                           inferNet->getInputW(), &preProcessPool);
+        },
+        batchImages);
+    PipelineStage<BatchPtr> inferStage(
+        "infer", 1, inferQueue, postQueue,
+        [&](BatchPtr& batch) {
+            struct timeval inferStart, inferEnd;
+            gettimeofday(&inferStart, NULL);
+            inferNet->doInference(batch->blob.data, batch->images.size());
+            gettimeofday(&inferEnd, NULL);
+            batch->inferMs = ((inferEnd.tv_sec - inferStart.tv_sec)
+                              + (inferEnd.tv_usec - inferStart.tv_usec) / 1000000.0)
+                * 1000;
+            batch->blob = cv::Mat();
+            if (!decode) return;
 
-        if (decode)
+            // Proposals are decoded here as the output buffers are overwritten by the next batch
+            batch->arenas.resize(batch->images.size());
+            for (uint imageIdx = 0; imageIdx < batch->images.size(); ++imageIdx)
+            {
+                const DsImage& curImage = batch->images.at(imageIdx);
+                DetectionArena& arena = batch->arenas.at(imageIdx);
+                arena.reserve(inferNet->getNumClasses(), inferNet->getMaxProposals());
+                gettimeofday(&inferStart, NULL);
+                inferNet->decodeDetections(imageIdx, curImage.getImageHeight(),
+                                           curImage.getImageWidth(), arena.proposals);
+                gettimeofday(&inferEnd, NULL);
+                batch->postMs += ((inferEnd.tv_sec - inferStart.tv_sec)
+                                  + (inferEnd.tv_usec - inferStart.tv_usec) / 1000000.0)
+                    * 1000;
+            }
+        },
+        batchImages);
+    PipelineStage<BatchPtr> postStage(
+        "post", getPostThreads(), postQueue, writeQueue,
+        [&](BatchPtr& batch) {
+            if (!decode) return;
+            for (uint imageIdx = 0; imageIdx < batch->images.size(); ++imageIdx)
+            {
+                DsImage& curImage = batch->images.at(imageIdx);
+                DetectionArena& arena = batch->arenas.at(imageIdx);
+                struct timeval postStart, postEnd;
+                gettimeofday(&postStart, NULL);
+                nmsAllClasses(inferNet->getNMSParams(), inferNet->getNumClasses(), arena);
+                gettimeofday(&postEnd, NULL);
+                batch->postMs += ((postEnd.tv_sec - postStart.tv_sec)
+                                  + (postEnd.tv_usec - postStart.tv_usec) / 1000000.0)
+                    * 1000;
+                for (auto b : arena.detections)
+                    curImage.addBBox(b, inferNet->getClassName(b.label));
+                if (doBenchmark) batch->jsonStrings.push_back(curImage.exportJson());
+            }
+        },
+        batchImages);
+
+    // Write stage, batches are put back in order before their results are written
+    PipelineStageStats writeStats{"write", 1, 0, 0.0, 0.0, 0.0};
+    ReorderBuffer<BatchPtr> pendingBatches;
+    uint numWritten = 0;
+    BatchPtr batch, curBatch;
+    while (writeQueue.pop(batch))
+    {
+        const uint batchIdx = batch->index;
+        pendingBatches.push(batchIdx, std::move(batch));
+        while (pendingBatches.pop(curBatch))
         {
-            for (uint imageIdx = 0; imageIdx < dsImages.size(); ++imageIdx)
+            struct timeval writeStart, writeEnd;
+            gettimeofday(&writeStart, NULL);
+            inferElapsed += curBatch->inferMs;
+            postElapsed += curBatch->postMs;
+            for (uint imageIdx = 0; decode && (imageIdx < curBatch->images.size()); ++imageIdx)
             {
-                auto curImage = dsImages.at(imageIdx);
-                auto binfo = inferNet->decodeDetections(imageIdx, curImage.getImageHeight(),
-                                                        curImage.getImageWidth());
-                auto remaining
-                    = nmsAllClasses(inferNet->getNMSThresh(), binfo, inferNet->getNumClasses());
-                for (auto b : remaining)
+                const DsImage& curImage = curBatch->images.at(imageIdx);
+                if (inferNet->isPrintPredictions())
                 {
-                    if (inferNet->isPrintPredictions())
-                    {
+                    for (auto b : curBatch->arenas.at(imageIdx).detections)
                         printPredictions(b, inferNet->getClassName(b.label));
-                    }
-                    curImage.addBBox(b, inferNet->getClassName(b.label));
                 }
 
                 if (saveDetections)
@@ -151,7 +261,7 @@ int main(int argc, char** argv)
 
                 if (doBenchmark)
                 {
-                    std::string jsonString = curImage.exportJson();
+                    const std::string& jsonString = curBatch->jsonStrings.at(imageIdx);
                     if (jsonString == "") continue;
                     if (written)
                         fout << "," << jsonString;
@@ -160,24 +270,41 @@ int main(int argc, char** argv)
                     written = true;
                 }
             }
-        }
+            numWritten += curBatch->images.size();
+            curBatch.reset();
+            gettimeofday(&writeEnd, NULL);
+            writeStats.busyMs += ((writeEnd.tv_sec - writeStart.tv_sec)
+                                  + (writeEnd.tv_usec - writeStart.tv_usec) / 1000000.0)
+                * 1000;
+            writeStats.numItems = numWritten;
 
-        std::cout << "[";
-        int progress = ((loopIdx + dsImages.size()) * 100) / imageList.size();
-        progress = progress > 100 ? 100 : progress;
-        int pos = (barWidth * progress) / 100;
-        for (int i = 0; i < pos; ++i)
-        {
-            std::cout << "=";
-        }
-        if (pos < barWidth) std::cout << ">";
-        for (int i = pos; i < barWidth; ++i)
-        {
-            std::cout << " ";
+            std::cout << "[";
+            int progress = (numWritten * 100) / imageList.size();
+            progress = progress > 100 ? 100 : progress;
+            int pos = (barWidth * progress) / 100;
+            for (int i = 0; i < pos; ++i)
+            {
+                std::cout << "=";
+            }
+            if (pos < barWidth) std::cout << ">";
+            for (int i = pos; i < barWidth; ++i)
+            {
+                std::cout << " ";
+            }
+            std::cout << "] " << progress << " %\r";
+            std::cout.flush();
         }
-        std::cout << "] " << progress << " %\r";
-        std::cout.flush();
     }
+    batchFeeder.join();
+    loadStage.join();
+    preprocessStage.join();
+    inferStage.join();
+    postStage.join();
+    gettimeofday(&pipelineEnd, NULL);
+    const double pipelineElapsed = ((pipelineEnd.tv_sec - pipelineStart.tv_sec)
+                                    + (pipelineEnd.tv_usec - pipelineStart.tv_usec) / 1000000.0)
+        * 1000;
+
     if (doBenchmark)
     {
         fout << std::endl << "]";
@@ -189,6 +316,19 @@ int main(int argc, char** argv)
               << " Batch Size : " << batchSize
               << " Inference time per image : " << inferElapsed / imageList.size() << " ms"
               << std::endl;
+    if (decode)
+    {
+        std::cout << "NMS type : " << yoloInferParams.nmsType
+                  << " Decode + NMS time per image : " << postElapsed / imageList.size() << " ms"
+                  << std::endl;
+    }
+    for (auto stats : {loadStage.getStats(), preprocessStage.getStats(), inferStage.getStats(),
+                       postStage.getStats(), writeStats})
+    {
+        printStageStats(stats);
+    }
+    std::cout << "Pipeline throughput : " << imageList.size() * 1000.0 / pipelineElapsed
+              << " images/s" << std::endl;
 
     return 0;
 }
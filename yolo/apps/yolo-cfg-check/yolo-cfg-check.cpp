@@ -0,0 +1,99 @@
+/**
+MIT License
+
+Copyright (c) 2018 NVIDIA CORPORATION. All rights reserved.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*
+*/
+#include "yolo_cfg.h"
+
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+
+static std::string shapeToString(const LayerShape& shape)
+{
+    std::stringstream ss;
+    ss << shape.channels << " x " << shape.height << " x " << shape.width;
+    return ss.str();
+}
+
+static std::string paramsToString(const LayerDesc& layer)
+{
+    std::stringstream ss;
+    switch (layer.type)
+    {
+    case LayerType::kConvolutional:
+        ss << layer.conv.kernelSize << "x" << layer.conv.kernelSize << "/" << layer.conv.stride
+           << (layer.conv.batchNormalize ? " bn-leaky" : " linear");
+        break;
+    case LayerType::kMaxpool:
+        ss << layer.maxpool.size << "x" << layer.maxpool.size << "/" << layer.maxpool.stride;
+        break;
+    case LayerType::kRoute:
+        // printed as layer numbers, like the layer column
+        for (const uint idx : layer.route.inputs) ss << idx + 1 << " ";
+        break;
+    case LayerType::kShortcut: ss << "+ " << layer.shortcut.input + 1; break;
+    case LayerType::kUpsample: ss << "x" << layer.upsample.stride; break;
+    case LayerType::kReorg: ss << "/" << layer.reorg.stride; break;
+    case LayerType::kYolo:
+    case LayerType::kRegion:
+        ss << layer.detection.numBBoxes << " boxes " << layer.detection.numClasses << " classes";
+        break;
+    }
+    return ss.str();
+}
+
+// Parses every cfg given on the command line and prints the validated layers. Invalid cfgs are
+// reported with the line at fault
+int main(int argc, char** argv)
+{
+    if (argc < 2)
+    {
+        std::cout << "Usage : yolo-cfg-check </path/to/network.cfg> [more cfgs...]" << std::endl;
+        return -1;
+    }
+    for (int arg = 1; arg < argc; ++arg)
+    {
+        const NetworkDesc network = parseNetworkCfg(argv[arg]);
+        std::cout << network.cfgFilePath << " : input " << network.inputC << " x "
+                  << network.inputH << " x " << network.inputW << std::endl;
+        std::cout << std::left << std::setw(6) << "layer" << std::setw(6) << "line"
+                  << std::setw(15) << "type" << std::setw(20) << "params" << std::setw(18)
+                  << "input" << "output" << std::endl;
+        for (const LayerDesc& layer : network.layers)
+        {
+            std::cout << std::left << std::setw(6) << layer.layerIdx << std::setw(6)
+                      << layer.lineNumber << std::setw(15) << getLayerTypeName(layer.type)
+                      << std::setw(20) << paramsToString(layer) << std::setw(18)
+                      << shapeToString(layer.input) << shapeToString(layer.output) << std::endl;
+        }
+
+        uint64_t numWeights = 0;
+        for (const ConvLayerInfo& conv : getConvLayers(network))
+            numWeights += conv.numDarknetWeights();
+        std::cout << network.layers.size() << " layers, " << getOutputLayers(network).size()
+                  << " output layers, " << numWeights << " darknet weights" << std::endl
+                  << std::endl;
+    }
+    return 0;
+}
@@ -0,0 +1,127 @@
+/**
+MIT License
+
+Copyright (c) 2018 NVIDIA CORPORATION. All rights reserved.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*
+*/
+#include "cost_model.h"
+
+#include <iostream>
+#include <string>
+
+static std::string escapeJson(const std::string& s)
+{
+    std::string escaped;
+    for (const char c : s)
+    {
+        if (c == '"' || c == '\\') escaped += '\\';
+        escaped += c;
+    }
+    return escaped;
+}
+
+static std::string shapeToJson(const uint channels, const uint height, const uint width)
+{
+    return "[" + std::to_string(channels) + ", " + std::to_string(height) + ", "
+        + std::to_string(width) + "]";
+}
+
+// Prints the static cost of a network as JSON, see cost_model.h
+int main(int argc, char** argv)
+{
+    if (argc < 2 || argc > 5)
+    {
+        std::cout << "Usage : yolo-cost-model </path/to/network.cfg> [batch_size] "
+                     "[input_size|WxH] [kFLOAT|kHALF|kINT8]"
+                  << std::endl;
+        return -1;
+    }
+    const std::string cfgFilePath = argv[1];
+    const uint batchSize = argc > 2 ? std::stoul(argv[2]) : 1;
+    // <size> or <width>x<height>, 0 keeps the input size of the cfg
+    uint inputW = 0;
+    uint inputH = 0;
+    if (argc > 3)
+    {
+        const std::string inputSize = argv[3];
+        const size_t xpos = inputSize.find('x');
+        inputW = std::stoul(inputSize.substr(0, xpos));
+        inputH = (xpos == std::string::npos) ? inputW : std::stoul(inputSize.substr(xpos + 1));
+    }
+    const std::string precision = argc > 4 ? argv[4] : "kFLOAT";
+    uint bytesPerElement;
+    if (precision == "kFLOAT")
+        bytesPerElement = 4;
+    else if (precision == "kHALF")
+        bytesPerElement = 2;
+    else if (precision == "kINT8")
+        bytesPerElement = 1;
+    else
+    {
+        std::cout << "Invalid precision : " << precision << std::endl;
+        return -1;
+    }
+    if (batchSize == 0)
+    {
+        std::cout << "Invalid batch size : " << batchSize << std::endl;
+        return -1;
+    }
+
+    const NetworkDesc network = parseNetworkCfg(cfgFilePath, inputW, inputH);
+    const NetworkCost cost = getNetworkCost(network, batchSize, bytesPerElement);
+
+    std::cout << "{" << std::endl
+              << "  \"cfg\": \"" << escapeJson(cfgFilePath) << "\"," << std::endl
+              << "  \"batchSize\": " << batchSize << "," << std::endl
+              << "  \"input\": " << shapeToJson(network.inputC, network.inputH, network.inputW)
+              << "," << std::endl
+              << "  \"precision\": \"" << precision << "\"," << std::endl
+              << "  \"bytesPerElement\": " << bytesPerElement << "," << std::endl
+              << "  \"totalMACs\": " << cost.totalMACs << "," << std::endl
+              << "  \"totalWeightBytes\": " << cost.totalWeightBytes << "," << std::endl
+              << "  \"totalActivationBytes\": " << cost.totalActivationBytes << "," << std::endl
+              << "  \"peakLiveBytes\": " << cost.peakLiveBytes << "," << std::endl
+              << "  \"peakLayer\": " << cost.peakLayerIdx << "," << std::endl
+              << "  \"layers\": [" << std::endl;
+    for (uint i = 0; i < cost.layers.size(); ++i)
+    {
+        const LayerCost& layerCost = cost.layers.at(i);
+        std::string type = "input";
+        uint line = 0;
+        std::string output = shapeToJson(network.inputC, network.inputH, network.inputW);
+        if (i > 0)
+        {
+            const LayerDesc& layer = network.getLayer(layerCost.layerIdx);
+            type = getLayerTypeName(layer.type);
+            line = layer.lineNumber;
+            output = shapeToJson(layer.output.channels, layer.output.height, layer.output.width);
+        }
+        std::cout << "    {\"layer\": " << layerCost.layerIdx << ", \"line\": " << line
+                  << ", \"type\": \"" << type << "\", \"output\": " << output
+                  << ", \"macs\": " << layerCost.macs
+                  << ", \"weightBytes\": " << layerCost.weightBytes
+                  << ", \"activationBytes\": " << layerCost.activationBytes
+                  << ", \"liveBytes\": " << layerCost.liveBytes << "}"
+                  << (i + 1 < cost.layers.size() ? "," : "") << std::endl;
+    }
+    std::cout << "  ]" << std::endl << "}" << std::endl;
+    return 0;
+}
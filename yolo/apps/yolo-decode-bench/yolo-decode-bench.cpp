@@ -0,0 +1,124 @@
+/**
+MIT License
+
+Copyright (c) 2018 NVIDIA CORPORATION. All rights reserved.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*
+*/
+
+#include "jpeg_decode.h"
+#include "letterbox.h"
+
+#include <opencv2/core/core.hpp>
+#include <opencv2/highgui/highgui.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <experimental/filesystem>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <string>
+#include <vector>
+
+template <typename Func>
+static double timeMs(const Func& func)
+{
+    const auto start = std::chrono::steady_clock::now();
+    func();
+    const auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+// Decodes and letterboxes every JPEG of a directory in full and at reduced size
+int main(int argc, char** argv)
+{
+    if ((argc < 2) || (argc > 3))
+    {
+        std::cout << "Usage : yolo-decode-bench <jpeg_dir> [input_size|WxH]" << std::endl;
+        return -1;
+    }
+    uint inputW = 608, inputH = 608;
+    if (argc > 2)
+    {
+        const std::string size = argv[2];
+        const size_t sep = size.find('x');
+        inputW = std::stoul(size.substr(0, sep));
+        inputH = sep == std::string::npos ? inputW : std::stoul(size.substr(sep + 1));
+    }
+
+    std::vector<std::string> paths;
+    for (const auto& entry : std::experimental::filesystem::directory_iterator(argv[1]))
+    {
+        std::string ext = entry.path().extension().string();
+        std::transform(ext.begin(), ext.end(), ext.begin(), ::tolower);
+        if ((ext == ".jpg") || (ext == ".jpeg")) paths.push_back(entry.path().string());
+    }
+    if (paths.empty())
+    {
+        std::cout << "No JPEG files found in " << argv[1] << std::endl;
+        return -1;
+    }
+    std::sort(paths.begin(), paths.end());
+
+    const int dims[] = {1, 3, static_cast<int>(inputH), static_cast<int>(inputW)};
+    cv::Mat fullBlob(4, dims, CV_32F), reducedBlob(4, dims, CV_32F);
+    double fullMs = 0, reducedMs = 0, megapixels = 0, meanDiff = 0;
+    std::map<uint, uint> scaleDenoms;
+    for (const auto& path : paths)
+    {
+        cv::Mat full, reduced;
+        uint origW = 0, origH = 0, scaleDenom = 1;
+        fullMs += timeMs([&]() {
+            full = cv::imread(path, cv::IMREAD_COLOR);
+            const LetterboxPlan plan = getLetterboxPlan(full.cols, full.rows, inputW, inputH);
+            letterboxToCHW(plan, full.data, full.step[0], true, fullBlob.ptr<float>(0));
+        });
+        reducedMs += timeMs([&]() {
+            reduced = imreadForLetterbox(path, inputW, inputH, origW, origH, scaleDenom);
+            const LetterboxPlan plan
+                = getLetterboxPlan(origW, origH, inputW, inputH, scaleDenom);
+            letterboxToCHW(plan, reduced.data, reduced.step[0], true, reducedBlob.ptr<float>(0));
+        });
+        if ((origW != static_cast<uint>(full.cols)) || (origH != static_cast<uint>(full.rows)))
+        {
+            std::cout << "Original size mismatch for " << path << " : " << origW << "x" << origH
+                      << " instead of " << full.cols << "x" << full.rows << std::endl;
+            return -1;
+        }
+        megapixels += full.total() / 1e6;
+        meanDiff += cv::norm(fullBlob, reducedBlob, cv::NORM_L1) / fullBlob.total();
+        ++scaleDenoms[scaleDenom];
+    }
+
+    const uint numImages = paths.size();
+    std::cout << std::fixed << std::setprecision(3) << numImages << " images, "
+              << megapixels / numImages << " MP on average, input " << inputW << "x" << inputH
+              << std::endl;
+    std::cout << "Scale down :";
+    for (const auto& scaleDenom : scaleDenoms)
+        std::cout << " 1/" << scaleDenom.first << " x" << scaleDenom.second;
+    std::cout << std::endl;
+    std::cout << "Decode + letterbox per image, full : " << fullMs / numImages
+              << " ms reduced : " << reducedMs / numImages << " ms speedup : "
+              << fullMs / reducedMs << "x" << std::endl;
+    std::cout << "Mean |diff| of the input blobs : " << meanDiff / numImages << std::endl;
+    return 0;
+}
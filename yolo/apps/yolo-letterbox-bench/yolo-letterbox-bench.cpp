@@ -0,0 +1,126 @@
+/**
+MIT License
+
+Copyright (c) 2018 NVIDIA CORPORATION. All rights reserved.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*
+*/
+
+#include "letterbox.h"
+
+#include <opencv2/core/core.hpp>
+#include <opencv2/dnn/dnn.hpp>
+#include <opencv2/imgproc/imgproc.hpp>
+
+#include <chrono>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <string>
+
+// The preprocessing chain the fused letterbox replaced: resize, pad, swap channels, then
+// convert and transpose into a planar float blob
+static cv::Mat letterboxOpenCV(const cv::Mat& image, const LetterboxPlan& plan,
+                               const int interpolation)
+{
+    cv::Mat resized, bordered, rgb, stacked;
+    cv::resize(image, resized, cv::Size(plan.resizeW, plan.resizeH), 0, 0, interpolation);
+    cv::copyMakeBorder(resized, bordered, plan.yOffset, plan.yOffset, plan.xOffset,
+                       plan.xOffset, cv::BORDER_CONSTANT,
+                       cv::Scalar(kLetterboxPadValue, kLetterboxPadValue, kLetterboxPadValue));
+    cv::cvtColor(bordered, rgb, CV_BGR2RGB);
+    rgb.copyTo(stacked);
+    return cv::dnn::blobFromImage(stacked, 1.0, cv::Size(plan.dstW, plan.dstH),
+                                  cv::Scalar(0.0, 0.0, 0.0), false, false);
+}
+
+template <typename Func>
+static double timeMs(const uint iterations, const Func& func)
+{
+    const auto start = std::chrono::steady_clock::now();
+    for (uint i = 0; i < iterations; ++i) func();
+    const auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::milli>(end - start).count() / iterations;
+}
+
+// Times the fused letterbox against the OpenCV chain on random 720p, 1080p and 4K frames
+int main(int argc, char** argv)
+{
+    if (argc > 3)
+    {
+        std::cout << "Usage : yolo-letterbox-bench [input_size|WxH] [iterations]" << std::endl;
+        return -1;
+    }
+    uint inputW = 608, inputH = 608;
+    if (argc > 1)
+    {
+        const std::string size = argv[1];
+        const size_t sep = size.find('x');
+        inputW = std::stoul(size.substr(0, sep));
+        inputH = sep == std::string::npos ? inputW : std::stoul(size.substr(sep + 1));
+    }
+    const uint iterations = argc > 2 ? std::stoul(argv[2]) : 100;
+
+    const int frameSizes[][2] = {{1280, 720}, {1920, 1080}, {3840, 2160}};
+    std::cout << "Input " << inputW << "x" << inputH << ", " << iterations
+              << " iterations, ms per frame" << std::endl;
+    std::cout << std::setw(10) << "frame" << std::setw(12) << "cubic" << std::setw(12)
+              << "linear" << std::setw(12) << "fused" << std::setw(12) << "speedup"
+              << std::setw(16) << "mean |diff|" << std::setw(14) << "fused cubic" << std::setw(16)
+              << "mean |diff|" << std::endl;
+    for (const auto& frameSize : frameSizes)
+    {
+        cv::Mat frame(frameSize[1], frameSize[0], CV_8UC3);
+        cv::randu(frame, cv::Scalar::all(0), cv::Scalar::all(256));
+        cv::GaussianBlur(frame, frame, cv::Size(5, 5), 0);
+        const LetterboxPlan plan = getLetterboxPlan(frame.cols, frame.rows, inputW, inputH);
+        const LetterboxPlan cubicPlan = getLetterboxPlan(frame.cols, frame.rows, inputW, inputH,
+                                                         1, LetterboxFilter::kCUBIC);
+        const int dims[] = {1, 3, static_cast<int>(inputH), static_cast<int>(inputW)};
+        cv::Mat fused(4, dims, CV_32F);
+        cv::Mat fusedCubic(4, dims, CV_32F);
+
+        const double cubicMs
+            = timeMs(iterations, [&]() { letterboxOpenCV(frame, plan, cv::INTER_CUBIC); });
+        const double linearMs
+            = timeMs(iterations, [&]() { letterboxOpenCV(frame, plan, cv::INTER_LINEAR); });
+        const double fusedMs = timeMs(iterations, [&]() {
+            letterboxToCHW(plan, frame.data, frame.step[0], true, fused.ptr<float>(0));
+        });
+        const double fusedCubicMs = timeMs(iterations, [&]() {
+            letterboxToCHW(cubicPlan, frame.data, frame.step[0], true, fusedCubic.ptr<float>(0));
+        });
+
+        // both are bilinear, OpenCV rounds the resized image to 8 bits first
+        const cv::Mat reference = letterboxOpenCV(frame, plan, cv::INTER_LINEAR);
+        const double meanDiff = cv::norm(reference, fused, cv::NORM_L1) / reference.total();
+        const cv::Mat cubicReference = letterboxOpenCV(frame, plan, cv::INTER_CUBIC);
+        const double cubicMeanDiff
+            = cv::norm(cubicReference, fusedCubic, cv::NORM_L1) / cubicReference.total();
+
+        std::cout << std::fixed << std::setprecision(3) << std::setw(10)
+                  << (std::to_string(frameSize[0]) + "x" + std::to_string(frameSize[1]))
+                  << std::setw(12) << cubicMs << std::setw(12) << linearMs << std::setw(12)
+                  << fusedMs << std::setw(11) << cubicMs / fusedMs << "x" << std::setw(16)
+                  << meanDiff << std::setw(14) << fusedCubicMs << std::setw(16) << cubicMeanDiff
+                  << std::endl;
+    }
+    return 0;
+}
@@ -0,0 +1,232 @@
+/**
+MIT License
+
+Copyright (c) 2018 NVIDIA CORPORATION. All rights reserved.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*
+*/
+
+#include "nms.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <new>
+#include <random>
+#include <string>
+#include <vector>
+
+// Heap allocations made by the process, counted by the replaced global operator new
+static uint64_t g_NumAllocations = 0;
+
+void* operator new(size_t size)
+{
+    ++g_NumAllocations;
+    void* ptr = std::malloc(size ? size : 1);
+    if (!ptr) throw std::bad_alloc();
+    return ptr;
+}
+
+void operator delete(void* ptr) noexcept { std::free(ptr); }
+
+// Proposals clustered around numBoxes / 10 objects of a frameW x frameH image, as decoded
+// proposals are, so that suppression has overlapping boxes to remove
+static std::vector<BBoxInfo> makeProposals(const uint numBoxes, const uint numClasses,
+                                           const float frameW, const float frameH,
+                                           std::mt19937& rng)
+{
+    std::uniform_real_distribution<float> uniform(0.0f, 1.0f);
+    const uint numObjects = std::max(numBoxes / 10, 1u);
+    std::vector<BBox> objects(numObjects);
+    std::vector<int> labels(numObjects);
+    for (uint i = 0; i < numObjects; ++i)
+    {
+        const float w = 20 + 180 * uniform(rng), h = 20 + 180 * uniform(rng);
+        const float x = (frameW - w) * uniform(rng), y = (frameH - h) * uniform(rng);
+        objects.at(i) = BBox{x, y, x + w, y + h};
+        labels.at(i) = rng() % numClasses;
+    }
+
+    std::vector<BBoxInfo> proposals(numBoxes);
+    for (uint i = 0; i < numBoxes; ++i)
+    {
+        const uint o = rng() % numObjects;
+        const BBox& object = objects.at(o);
+        const float jitter = 0.1f * (object.x2 - object.x1);
+        BBoxInfo& proposal = proposals.at(i);
+        proposal.box = BBox{object.x1 + jitter * (uniform(rng) - 0.5f),
+                            object.y1 + jitter * (uniform(rng) - 0.5f),
+                            object.x2 + jitter * (uniform(rng) - 0.5f),
+                            object.y2 + jitter * (uniform(rng) - 0.5f)};
+        proposal.label = labels.at(o);
+        proposal.classId = proposal.label;
+        proposal.prob = 0.5f + 0.5f * uniform(rng);
+    }
+    return proposals;
+}
+
+static bool sameDetections(const std::vector<BBoxInfo>& a, const std::vector<BBoxInfo>& b)
+{
+    if (a.size() != b.size()) return false;
+    for (uint i = 0; i < a.size(); ++i)
+    {
+        if ((a.at(i).box.x1 != b.at(i).box.x1) || (a.at(i).box.y1 != b.at(i).box.y1)
+            || (a.at(i).box.x2 != b.at(i).box.x2) || (a.at(i).box.y2 != b.at(i).box.y2)
+            || (a.at(i).label != b.at(i).label) || (a.at(i).prob != b.at(i).prob))
+            return false;
+    }
+    return true;
+}
+
+template <typename Func>
+static double timeMs(const uint iterations, const Func& func)
+{
+    const auto start = std::chrono::steady_clock::now();
+    for (uint i = 0; i < iterations; ++i) func(i);
+    const auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::milli>(end - start).count() / iterations;
+}
+
+// Per frame NMS through a fresh arena, as the vector returning nmsAllClasses does, against one
+// arena reused across frames
+static bool benchArena(const uint iterations)
+{
+    const uint kNumFrames = 8;
+    const float nmsThresh = 0.45f;
+    const NMSParams params{nmsThresh, 0, NMSEngine::kGREEDY, false, NMSType::kHARD, 0, 0};
+    std::cout << "Arena, 1280x720 frames, nms_thresh " << nmsThresh << ", " << iterations
+              << " iterations, per frame" << std::endl;
+    std::cout << std::setw(10) << "proposals" << std::setw(10) << "classes" << std::setw(14)
+              << "fresh ms" << std::setw(14) << "fresh allocs" << std::setw(14) << "reused ms"
+              << std::setw(16) << "reused allocs" << std::endl;
+
+    std::mt19937 rng(1234);
+    const uint cases[][2] = {{300, 6}, {300, 80}, {3000, 80}};
+    for (const auto& c : cases)
+    {
+        std::vector<std::vector<BBoxInfo>> frames;
+        for (uint f = 0; f < kNumFrames; ++f)
+            frames.push_back(makeProposals(c[0], c[1], 1280, 720, rng));
+
+        std::vector<BBoxInfo> detections;
+        uint64_t allocations = g_NumAllocations;
+        const double freshMs = timeMs(iterations, [&](const uint i) {
+            detections = nmsAllClasses(nmsThresh, frames.at(i % kNumFrames), c[1]);
+        });
+        const double freshAllocs
+            = static_cast<double>(g_NumAllocations - allocations) / iterations;
+
+        // warm the arena up on every frame first, steady state is what is measured
+        DetectionArena arena;
+        for (const auto& frame : frames)
+        {
+            arena.proposals = frame;
+            nmsAllClasses(params, c[1], arena);
+        }
+        allocations = g_NumAllocations;
+        const double reusedMs = timeMs(iterations, [&](const uint i) {
+            arena.proposals = frames.at(i % kNumFrames);
+            nmsAllClasses(params, c[1], arena);
+        });
+        const double reusedAllocs
+            = static_cast<double>(g_NumAllocations - allocations) / iterations;
+
+        // both last suppressed the same frame
+        if (!sameDetections(detections, arena.detections))
+        {
+            std::cout << "Arena and fresh NMS disagree" << std::endl;
+            return false;
+        }
+        std::cout << std::fixed << std::setprecision(3) << std::setw(10) << c[0] << std::setw(10)
+                  << c[1] << std::setw(14) << freshMs << std::setw(14) << std::setprecision(1)
+                  << freshAllocs << std::setw(14) << std::setprecision(3) << reusedMs
+                  << std::setw(16) << std::setprecision(1) << reusedAllocs << std::endl;
+    }
+    return true;
+}
+
+// The greedy, grid and SIMD engines on a single class of a 4K frame. Every size runs on about
+// as many boxes in total, so the quadratic greedy engine stays affordable at 10k boxes
+static bool benchEngines(const uint iterations)
+{
+    const float nmsThresh = 0.45f;
+    std::string simdPath = "scalar";
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f"))
+        simdPath = "AVX-512";
+    else if (__builtin_cpu_supports("avx2"))
+        simdPath = "AVX2";
+#endif
+    std::cout << "Engines, one class of a 3840x2160 frame, nms_thresh " << std::setprecision(2)
+              << nmsThresh
+              << ", simd runs " << simdPath << ", ms per frame" << std::endl;
+    std::cout << std::setw(10) << "boxes" << std::setw(12) << "iterations" << std::setw(12)
+              << "greedy" << std::setw(12) << "grid" << std::setw(12) << "simd" << std::setw(12)
+              << "speedup" << std::setw(10) << "kept" << std::endl;
+
+    std::mt19937 rng(1234);
+    for (const uint numBoxes : {100u, 1000u, 10000u})
+    {
+        const std::vector<BBoxInfo> proposals = makeProposals(numBoxes, 1, 3840, 2160, rng);
+        const uint runs = std::max(1u, iterations * 1000 / numBoxes);
+        double engineMs[3];
+        std::vector<BBoxInfo> detections[3];
+        const NMSEngine engines[] = {NMSEngine::kGREEDY, NMSEngine::kGRID, NMSEngine::kSIMD};
+        for (uint e = 0; e < 3; ++e)
+        {
+            const NMSParams params{nmsThresh, 0, engines[e], false, NMSType::kHARD, 0, 0};
+            DetectionArena arena;
+            engineMs[e] = timeMs(runs, [&](const uint) {
+                arena.proposals = proposals;
+                nmsAllClasses(params, 1, arena);
+            });
+            detections[e] = arena.detections;
+        }
+        if (!sameDetections(detections[0], detections[1])
+            || !sameDetections(detections[0], detections[2]))
+        {
+            std::cout << "Engines disagree on " << numBoxes << " boxes" << std::endl;
+            return false;
+        }
+        std::cout << std::fixed << std::setprecision(3) << std::setw(10) << numBoxes
+                  << std::setw(12) << runs << std::setw(12) << engineMs[0] << std::setw(12)
+                  << engineMs[1] << std::setw(12) << engineMs[2] << std::setw(11)
+                  << engineMs[0] / engineMs[2] << "x" << std::setw(10) << detections[0].size()
+                  << std::endl;
+    }
+    return true;
+}
+
+// Times per frame suppression on synthetic proposals
+int main(int argc, char** argv)
+{
+    if (argc > 2)
+    {
+        std::cout << "Usage : yolo-nms-bench [iterations]" << std::endl;
+        return -1;
+    }
+    const uint iterations = argc > 1 ? std::stoul(argv[1]) : 100;
+    if (!benchArena(iterations)) return -1;
+    std::cout << std::endl;
+    return benchEngines(iterations) ? 0 : -1;
+}
@@ -0,0 +1,294 @@
+/**
+MIT License
+
+Copyright (c) 2018 NVIDIA CORPORATION. All rights reserved.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*
+*/
+
+#include "yolo_activations.h"
+#include "yolo_cfg.h"
+#include "yolo_decode.h"
+
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+/**
+ * Output of the network for one image, as the decoders read it from the host buffers.
+ */
+struct SyntheticOutput
+{
+    // activated tensors, as returned by the yolo and region layers
+    std::vector<std::vector<float>> activated;
+    // raw conv outputs of the yolo layers, as returned with --logit_decode
+    std::vector<std::vector<float>> raw;
+};
+
+// Fills the outputs with background anchors of low objectness and numObjects anchors, spread
+// over the tensors, holding a confident detection
+static SyntheticOutput makeOutput(const std::vector<TensorInfo>& tensors,
+                                  const std::vector<bool>& isRegion, const uint numObjects,
+                                  std::mt19937& rng)
+{
+    std::uniform_real_distribution<float> uniform(0.0f, 1.0f);
+    SyntheticOutput output;
+    for (uint t = 0; t < tensors.size(); ++t)
+    {
+        const TensorInfo& tensor = tensors.at(t);
+        const uint numGridCells = tensor.gridW * tensor.gridH;
+        const uint numChannels = 5 + tensor.numClasses;
+        std::vector<float> values(tensor.volume);
+        for (uint b = 0; b < tensor.numBBoxes; ++b)
+        {
+            float* anchor = values.data() + b * numChannels * numGridCells;
+            for (uint i = 0; i < numGridCells; ++i)
+            {
+                if (isRegion.at(t))
+                {
+                    // x, y, objectness and classes are activated, w and h are not
+                    anchor[i] = uniform(rng);
+                    anchor[i + numGridCells] = uniform(rng);
+                    anchor[i + 2 * numGridCells] = uniform(rng) - 0.5f;
+                    anchor[i + 3 * numGridCells] = uniform(rng) - 0.5f;
+                    anchor[i + 4 * numGridCells] = 0.05f * uniform(rng);
+                    for (uint c = 0; c < tensor.numClasses; ++c)
+                        anchor[i + (5 + c) * numGridCells] = 0.02f * uniform(rng);
+                }
+                else
+                {
+                    // logits, activated below
+                    anchor[i] = 4 * uniform(rng) - 2;
+                    anchor[i + numGridCells] = 4 * uniform(rng) - 2;
+                    anchor[i + 2 * numGridCells] = uniform(rng) - 0.5f;
+                    anchor[i + 3 * numGridCells] = uniform(rng) - 0.5f;
+                    anchor[i + 4 * numGridCells] = -3 - 9 * uniform(rng);
+                    for (uint c = 0; c < tensor.numClasses; ++c)
+                        anchor[i + (5 + c) * numGridCells] = -2 - 6 * uniform(rng);
+                }
+            }
+        }
+        for (uint o = t; o < numObjects; o += tensors.size())
+        {
+            const uint b = rng() % tensor.numBBoxes;
+            const uint cell = rng() % numGridCells;
+            const uint label = rng() % tensor.numClasses;
+            float* anchor = values.data() + b * numChannels * numGridCells + cell;
+            anchor[4 * numGridCells] = isRegion.at(t) ? 0.9f : 3.0f;
+            anchor[(5 + label) * numGridCells] = isRegion.at(t) ? 0.9f : 3.0f;
+        }
+
+        if (isRegion.at(t))
+        {
+            output.activated.push_back(values);
+            output.raw.push_back(std::vector<float>());
+        }
+        else
+        {
+            std::vector<float> activated(tensor.volume);
+            yoloLayerV3Activations(values.data(), activated.data(), tensor.gridW, tensor.gridH,
+                                   tensor.numClasses, tensor.numBBoxes);
+            output.activated.push_back(activated);
+            output.raw.push_back(values);
+        }
+    }
+    return output;
+}
+
+// The decode loop before objectness was checked first: the box of every anchor is decoded and
+// its classes scanned before the score is compared against the threshold, into a new vector
+// per tensor
+static std::vector<BBoxInfo> decodeAllAnchors(const TensorInfo& tensor, const bool isRegion,
+                                              const float* detections,
+                                              const DecodeParams& params)
+{
+    const float scalingFactor = std::min(static_cast<float>(params.inputW) / params.imageW,
+                                         static_cast<float>(params.inputH) / params.imageH);
+    const float xOffset = (params.inputW - scalingFactor * params.imageW) / 2;
+    const float yOffset = (params.inputH - scalingFactor * params.imageH) / 2;
+    const uint numGridCells = tensor.gridW * tensor.gridH;
+    const uint numChannels = 5 + tensor.numClasses;
+
+    std::vector<BBoxInfo> binfo;
+    for (uint y = 0; y < tensor.gridH; ++y)
+    {
+        for (uint x = 0; x < tensor.gridW; ++x)
+        {
+            for (uint b = 0; b < tensor.numBBoxes; ++b)
+            {
+                const float* anchor
+                    = detections + y * tensor.gridW + x + numGridCells * (b * numChannels);
+                const uint anchorIdx = isRegion ? b : tensor.masks[b];
+                const float pw = tensor.anchors[anchorIdx * 2];
+                const float ph = tensor.anchors[anchorIdx * 2 + 1];
+                const float bx = x + anchor[0];
+                const float by = y + anchor[numGridCells];
+                const float bw = pw
+                    * (isRegion ? std::exp(anchor[2 * numGridCells]) : anchor[2 * numGridCells]);
+                const float bh = ph
+                    * (isRegion ? std::exp(anchor[3 * numGridCells]) : anchor[3 * numGridCells]);
+                const float objectness = anchor[4 * numGridCells];
+
+                float maxProb = 0.0f;
+                int maxIndex = -1;
+                for (uint i = 0; i < tensor.numClasses; ++i)
+                {
+                    const float prob = anchor[(5 + i) * numGridCells];
+                    if (prob > maxProb)
+                    {
+                        maxProb = prob;
+                        maxIndex = i;
+                    }
+                }
+                maxProb = objectness * maxProb;
+
+                if (maxProb > params.probThresh)
+                {
+                    BBoxInfo bbi;
+                    bbi.box = convertBBoxNetRes(bx, by, bw, bh, tensor.stride, params.inputW,
+                                                params.inputH);
+                    if ((bbi.box.x1 > bbi.box.x2) || (bbi.box.y1 > bbi.box.y2)) continue;
+                    convertBBoxImgRes(scalingFactor, xOffset, yOffset, bbi.box);
+                    bbi.label = maxIndex;
+                    bbi.prob = maxProb;
+                    bbi.classId = params.classIds[maxIndex];
+                    binfo.push_back(bbi);
+                }
+            }
+        }
+    }
+    return binfo;
+}
+
+static bool sameProposals(const std::vector<BBoxInfo>& a, const std::vector<BBoxInfo>& b)
+{
+    if (a.size() != b.size()) return false;
+    for (uint i = 0; i < a.size(); ++i)
+    {
+        if ((a.at(i).box.x1 != b.at(i).box.x1) || (a.at(i).box.y1 != b.at(i).box.y1)
+            || (a.at(i).box.x2 != b.at(i).box.x2) || (a.at(i).box.y2 != b.at(i).box.y2)
+            || (a.at(i).label != b.at(i).label) || (a.at(i).prob != b.at(i).prob))
+            return false;
+    }
+    return true;
+}
+
+template <typename Func>
+static double timeMs(const uint iterations, const Func& func)
+{
+    const auto start = std::chrono::steady_clock::now();
+    for (uint i = 0; i < iterations; ++i) func();
+    const auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::milli>(end - start).count() / iterations;
+}
+
+// Times the decoders of a network on synthetic output tensors holding 0, 30 and 300 objects
+int main(int argc, char** argv)
+{
+    if (argc < 2 || argc > 4)
+    {
+        std::cout << "Usage : yolo-tensor-decode-bench </path/to/network.cfg> [input_size|WxH] "
+                     "[iterations]"
+                  << std::endl;
+        return -1;
+    }
+    // <size> or <width>x<height>, 0 keeps the input size of the cfg
+    uint inputW = 0, inputH = 0;
+    if (argc > 2)
+    {
+        const std::string size = argv[2];
+        const size_t sep = size.find('x');
+        inputW = std::stoul(size.substr(0, sep));
+        inputH = sep == std::string::npos ? inputW : std::stoul(size.substr(sep + 1));
+    }
+    const uint iterations = argc > 3 ? std::stoul(argv[3]) : 100;
+
+    const NetworkDesc network = parseNetworkCfg(argv[1], inputW, inputH);
+    const std::vector<TensorInfo> tensors = getOutputTensors(network, false);
+    const std::vector<TensorInfo> rawTensors = getOutputTensors(network, true);
+    std::vector<bool> isRegion;
+    for (const OutputLayerInfo& outputLayer : getOutputLayers(network))
+        isRegion.push_back(network.getLayer(outputLayer.layerIdx).type == LayerType::kRegion);
+    // region layers have no raw output mode
+    const bool hasLogitDecode
+        = std::find(isRegion.begin(), isRegion.end(), true) == isRegion.end();
+
+    std::vector<int> classIds(tensors.front().numClasses);
+    for (uint i = 0; i < classIds.size(); ++i) classIds.at(i) = i;
+    const DecodeParams params{network.inputW, network.inputH, 1280, 720, 0.5f, classIds.data()};
+
+    std::cout << "Input " << network.inputW << "x" << network.inputH << ", " << tensors.size()
+              << " output tensors, 1280x720 image, prob_thresh 0.5, " << iterations
+              << " iterations, ms per image" << std::endl;
+    std::cout << std::setw(10) << "objects" << std::setw(14) << "decode all" << std::setw(18)
+              << "objectness first" << std::setw(12) << "speedup" << std::setw(12) << "logit"
+              << std::setw(12) << "proposals" << std::endl;
+
+    std::mt19937 rng(1234);
+    std::vector<BBoxInfo> binfo;
+    for (const uint numObjects : {0u, 30u, 300u})
+    {
+        const SyntheticOutput output = makeOutput(tensors, isRegion, numObjects, rng);
+
+        std::vector<BBoxInfo> reference;
+        const double allMs = timeMs(iterations, [&]() {
+            reference.clear();
+            for (uint t = 0; t < tensors.size(); ++t)
+            {
+                const std::vector<BBoxInfo> decoded = decodeAllAnchors(
+                    tensors.at(t), isRegion.at(t), output.activated.at(t).data(), params);
+                reference.insert(reference.end(), decoded.begin(), decoded.end());
+            }
+        });
+        const double firstMs = timeMs(iterations, [&]() {
+            binfo.clear();
+            for (uint t = 0; t < tensors.size(); ++t)
+                tensors.at(t).decoder(tensors.at(t), output.activated.at(t).data(), params,
+                                      binfo);
+        });
+        if (!sameProposals(reference, binfo))
+        {
+            std::cout << "Decoders disagree on " << numObjects << " objects" << std::endl;
+            return -1;
+        }
+
+        std::cout << std::fixed << std::setprecision(3) << std::setw(10) << numObjects
+                  << std::setw(14) << allMs << std::setw(18) << firstMs << std::setw(11)
+                  << allMs / firstMs << "x";
+        if (hasLogitDecode)
+        {
+            const double logitMs = timeMs(iterations, [&]() {
+                binfo.clear();
+                for (uint t = 0; t < rawTensors.size(); ++t)
+                    rawTensors.at(t).decoder(rawTensors.at(t), output.raw.at(t).data(), params,
+                                             binfo);
+            });
+            std::cout << std::setw(12) << logitMs;
+        }
+        else
+            std::cout << std::setw(12) << "-";
+        std::cout << std::setw(12) << reference.size() << std::endl;
+    }
+    return 0;
+}
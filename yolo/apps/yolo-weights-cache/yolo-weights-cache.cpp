@@ -0,0 +1,52 @@
+/**
+MIT License
+
+Copyright (c) 2018 NVIDIA CORPORATION. All rights reserved.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*
+*/
+#include "weights_cache.h"
+
+#include <iostream>
+#include <string>
+#include <sys/time.h>
+
+int main(int argc, char** argv)
+{
+    if (argc != 4)
+    {
+        std::cout << "Usage : yolo-weights-cache </path/to/network.cfg> </path/to/network.weights> "
+                     "</path/to/output.wcache>"
+                  << std::endl;
+        return -1;
+    }
+    const std::string cfgFilePath = argv[1];
+    const std::string wtsFilePath = argv[2];
+    const std::string cachePath = argv[3];
+
+    struct timeval start, end;
+    gettimeofday(&start, NULL);
+    writeWeightsCache(cachePath, cfgFilePath, wtsFilePath);
+    gettimeofday(&end, NULL);
+    std::cout << "Conversion time : "
+              << ((end.tv_sec - start.tv_sec) * 1000000 + (end.tv_usec - start.tv_usec)) / 1000.0
+              << " ms" << std::endl;
+    return 0;
+}
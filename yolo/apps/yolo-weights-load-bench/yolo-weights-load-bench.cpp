@@ -0,0 +1,237 @@
+/**
+MIT License
+
+Copyright (c) 2018 NVIDIA CORPORATION. All rights reserved.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*
+*/
+
+#include "mapped_file.h"
+#include "yolo_cfg.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <stdint.h>
+#include <string>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <vector>
+
+// floats one page of the mapping holds, reading one of them faults the whole page in
+static const size_t kFloatsPerPage = 4096 / sizeof(float);
+
+template <typename Func>
+static double timeMs(const uint iterations, const Func& func)
+{
+    const auto start = std::chrono::steady_clock::now();
+    for (uint i = 0; i < iterations; ++i) func();
+    const auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::milli>(end - start).count() / iterations;
+}
+
+// The loader the mapping replaced: the payload read 4 bytes at a time into a vector, then every
+// conv layer copied a second time into the buffers handed to TensorRT. Returns the number of
+// weights the layers used.
+static uint64_t loadStream(const std::string& wtsFilePath, const size_t headerSize,
+                           const std::vector<ConvLayerInfo>& convLayers)
+{
+    std::ifstream file(wtsFilePath, std::ios_base::binary);
+    file.ignore(headerSize);
+    std::vector<float> weights;
+    char floatWeight[4];
+    while (!file.eof())
+    {
+        file.read(floatWeight, 4);
+        if (file.gcount() != 4) return 0;
+        weights.push_back(*reinterpret_cast<float*>(floatWeight));
+        if (file.peek() == std::istream::traits_type::eof()) break;
+    }
+
+    uint64_t weightPtr = 0;
+    std::vector<float*> copies;
+    for (const ConvLayerInfo& conv : convLayers)
+    {
+        // batch norm parameters went through vectors, the kernel and bias through new float[]
+        std::vector<float> bnParams;
+        if (conv.batchNormalize)
+        {
+            for (uint i = 0; i < 4 * conv.filters; ++i) bnParams.push_back(weights[weightPtr++]);
+        }
+        else
+        {
+            float* bias = new float[conv.filters];
+            for (uint i = 0; i < conv.filters; ++i) bias[i] = weights[weightPtr++];
+            copies.push_back(bias);
+        }
+        const uint64_t kernelSize = conv.filters * conv.kernelVolume();
+        float* kernel = new float[kernelSize];
+        for (uint64_t i = 0; i < kernelSize; ++i) kernel[i] = weights[weightPtr++];
+        copies.push_back(kernel);
+    }
+    for (float* copy : copies) delete[] copy;
+    return weights.size() == weightPtr ? weightPtr : 0;
+}
+
+// The current loader: every layer is a span into the mapping. With touchPages every page of the
+// payload is read, as the TensorRT builder eventually does.
+static uint64_t loadMapped(const std::string& wtsFilePath,
+                           const std::vector<ConvLayerInfo>& convLayers, const bool touchPages)
+{
+    DarknetWeights weights(wtsFilePath);
+    int weightPtr = 0;
+    for (const ConvLayerInfo& conv : convLayers)
+    {
+        if (conv.batchNormalize)
+            weights.span(weightPtr, 4 * conv.filters);
+        else
+            weights.span(weightPtr, conv.filters);
+        weights.span(weightPtr, conv.filters * conv.kernelVolume());
+    }
+    if (touchPages)
+    {
+        volatile float sink = 0.0f;
+        for (size_t i = 0; i < weights.size(); i += kFloatsPerPage) sink = sink + weights.data()[i];
+    }
+    return weights.size() == static_cast<size_t>(weightPtr) ? weightPtr : 0;
+}
+
+// Runs the loader in a child process, so that its peak RSS is not shared with the other loaders.
+// Returns false if the loader did not use up the weights.
+template <typename Func>
+static bool benchIsolated(const std::string& name, const uint iterations,
+                          const uint64_t numWeights, const Func& load)
+{
+    int fds[2];
+    if (pipe(fds) != 0) return false;
+    const pid_t pid = fork();
+    if (pid < 0) return false;
+    if (pid == 0)
+    {
+        close(fds[0]);
+        uint64_t loaded = numWeights;
+        double ms = timeMs(iterations, [&]() { loaded = load(); });
+        if (loaded != numWeights) ms = -1.0;
+        const ssize_t written = write(fds[1], &ms, sizeof(ms));
+        _exit(written == sizeof(ms) ? 0 : 1);
+    }
+    close(fds[1]);
+    double ms = -1.0;
+    const bool received = read(fds[0], &ms, sizeof(ms)) == sizeof(ms);
+    close(fds[0]);
+    int status;
+    struct rusage usage;
+    if (wait4(pid, &status, 0, &usage) != pid || !received || ms < 0.0)
+    {
+        std::cout << name << " did not load the " << numWeights << " weights of the cfg"
+                  << std::endl;
+        return false;
+    }
+    // ru_maxrss is in KB
+    std::cout << std::setw(28) << name << std::fixed << std::setprecision(3) << std::setw(12)
+              << ms << std::setw(18) << std::setprecision(1) << usage.ru_maxrss / 1024.0
+              << std::endl;
+    return true;
+}
+
+// Writes a darknet 0.2 .weights file holding numWeights floats
+static void writeSyntheticWeights(const std::string& wtsFilePath, const uint64_t numWeights)
+{
+    std::ofstream out(wtsFilePath, std::ios_base::binary | std::ios_base::trunc);
+    const int32_t version[3] = {0, 2, 0};
+    const uint64_t seen = 0;
+    out.write(reinterpret_cast<const char*>(version), sizeof(version));
+    out.write(reinterpret_cast<const char*>(&seen), sizeof(seen));
+    std::vector<float> chunk(1 << 16);
+    for (size_t i = 0; i < chunk.size(); ++i) chunk[i] = (i % 1000) / 1000.0f;
+    for (uint64_t written = 0; written < numWeights; written += chunk.size())
+    {
+        const uint64_t count = std::min<uint64_t>(chunk.size(), numWeights - written);
+        out.write(reinterpret_cast<const char*>(chunk.data()), count * sizeof(float));
+    }
+}
+
+// Times loading the weights of a cfg and measures the peak RSS of each loader. Without a
+// .weights file one of the size the cfg implies is synthesized.
+int main(int argc, char** argv)
+{
+    if (argc < 2 || argc > 4)
+    {
+        std::cout << "Usage : yolo-weights-load-bench </path/to/network.cfg> "
+                     "[/path/to/network.weights|synthetic] [iterations]"
+                  << std::endl;
+        return -1;
+    }
+    const std::string cfgFilePath = argv[1];
+    std::string wtsFilePath = argc > 2 ? argv[2] : "synthetic";
+    const uint iterations = argc > 3 ? std::stoul(argv[3]) : 3;
+
+    const std::vector<ConvLayerInfo> convLayers = getConvLayers(parseNetworkCfg(cfgFilePath));
+    uint64_t numWeights = 0;
+    for (const ConvLayerInfo& conv : convLayers) numWeights += conv.numDarknetWeights();
+
+    const bool synthetic = wtsFilePath == "synthetic";
+    if (synthetic)
+    {
+        wtsFilePath = "/tmp/yolo-weights-load-bench." + std::to_string(getpid()) + ".weights";
+        writeSyntheticWeights(wtsFilePath, numWeights);
+    }
+
+    size_t headerSize;
+    {
+        DarknetWeights weights(wtsFilePath);
+        headerSize = weights.getHeaderSize();
+        if (weights.size() != numWeights)
+        {
+            std::cout << wtsFilePath << " holds " << weights.size() << " weights, "
+                      << cfgFilePath << " needs " << numWeights << std::endl;
+            if (synthetic) std::remove(wtsFilePath.c_str());
+            return -1;
+        }
+    }
+    // read once so every loader starts from a warm page cache
+    fileChecksum(wtsFilePath);
+
+    std::cout << cfgFilePath << ", " << convLayers.size() << " conv layers, " << numWeights
+              << " weights (" << std::fixed << std::setprecision(1)
+              << numWeights * sizeof(float) / (1024.0 * 1024.0) << " MB"
+              << (synthetic ? ", synthetic" : "") << "), " << iterations
+              << " iterations, page cache warm" << std::endl;
+    std::cout << std::setw(28) << "loader" << std::setw(12) << "ms" << std::setw(18)
+              << "peak RSS MB" << std::endl;
+
+    bool ok = benchIsolated("none", iterations, numWeights, [&]() { return numWeights; });
+    ok = ok && benchIsolated("istream + copies", iterations, numWeights, [&]() {
+             return loadStream(wtsFilePath, headerSize, convLayers);
+         });
+    ok = ok && benchIsolated("mmap + spans", iterations, numWeights, [&]() {
+             return loadMapped(wtsFilePath, convLayers, false);
+         });
+    ok = ok && benchIsolated("mmap, every page read", iterations, numWeights, [&]() {
+             return loadMapped(wtsFilePath, convLayers, true);
+         });
+
+    if (synthetic) std::remove(wtsFilePath.c_str());
+    return ok ? 0 : -1;
+}
@@ -0,0 +1,69 @@
+# Compares COCO-format result files written by trt-yolo-app with --do_benchmark=true,
+# e.g. one per --nms_type, and reports the mAP of each relative to the first one.
+#
+# Usage : python3 coco_eval.py [--image_list=test_images.txt] instances_val2014.json
+#                              baseline_results.json other_results.json ...
+#
+# Every results file is scored on the same images. With --image_list those are the images of
+# the run, named by their COCO id as the app expects, so images without any detection count as
+# misses. Without it they are the union of the images the results files have detections for.
+import json
+import os
+import sys
+
+from pycocotools.coco import COCO
+from pycocotools.cocoeval import COCOeval
+
+def loadImageIds(imageListFile):
+  with open(imageListFile) as f:
+    paths = [line.strip() for line in f if line.strip()]
+  # trt-yolo-app takes the image id from the file name, see DsImage::exportJson
+  return sorted(set(int(os.path.splitext(os.path.basename(p))[0]) for p in paths))
+
+def detectedImageIds(resultsFiles):
+  imgIds = set()
+  for resultsFile in resultsFiles:
+    with open(resultsFile) as f:
+      imgIds.update(d['image_id'] for d in json.load(f))
+  return sorted(imgIds)
+
+def evaluate(cocoGt, resultsFile, imgIds):
+  cocoDt = cocoGt.loadRes(resultsFile)
+  cocoEval = COCOeval(cocoGt, cocoDt, 'bbox')
+  cocoEval.params.imgIds = imgIds
+  cocoEval.evaluate()
+  cocoEval.accumulate()
+  cocoEval.summarize()
+  # mAP@[.5:.95], mAP@.5 and AR@100
+  return cocoEval.stats[0], cocoEval.stats[1], cocoEval.stats[8]
+
+def main():
+  args = sys.argv[1:]
+  imageListFile = None
+  if args and args[0].startswith('--image_list='):
+    imageListFile = args.pop(0)[len('--image_list='):]
+  if len(args) < 2:
+    print('Usage : python3 coco_eval.py [--image_list=<images.txt>] <annotations.json> '
+          '<results.json> [<results.json> ...]')
+    sys.exit(1)
+
+  cocoGt = COCO(args[0])
+  resultsFiles = args[1:]
+  if imageListFile:
+    imgIds = loadImageIds(imageListFile)
+  else:
+    imgIds = detectedImageIds(resultsFiles)
+    print('No --image_list, scoring the {} images with a detection in any results file. Images '
+          'none of them detected anything in are left out'.format(len(imgIds)))
+  stats = [(resultsFile, evaluate(cocoGt, resultsFile, imgIds)) for resultsFile in resultsFiles]
+
+  baseline = stats[0][1]
+  print('\n{} images'.format(len(imgIds)))
+  print('{:<50} {:>8} {:>8} {:>8} {:>10} {:>10}'.format('results', 'mAP', 'mAP@.5', 'AR@100',
+                                                       'd mAP', 'd AR@100'))
+  for resultsFile, (mAP, mAP50, ar) in stats:
+    print('{:<50} {:>8.4f} {:>8.4f} {:>8.4f} {:>+10.4f} {:>+10.4f}'.format(
+        resultsFile, mAP, mAP50, ar, mAP - baseline[0], ar - baseline[2]))
+
+if __name__ == '__main__':
+  main()
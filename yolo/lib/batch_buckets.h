@@ -0,0 +1,84 @@
+/**
+MIT License
+
+Copyright (c) 2018 NVIDIA CORPORATION. All rights reserved.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*
+*/
+
+#ifndef _BATCH_BUCKETS_H_
+#define _BATCH_BUCKETS_H_
+
+#include <algorithm>
+#include <cassert>
+#include <functional>
+#include <memory>
+#include <sys/types.h>
+#include <vector>
+
+/**
+ * Engines of one network built for a set of batch sizes. Every call runs on the smallest
+ * bucket that holds its frames, so a partially filled batch doesn't pay for kernels tuned to
+ * the largest batch size. The factory is called once per bucket when the set is constructed,
+ * and the set owns the engines until it is destroyed.
+ */
+template <typename Engine>
+class BatchBucketSet
+{
+public:
+    typedef std::function<std::unique_ptr<Engine>(const uint batchSize)> EngineFactory;
+
+    // batchSizes may be in any order, duplicates are dropped
+    BatchBucketSet(std::vector<uint> batchSizes, const EngineFactory& factory)
+    {
+        std::sort(batchSizes.begin(), batchSizes.end());
+        batchSizes.erase(std::unique(batchSizes.begin(), batchSizes.end()), batchSizes.end());
+        assert(!batchSizes.empty() && "At least one batch bucket is required");
+        assert((batchSizes.front() > 0) && "Batch buckets have to be positive");
+        for (const uint batchSize : batchSizes)
+        {
+            m_Engines.push_back(factory(batchSize));
+            assert(m_Engines.back() && "Engine factory failed to create a batch bucket");
+        }
+        m_BatchSizes = batchSizes;
+    }
+    BatchBucketSet(const BatchBucketSet&) = delete;
+    BatchBucketSet& operator=(const BatchBucketSet&) = delete;
+
+    uint getNumBuckets() const { return m_BatchSizes.size(); }
+    uint getBatchSize(const uint bucket) const { return m_BatchSizes.at(bucket); }
+    uint getMaxBatchSize() const { return m_BatchSizes.back(); }
+    Engine& getEngine(const uint bucket) const { return *m_Engines.at(bucket); }
+
+    // Index of the smallest bucket with a batch size of at least numFilled
+    uint selectBucket(const uint numFilled) const
+    {
+        assert((numFilled <= getMaxBatchSize()) && "Batch exceeds the largest batch bucket");
+        return std::lower_bound(m_BatchSizes.begin(), m_BatchSizes.end(), numFilled)
+            - m_BatchSizes.begin();
+    }
+    Engine& select(const uint numFilled) const { return getEngine(selectBucket(numFilled)); }
+
+private:
+    std::vector<uint> m_BatchSizes;
+    std::vector<std::unique_ptr<Engine>> m_Engines;
+};
+
+#endif // _BATCH_BUCKETS_H_
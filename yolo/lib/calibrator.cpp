@@ -32,13 +32,15 @@ Int8EntropyCalibrator::Int8EntropyCalibrator(const uint& batchSize, const std::s
                                              const std::string& calibImagesPath,
                                              const std::string& calibTableFilePath,
                                              const uint64_t& inputSize, const uint& inputH,
-                                             const uint& inputW, const std::string& inputBlobName) :
+                                             const uint& inputW, const std::string& inputBlobName,
+                                             const LetterboxFilter filter) :
     m_BatchSize(batchSize),
     m_InputH(inputH),
     m_InputW(inputW),
     m_InputSize(inputSize),
     m_InputCount(batchSize * inputSize),
     m_InputBlobName(inputBlobName),
+    m_Filter(filter),
     m_CalibTableFilePath(calibTableFilePath),
     m_ImageIndex(0)
 {
@@ -63,7 +65,8 @@ bool Int8EntropyCalibrator::getBatch(void* bindings[], const char* names[], int
     std::vector<DsImage> dsImages(m_BatchSize);
     for (uint j = m_ImageIndex; j < m_ImageIndex + m_BatchSize; ++j)
     {
-        dsImages.at(j - m_ImageIndex) = DsImage(m_ImageList.at(j), m_InputH, m_InputW);
+        dsImages.at(j - m_ImageIndex)
+            = DsImage(m_ImageList.at(j), m_InputH, m_InputW, false, m_Filter);
     }
     m_ImageIndex += m_BatchSize;
 
@@ -35,7 +35,7 @@ public:
     Int8EntropyCalibrator(const uint& batchSize, const std::string& calibImages,
                           const std::string& calibImagesPath, const std::string& calibTableFilePath,
                           const uint64_t& inputSize, const uint& inputH, const uint& inputW,
-                          const std::string& inputBlobName);
+                          const std::string& inputBlobName, const LetterboxFilter filter);
     virtual ~Int8EntropyCalibrator();
 
     int getBatchSize() const override { return m_BatchSize; }
@@ -50,6 +50,7 @@ private:
     const uint64_t m_InputSize;
     const uint64_t m_InputCount;
     const std::string m_InputBlobName;
+    const LetterboxFilter m_Filter;
     const std::string m_CalibTableFilePath{nullptr};
     uint m_ImageIndex;
     bool m_ReadCache{true};
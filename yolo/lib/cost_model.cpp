@@ -0,0 +1,139 @@
+/**
+MIT License
+
+Copyright (c) 2018 NVIDIA CORPORATION. All rights reserved.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*
+*/
+
+#include "cost_model.h"
+
+#include <algorithm>
+
+NetworkCost getNetworkCost(const NetworkDesc& network, const uint batchSize,
+                           const uint bytesPerElement)
+{
+    // tensor t is written by cost layer t, tensor 0 being the normalized input
+    const uint numTensors = network.layers.size() + 1;
+    NetworkCost cost{};
+    cost.batchSize = batchSize;
+    cost.bytesPerElement = bytesPerElement;
+    cost.layers.resize(numTensors);
+
+    // owner maps a tensor to the one holding its memory, they only differ for single input
+    // routes. lastUse is the last layer reading a tensor, tracked on owners
+    std::vector<uint> owner(numTensors);
+    std::vector<uint> lastUse(numTensors);
+    std::vector<uint64_t> tensorBytes(numTensors, 0);
+    std::vector<uint64_t> transientBytes(numTensors, 0);
+    const uint64_t elementBytes = static_cast<uint64_t>(batchSize) * bytesPerElement;
+
+    // the builder divides the input binding by a constant of the same volume
+    const uint64_t inputVolume
+        = static_cast<uint64_t>(network.inputC) * network.inputH * network.inputW;
+    cost.layers.at(0).layerIdx = 0;
+    cost.layers.at(0).weightBytes = inputVolume * bytesPerElement;
+    tensorBytes.at(0) = inputVolume * elementBytes;
+
+    for (uint t = 1; t < numTensors; ++t)
+    {
+        const LayerDesc& layer = network.layers.at(t - 1);
+        LayerCost& layerCost = cost.layers.at(t);
+        layerCost.layerIdx = layer.layerIdx;
+        owner.at(t) = t;
+        lastUse.at(t) = t;
+        tensorBytes.at(t) = layer.output.volume() * elementBytes;
+        // tensors read by the layer
+        std::vector<uint> inputs;
+        switch (layer.type)
+        {
+        case LayerType::kConvolutional:
+        {
+            const uint64_t filters = layer.conv.filters;
+            const uint64_t kernelVolume = static_cast<uint64_t>(layer.input.channels)
+                * layer.conv.kernelSize * layer.conv.kernelSize;
+            layerCost.macs = batchSize * layer.output.volume() * kernelVolume;
+            // batch norm is folded into a per channel shift, scale and power
+            layerCost.weightBytes
+                = (filters * kernelVolume + (layer.conv.batchNormalize ? 3 : 1) * filters)
+                * bytesPerElement;
+            inputs.push_back(t - 1);
+            break;
+        }
+        case LayerType::kUpsample:
+        {
+            // two matrix multiplies with constant 0/1 matrices, see netAddUpsample
+            const uint64_t stride = layer.upsample.stride;
+            const uint64_t h = layer.input.height;
+            const uint64_t w = layer.input.width;
+            layerCost.macs = batchSize * layer.input.channels
+                * (stride * h * h * w + stride * h * w * stride * w);
+            layerCost.weightBytes = (stride * h * h + w * stride * w) * bytesPerElement;
+            transientBytes.at(t) = layer.input.channels * stride * h * w * elementBytes;
+            inputs.push_back(t - 1);
+            break;
+        }
+        case LayerType::kRoute:
+            for (const uint idx : layer.route.inputs) inputs.push_back(idx + 1);
+            // a single input route hands on its input, a concatenation writes a copy
+            if (inputs.size() == 1)
+            {
+                owner.at(t) = owner.at(inputs.front());
+                tensorBytes.at(t) = 0;
+            }
+            break;
+        case LayerType::kShortcut:
+            inputs.push_back(t - 1);
+            inputs.push_back(layer.shortcut.input + 1);
+            break;
+        case LayerType::kYolo:
+        case LayerType::kRegion:
+            // network outputs stay alive until the end of the inference
+            lastUse.at(t) = numTensors - 1;
+            inputs.push_back(t - 1);
+            break;
+        case LayerType::kMaxpool:
+        case LayerType::kReorg: inputs.push_back(t - 1); break;
+        }
+        for (const uint input : inputs)
+            lastUse.at(owner.at(input)) = std::max(lastUse.at(owner.at(input)), t);
+    }
+
+    // the input binding is written by the host before the first layer and stays allocated
+    const uint64_t inputBindingBytes = inputVolume * batchSize * sizeof(float);
+    for (uint t = 0; t < numTensors; ++t)
+    {
+        LayerCost& layerCost = cost.layers.at(t);
+        layerCost.activationBytes = tensorBytes.at(t) + transientBytes.at(t);
+        layerCost.liveBytes = inputBindingBytes + transientBytes.at(t);
+        for (uint u = 0; u <= t; ++u)
+            if (lastUse.at(u) >= t) layerCost.liveBytes += tensorBytes.at(u);
+
+        cost.totalMACs += layerCost.macs;
+        cost.totalWeightBytes += layerCost.weightBytes;
+        cost.totalActivationBytes += layerCost.activationBytes;
+        if (layerCost.liveBytes > cost.peakLiveBytes)
+        {
+            cost.peakLiveBytes = layerCost.liveBytes;
+            cost.peakLayerIdx = layerCost.layerIdx;
+        }
+    }
+    return cost;
+}
@@ -0,0 +1,70 @@
+/**
+MIT License
+
+Copyright (c) 2018 NVIDIA CORPORATION. All rights reserved.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*
+*/
+
+#ifndef _COST_MODEL_H_
+#define _COST_MODEL_H_
+
+#include "yolo_cfg.h"
+
+#include <stdint.h>
+#include <vector>
+
+/**
+ * Static cost of running a network as the engine builder lays it out, derived from the cfg
+ * alone. Byte counts are estimates at a single element size, TensorRT may pick other formats
+ * and reuse memory differently.
+ */
+
+struct LayerCost
+{
+    // index of the block in the cfg, 0 being the input normalization added by the builder
+    uint layerIdx;
+    uint64_t macs;
+    uint64_t weightBytes;
+    // bytes of the tensors the layer writes, single input routes alias their input and write
+    // nothing
+    uint64_t activationBytes;
+    // bytes of every tensor alive while the layer runs, including the input binding and the
+    // tensors kept for later routes, shortcuts and outputs
+    uint64_t liveBytes;
+};
+
+struct NetworkCost
+{
+    uint batchSize;
+    uint bytesPerElement;
+    // layers.at(0) is the input normalization, layers.at(k) is block k of the cfg
+    std::vector<LayerCost> layers;
+    uint64_t totalMACs;
+    uint64_t totalWeightBytes;
+    uint64_t totalActivationBytes;
+    uint64_t peakLiveBytes;
+    uint peakLayerIdx;
+};
+
+NetworkCost getNetworkCost(const NetworkDesc& network, const uint batchSize,
+                           const uint bytesPerElement);
+
+#endif // _COST_MODEL_H_
@@ -23,30 +23,32 @@ SOFTWARE.
 *
 */
 #include "ds_image.h"
+#include "jpeg_decode.h"
 #include <experimental/filesystem>
 
 DsImage::DsImage() :
     m_Height(0),
     m_Width(0),
-    m_XOffset(0),
-    m_YOffset(0),
-    m_ScalingFactor(0.0),
     m_RNG(cv::RNG(unsigned(std::time(0)))),
-    m_ImageName()
+    m_ImageName(),
+    m_ScaleDenom(1)
 {
 }
 
-DsImage::DsImage(const std::string& path, const int& inputH, const int& inputW) :
+DsImage::DsImage(const std::string& path, const int& inputH, const int& inputW,
+                 const bool reducedDecode, const LetterboxFilter filter) :
     m_Height(0),
     m_Width(0),
-    m_XOffset(0),
-    m_YOffset(0),
-    m_ScalingFactor(0.0),
     m_RNG(cv::RNG(unsigned(std::time(0)))),
-    m_ImageName()
+    m_ImageName(),
+    m_ScaleDenom(1)
 {
     m_ImageName = std::experimental::filesystem::path(path).stem().string();
-    m_OrigImage = cv::imread(path, CV_LOAD_IMAGE_COLOR);
+    uint origW = 0, origH = 0;
+    if (reducedDecode)
+        m_OrigImage = imreadForLetterbox(path, inputW, inputH, origW, origH, m_ScaleDenom);
+    else
+        m_OrigImage = cv::imread(path, CV_LOAD_IMAGE_COLOR);
 
     if (!m_OrigImage.data || m_OrigImage.cols <= 0 || m_OrigImage.rows <= 0)
     {
@@ -61,43 +63,23 @@ DsImage::DsImage(const std::string& path, const int& inputH, const int& inputW)
     }
 
     m_OrigImage.copyTo(m_MarkedImage);
-    m_Height = m_OrigImage.rows;
-    m_Width = m_OrigImage.cols;
+    m_Height = reducedDecode ? origH : m_OrigImage.rows;
+    m_Width = reducedDecode ? origW : m_OrigImage.cols;
 
-    // resize the DsImage with scale
-    float dim = std::max(m_Height, m_Width);
-    int resizeH = ((m_Height / dim) * inputH);
-    int resizeW = ((m_Width / dim) * inputW);
-    m_ScalingFactor = static_cast<float>(resizeH) / static_cast<float>(m_Height);
-
-    // Additional checks for images with non even dims
-    if ((inputW - resizeW) % 2) resizeW--;
-    if ((inputH - resizeH) % 2) resizeH--;
-    assert((inputW - resizeW) % 2 == 0);
-    assert((inputH - resizeH) % 2 == 0);
-
-    m_XOffset = (inputW - resizeW) / 2;
-    m_YOffset = (inputH - resizeH) / 2;
-
-    assert(2 * m_XOffset + resizeW == inputW);
-    assert(2 * m_YOffset + resizeH == inputH);
-
-    // resizing
-    cv::resize(m_OrigImage, m_LetterboxImage, cv::Size(resizeW, resizeH), 0, 0, cv::INTER_CUBIC);
-    // letterboxing
-    cv::copyMakeBorder(m_LetterboxImage, m_LetterboxImage, m_YOffset, m_YOffset, m_XOffset,
-                       m_XOffset, cv::BORDER_CONSTANT, cv::Scalar(128, 128, 128));
-    // converting to RGB
-    cv::cvtColor(m_LetterboxImage, m_LetterboxImage, CV_BGR2RGB);
+    // the letterbox itself is written straight into the input blob
+    m_LetterboxPlan
+        = ::getLetterboxPlan(m_Width, m_Height, inputW, inputH, m_ScaleDenom, filter);
 }
 
 void DsImage::addBBox(BBoxInfo box, const std::string& labelName)
 {
     m_Bboxes.push_back(box);
-    const int x = box.box.x1;
-    const int y = box.box.y1;
-    const int w = box.box.x2 - box.box.x1;
-    const int h = box.box.y2 - box.box.y1;
+    // boxes are in original image coordinates, the marked image may have been decoded smaller
+    const float scale = 1.0f / m_ScaleDenom;
+    const int x = box.box.x1 * scale;
+    const int y = box.box.y1 * scale;
+    const int w = (box.box.x2 - box.box.x1) * scale;
+    const int h = (box.box.y2 - box.box.y1) * scale;
     const cv::Scalar color
         = cv::Scalar(m_RNG.uniform(0, 255), m_RNG.uniform(0, 255), m_RNG.uniform(0, 255));
 
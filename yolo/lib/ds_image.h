@@ -25,6 +25,7 @@ SOFTWARE.
 #ifndef __IMAGE_H__
 #define __IMAGE_H__
 
+#include "letterbox.h"
 #include "trt_utils.h"
 
 struct BBoxInfo;
@@ -33,10 +34,14 @@ class DsImage
 {
 public:
     DsImage();
-    DsImage(const std::string& path, const int& inputH, const int& inputW);
+    // reducedDecode decodes JPEGs at the smallest scale that still covers the letterbox, see
+    // imreadForLetterbox. Boxes keep the original image size, the marked image is reduced.
+    DsImage(const std::string& path, const int& inputH, const int& inputW,
+            const bool reducedDecode = false,
+            const LetterboxFilter filter = LetterboxFilter::kCUBIC);
     int getImageHeight() const { return m_Height; }
     int getImageWidth() const { return m_Width; }
-    cv::Mat getLetterBoxedImage() const { return m_LetterboxImage; }
+    const LetterboxPlan& getLetterboxPlan() const { return m_LetterboxPlan; }
     cv::Mat getOriginalImage() const { return m_OrigImage; }
     std::string getImageName() const { return m_ImageName; }
     void addBBox(BBoxInfo box, const std::string& labelName);
@@ -47,18 +52,16 @@ public:
 private:
     int m_Height;
     int m_Width;
-    int m_XOffset;
-    int m_YOffset;
-    float m_ScalingFactor;
     std::string m_ImagePath;
     cv::RNG m_RNG;
     std::string m_ImageName;
     std::vector<BBoxInfo> m_Bboxes;
 
-    // unaltered original Image
+    // unaltered original Image, at 1 / m_ScaleDenom of m_Width x m_Height
     cv::Mat m_OrigImage;
-    // letterboxed Image given to the network as input
-    cv::Mat m_LetterboxImage;
+    uint m_ScaleDenom;
+    // how the image is letterboxed into the network input, see blobFromDsImages
+    LetterboxPlan m_LetterboxPlan;
     // final image marked with the bounding boxes
     cv::Mat m_MarkedImage;
 };
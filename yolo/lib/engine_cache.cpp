@@ -0,0 +1,264 @@
+/**
+MIT License
+
+Copyright (c) 2018 NVIDIA CORPORATION. All rights reserved.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*
+*/
+
+#include "engine_cache.h"
+#include "mapped_file.h"
+
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <cstdio>
+#include <experimental/filesystem>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <unistd.h>
+
+namespace fs = std::experimental::filesystem;
+
+static std::string toHex(const uint64_t value)
+{
+    char hex[17];
+    snprintf(hex, sizeof(hex), "%016llx", static_cast<unsigned long long>(value));
+    return hex;
+}
+
+// milliseconds since epoch, the unit of the created and lastUsed manifest fields
+static uint64_t nowMs()
+{
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+               std::chrono::system_clock::now().time_since_epoch())
+        .count();
+}
+
+static std::string escapeJson(const std::string& s)
+{
+    std::string escaped;
+    for (const char c : s)
+    {
+        if (c == '"' || c == '\\')
+        {
+            escaped += '\\';
+            escaped += c;
+        }
+        else if (static_cast<unsigned char>(c) < 0x20)
+        {
+            char code[7];
+            snprintf(code, sizeof(code), "\\u%04x", c);
+            escaped += code;
+        }
+        else
+            escaped += c;
+    }
+    return escaped;
+}
+
+// Reads an unsigned number field written by writeManifest, returns false if it is missing
+static bool readManifestField(const std::string& manifest, const std::string& name,
+                              uint64_t& value)
+{
+    const std::string token = "\"" + name + "\": ";
+    const size_t pos = manifest.find(token);
+    if (pos == std::string::npos) return false;
+    value = std::strtoull(manifest.c_str() + pos + token.size(), nullptr, 10);
+    return true;
+}
+
+// Writes to a temporary file in the same directory and renames it over path
+static bool writeFileAtomically(const std::string& path, const void* data, const size_t size)
+{
+    const std::string tmpPath = path + ".tmp." + std::to_string(getpid());
+    std::ofstream out(tmpPath, std::ios_base::binary | std::ios_base::trunc);
+    out.write(static_cast<const char*>(data), size);
+    out.close();
+    if (!out.good() || std::rename(tmpPath.c_str(), path.c_str()) != 0)
+    {
+        std::remove(tmpPath.c_str());
+        return false;
+    }
+    return true;
+}
+
+void EngineCacheKey::add(const std::string& name, const std::string& value)
+{
+    m_Fields.push_back(std::make_pair(name, value));
+}
+
+void EngineCacheKey::addFileChecksum(const std::string& name, const std::string& filePath)
+{
+    std::error_code ec;
+    if (!filePath.empty() && fs::is_regular_file(filePath, ec) && fs::file_size(filePath, ec) > 0)
+        addChecksum(name, fileChecksum(filePath));
+    else
+        add(name, "none");
+}
+
+void EngineCacheKey::addChecksum(const std::string& name, const uint64_t checksum)
+{
+    add(name, toHex(checksum));
+}
+
+std::string EngineCacheKey::getDigest() const
+{
+    std::string serialized;
+    for (const auto& field : m_Fields) serialized += field.first + "=" + field.second + "\n";
+    return toHex(fnv1a64(serialized.data(), serialized.size()));
+}
+
+EngineCache::EngineCache(const std::string& cacheDir, const uint64_t maxSizeBytes) :
+    m_CacheDir(cacheDir),
+    m_MaxSizeBytes(maxSizeBytes)
+{
+    std::error_code ec;
+    fs::create_directories(m_CacheDir, ec);
+    if (!fs::is_directory(m_CacheDir, ec))
+    {
+        std::cout << "Unable to create engine cache directory : " << m_CacheDir << std::endl;
+        assert(0);
+    }
+}
+
+std::string EngineCache::getPlanPath(const EngineCacheKey& key) const
+{
+    return (fs::path(m_CacheDir) / (key.getDigest() + ".engine")).string();
+}
+
+std::string EngineCache::getManifestPath(const EngineCacheKey& key) const
+{
+    return (fs::path(m_CacheDir) / (key.getDigest() + ".json")).string();
+}
+
+bool EngineCache::lookup(const EngineCacheKey& key) const
+{
+    const std::string planPath = getPlanPath(key);
+    std::ifstream manifestFile(getManifestPath(key));
+    if (!manifestFile.good()) return false;
+    std::stringstream manifest;
+    manifest << manifestFile.rdbuf();
+    manifestFile.close();
+
+    uint64_t planSize = 0, created = 0;
+    std::error_code ec;
+    if (!readManifestField(manifest.str(), "planSize", planSize)
+        || !readManifestField(manifest.str(), "created", created)
+        || fs::file_size(planPath, ec) != planSize || ec)
+    {
+        std::cout << "Dropping inconsistent engine cache entry " << key.getDigest() << std::endl;
+        removeEntry(key.getDigest());
+        return false;
+    }
+    writeManifest(key, planSize, created, nowMs());
+    return true;
+}
+
+void EngineCache::insert(const EngineCacheKey& key, const void* plan, const size_t size) const
+{
+    // the plan goes first, an entry only counts once its manifest is in place
+    if (!writeFileAtomically(getPlanPath(key), plan, size))
+    {
+        std::cout << "Unable to write engine cache entry : " << getPlanPath(key) << std::endl;
+        assert(0);
+    }
+    const uint64_t now = nowMs();
+    writeManifest(key, size, now, now);
+    evict(key.getDigest());
+}
+
+std::vector<EngineCache::Entry> EngineCache::listEntries() const
+{
+    std::vector<Entry> entries;
+    std::error_code ec;
+    for (fs::directory_iterator it(m_CacheDir, ec), end; !ec && it != end; it.increment(ec))
+    {
+        const fs::path path = it->path();
+        if (path.extension() != ".json") continue;
+        std::ifstream manifestFile(path.string());
+        std::stringstream manifest;
+        manifest << manifestFile.rdbuf();
+        Entry entry;
+        entry.digest = path.stem().string();
+        if (!readManifestField(manifest.str(), "planSize", entry.planSize)
+            || !readManifestField(manifest.str(), "lastUsed", entry.lastUsed))
+            continue;
+        entries.push_back(entry);
+    }
+    return entries;
+}
+
+void EngineCache::writeManifest(const EngineCacheKey& key, const uint64_t planSize,
+                                const uint64_t created, const uint64_t lastUsed) const
+{
+    std::stringstream manifest;
+    manifest << "{\n"
+             << "  \"key\": \"" << key.getDigest() << "\",\n"
+             << "  \"plan\": \"" << key.getDigest() << ".engine\",\n"
+             << "  \"planSize\": " << planSize << ",\n"
+             << "  \"created\": " << created << ",\n"
+             << "  \"lastUsed\": " << lastUsed << ",\n"
+             << "  \"fields\": {";
+    const auto& fields = key.getFields();
+    for (uint i = 0; i < fields.size(); ++i)
+    {
+        manifest << (i == 0 ? "\n" : ",\n") << "    \"" << escapeJson(fields.at(i).first)
+                 << "\": \"" << escapeJson(fields.at(i).second) << "\"";
+    }
+    manifest << "\n  }\n}\n";
+    const std::string content = manifest.str();
+    if (!writeFileAtomically(getManifestPath(key), content.data(), content.size()))
+    {
+        std::cout << "Unable to write engine cache manifest : " << getManifestPath(key)
+                  << std::endl;
+        assert(0);
+    }
+}
+
+void EngineCache::evict(const std::string& keepDigest) const
+{
+    if (m_MaxSizeBytes == 0) return;
+    std::vector<Entry> entries = listEntries();
+    uint64_t totalSize = 0;
+    for (const Entry& entry : entries) totalSize += entry.planSize;
+    std::sort(entries.begin(), entries.end(), [](const Entry& a, const Entry& b) {
+        return a.lastUsed != b.lastUsed ? a.lastUsed < b.lastUsed : a.digest < b.digest;
+    });
+    for (const Entry& entry : entries)
+    {
+        if (totalSize <= m_MaxSizeBytes) break;
+        // the entry just inserted stays even if it alone is above the cap
+        if (entry.digest == keepDigest) continue;
+        std::cout << "Evicting engine cache entry " << entry.digest << " (" << entry.planSize
+                  << " bytes)" << std::endl;
+        removeEntry(entry.digest);
+        totalSize -= entry.planSize;
+    }
+}
+
+void EngineCache::removeEntry(const std::string& digest) const
+{
+    // manifest first, so a concurrent lookup never finds a manifest without its plan
+    std::error_code ec;
+    fs::remove(fs::path(m_CacheDir) / (digest + ".json"), ec);
+    fs::remove(fs::path(m_CacheDir) / (digest + ".engine"), ec);
+}
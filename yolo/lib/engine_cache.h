@@ -0,0 +1,94 @@
+/**
+MIT License
+
+Copyright (c) 2018 NVIDIA CORPORATION. All rights reserved.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*
+*/
+
+#ifndef _ENGINE_CACHE_H_
+#define _ENGINE_CACHE_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+#include <utility>
+#include <vector>
+
+/**
+ * Everything a serialized engine depends on, as named fields. The digest of the fields names
+ * the cache entry, so changing any of them misses the cache instead of reusing a stale plan.
+ */
+class EngineCacheKey
+{
+public:
+    void add(const std::string& name, const std::string& value);
+    // Adds the FNV-1a checksum of the file content, or "none" if the file does not exist
+    void addFileChecksum(const std::string& name, const std::string& filePath);
+    // Adds a checksum computed elsewhere, the same field addFileChecksum adds for that content
+    void addChecksum(const std::string& name, const uint64_t checksum);
+
+    // 16 hex digits of the FNV-1a hash of all the fields in insertion order
+    std::string getDigest() const;
+    const std::vector<std::pair<std::string, std::string>>& getFields() const { return m_Fields; }
+
+private:
+    std::vector<std::pair<std::string, std::string>> m_Fields;
+};
+
+/**
+ * Directory of serialized engines named by the digest of their EngineCacheKey. Every entry is
+ * a <digest>.engine plan next to a <digest>.json manifest recording the key fields, the plan
+ * size and when the entry was created and last used. Files are written to a temporary name and
+ * renamed into place, so a reader never sees a partial entry. Inserting an entry evicts the
+ * least recently used ones until the plans fit in maxSizeBytes again, 0 meaning no limit.
+ */
+class EngineCache
+{
+public:
+    EngineCache(const std::string& cacheDir, const uint64_t maxSizeBytes);
+
+    const std::string& getCacheDir() const { return m_CacheDir; }
+    std::string getPlanPath(const EngineCacheKey& key) const;
+    std::string getManifestPath(const EngineCacheKey& key) const;
+    // Returns true if the cache holds a plan for key and marks the entry as used
+    bool lookup(const EngineCacheKey& key) const;
+    // Stores the plan under key, then evicts least recently used entries above the size cap
+    void insert(const EngineCacheKey& key, const void* plan, const size_t size) const;
+
+private:
+    struct Entry
+    {
+        std::string digest;
+        uint64_t planSize;
+        uint64_t lastUsed;
+    };
+
+    std::vector<Entry> listEntries() const;
+    void writeManifest(const EngineCacheKey& key, const uint64_t planSize,
+                       const uint64_t created, const uint64_t lastUsed) const;
+    void evict(const std::string& keepDigest) const;
+    void removeEntry(const std::string& digest) const;
+
+    const std::string m_CacheDir;
+    const uint64_t m_MaxSizeBytes;
+};
+
+#endif // _ENGINE_CACHE_H_
@@ -0,0 +1,131 @@
+/**
+MIT License
+
+Copyright (c) 2018 NVIDIA CORPORATION. All rights reserved.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*
+*/
+
+#include "jpeg_decode.h"
+#include "letterbox.h"
+
+#include <algorithm>
+#include <fstream>
+#include <opencv2/highgui/highgui.hpp>
+
+bool readJpegSize(const std::string& path, uint& width, uint& height)
+{
+    std::ifstream file(path, std::ios::binary);
+    if (!file || (file.get() != 0xFF) || (file.get() != 0xD8)) return false;
+
+    while (file)
+    {
+        // markers may be preceded by any number of 0xFF fill bytes
+        int marker = file.get();
+        if (marker != 0xFF) return false;
+        while (marker == 0xFF) marker = file.get();
+        if ((marker == std::char_traits<char>::eof()) || (marker == 0xD9) || (marker == 0xDA))
+            return false;
+        // standalone markers carry no length
+        if ((marker == 0x01) || ((marker >= 0xD0) && (marker <= 0xD7))) continue;
+
+        uint8_t header[7];
+        if (!file.read(reinterpret_cast<char*>(header), 2)) return false;
+        const uint length = (header[0] << 8) | header[1];
+        if (length < 2) return false;
+        // SOF0 to SOF15, except DHT, JPG and DAC which share the range
+        if ((marker >= 0xC0) && (marker <= 0xCF) && (marker != 0xC4) && (marker != 0xC8)
+            && (marker != 0xCC))
+        {
+            if ((length < 7) || !file.read(reinterpret_cast<char*>(header + 2), 5)) return false;
+            height = (header[3] << 8) | header[4];
+            width = (header[5] << 8) | header[6];
+            // a height of 0 is only defined later on by a DNL marker
+            return (width > 0) && (height > 0);
+        }
+        file.seekg(length - 2, std::ios::cur);
+    }
+    return false;
+}
+
+uint getJpegScaleDenom(const uint srcW, const uint srcH, const uint minW, const uint minH)
+{
+    for (uint scaleDenom = 8; scaleDenom > 1; scaleDenom /= 2)
+    {
+        if (((srcW + scaleDenom - 1) / scaleDenom >= minW)
+            && ((srcH + scaleDenom - 1) / scaleDenom >= minH))
+            return scaleDenom;
+    }
+    return 1;
+}
+
+static int getReducedReadFlag(const uint scaleDenom)
+{
+    switch (scaleDenom)
+    {
+    case 2: return cv::IMREAD_REDUCED_COLOR_2;
+    case 4: return cv::IMREAD_REDUCED_COLOR_4;
+    case 8: return cv::IMREAD_REDUCED_COLOR_8;
+    default: return cv::IMREAD_COLOR;
+    }
+}
+
+cv::Mat imreadForLetterbox(const std::string& path, const uint dstW, const uint dstH,
+                           uint& origW, uint& origH, uint& scaleDenom)
+{
+    uint jpegW = 0, jpegH = 0;
+    scaleDenom = 1;
+    if (readJpegSize(path, jpegW, jpegH))
+    {
+        // imread applies the EXIF orientation, so the image must stay large enough either way
+        const LetterboxPlan plan = getLetterboxPlan(jpegW, jpegH, dstW, dstH);
+        const LetterboxPlan rotatedPlan = getLetterboxPlan(jpegH, jpegW, dstW, dstH);
+        scaleDenom = std::min(getJpegScaleDenom(jpegW, jpegH, plan.resizeW, plan.resizeH),
+                              getJpegScaleDenom(jpegH, jpegW, rotatedPlan.resizeW,
+                                                rotatedPlan.resizeH));
+    }
+
+    cv::Mat image = cv::imread(path, getReducedReadFlag(scaleDenom));
+    origW = image.cols;
+    origH = image.rows;
+    if ((scaleDenom == 1) || !image.data) return image;
+
+    const uint reducedW = (jpegW + scaleDenom - 1) / scaleDenom;
+    const uint reducedH = (jpegH + scaleDenom - 1) / scaleDenom;
+    if ((origW == reducedW) && (origH == reducedH))
+    {
+        origW = jpegW;
+        origH = jpegH;
+    }
+    else if ((origW == reducedH) && (origH == reducedW))
+    {
+        origW = jpegH;
+        origH = jpegW;
+    }
+    else
+    {
+        // the decoder did not scale as expected, the true size is unknown without a full decode
+        scaleDenom = 1;
+        image = cv::imread(path, cv::IMREAD_COLOR);
+        origW = image.cols;
+        origH = image.rows;
+    }
+    return image;
+}
@@ -0,0 +1,52 @@
+/**
+MIT License
+
+Copyright (c) 2018 NVIDIA CORPORATION. All rights reserved.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*
+*/
+
+#ifndef _JPEG_DECODE_H_
+#define _JPEG_DECODE_H_
+
+#include <opencv2/core/core.hpp>
+
+#include <string>
+#include <sys/types.h>
+
+// Reads the frame size from the SOF header of a JPEG file without decoding any pixels. Returns
+// false for files that are not JPEGs or have no frame header before the scan data.
+bool readJpegSize(const std::string& path, uint& width, uint& height);
+
+// Largest of 8, 4 and 2 a srcW x srcH JPEG can be scaled down by while decoding and still be at
+// least minW x minH. libjpeg rounds the scaled size up. Returns 1 if no reduction fits.
+uint getJpegScaleDenom(const uint srcW, const uint srcH, const uint minW, const uint minH);
+
+/**
+ * Decodes a color image that is letterboxed into a dstW x dstH network input. A JPEG is decoded
+ * at the largest DCT scale-down that does not drop below the size it is resized to, which skips
+ * most of the IDCT work for images far larger than the input. Other formats are decoded in full.
+ * origW x origH receives the full resolution size, which the detections map back to, and
+ * scaleDenom the reduction that was applied. Pass both on to getLetterboxPlan.
+ */
+cv::Mat imreadForLetterbox(const std::string& path, const uint dstW, const uint dstH,
+                           uint& origW, uint& origH, uint& scaleDenom);
+
+#endif // _JPEG_DECODE_H_
@@ -31,20 +31,20 @@ SOFTWARE.
 
 inline __device__ float sigmoidGPU(const float& x) { return 1.0f / (1.0f + __expf(-x)); }
 
-__global__ void gpuYoloLayerV3(const float* input, float* output, const uint gridSize, const uint numOutputClasses,
-                               const uint numBBoxes)
+__global__ void gpuYoloLayerV3(const float* input, float* output, const uint gridW, const uint gridH,
+                               const uint numOutputClasses, const uint numBBoxes)
 {
     uint x_id = blockIdx.x * blockDim.x + threadIdx.x;
     uint y_id = blockIdx.y * blockDim.y + threadIdx.y;
     uint z_id = blockIdx.z * blockDim.z + threadIdx.z;
 
-    if ((x_id >= gridSize) || (y_id >= gridSize) || (z_id >= numBBoxes))
+    if ((x_id >= gridW) || (y_id >= gridH) || (z_id >= numBBoxes))
     {
         return;
     }
 
-    const int numGridCells = gridSize * gridSize;
-    const int bbindex = y_id * gridSize + x_id;
+    const int numGridCells = gridW * gridH;
+    const int bbindex = y_id * gridW + x_id;
 
     output[bbindex + numGridCells * (z_id * (5 + numOutputClasses) + 0)]
         = sigmoidGPU(input[bbindex + numGridCells * (z_id * (5 + numOutputClasses) + 0)]);
@@ -68,19 +68,19 @@ __global__ void gpuYoloLayerV3(const float* input, float* output, const uint gri
     }
 }
 
-cudaError_t cudaYoloLayerV3(const void* input, void* output, const uint& batchSize, const uint& gridSize,
-                            const uint& numOutputClasses, const uint& numBBoxes,
+cudaError_t cudaYoloLayerV3(const void* input, void* output, const uint& batchSize, const uint& gridW,
+                            const uint& gridH, const uint& numOutputClasses, const uint& numBBoxes,
                             uint64_t outputSize, cudaStream_t stream)
 {
     dim3 threads_per_block(16, 16, 4);
-    dim3 number_of_blocks((gridSize / threads_per_block.x) + 1,
-                          (gridSize / threads_per_block.y) + 1,
+    dim3 number_of_blocks((gridW / threads_per_block.x) + 1,
+                          (gridH / threads_per_block.y) + 1,
                           (numBBoxes / threads_per_block.z) + 1);
     for (int batch = 0; batch < batchSize; ++batch)
     {
         gpuYoloLayerV3<<<number_of_blocks, threads_per_block, 0, stream>>>(
             reinterpret_cast<const float*>(input) + (batch * outputSize),
-            reinterpret_cast<float*>(output) + (batch * outputSize), gridSize, numOutputClasses,
+            reinterpret_cast<float*>(output) + (batch * outputSize), gridW, gridH, numOutputClasses,
             numBBoxes);
     }
     return cudaGetLastError();
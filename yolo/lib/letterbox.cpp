@@ -0,0 +1,454 @@
+/**
+MIT License
+
+Copyright (c) 2018 NVIDIA CORPORATION. All rights reserved.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*
+*/
+
+#include "letterbox.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <iostream>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define LETTERBOX_X86_SIMD
+#endif
+
+static const struct ByteToFloat
+{
+    ByteToFloat()
+    {
+        for (uint i = 0; i < 256; ++i) values[i] = i;
+    }
+    float operator[](const uint8_t i) const { return values[i]; }
+    float values[256];
+} kByteToFloat;
+
+// Blends two resized rows into n output values
+template <typename T>
+using BlendRows = void (*)(const float* row0, const float* row1, const float weight, const uint n,
+                           T* dst);
+
+// scale is the number of source pixels per resized pixel
+static void getTaps(const uint srcSize, const uint dstSize, const double scale,
+                    const uint tapStride, std::vector<uint>& tap0, std::vector<uint>& tap1,
+                    std::vector<float>& weight)
+{
+    tap0.resize(dstSize);
+    tap1.resize(dstSize);
+    weight.resize(dstSize);
+    for (uint i = 0; i < dstSize; ++i)
+    {
+        // pixel centres are aligned, as in cv::resize
+        const double s = std::min(std::max((i + 0.5) * scale - 0.5, 0.0),
+                                  static_cast<double>(srcSize - 1));
+        const uint s0 = static_cast<uint>(s);
+        tap0.at(i) = s0 * tapStride;
+        tap1.at(i) = std::min(s0 + 1, srcSize - 1) * tapStride;
+        weight.at(i) = s - s0;
+    }
+}
+
+// Same pixel centre alignment as getTaps. The kernel is that of cv::INTER_CUBIC (a = -0.75) and
+// taps outside the image repeat its border
+static void getCubicTaps(const uint srcSize, const uint dstSize, const double scale,
+                         const uint tapStride, std::vector<uint>& taps,
+                         std::vector<float>& weights)
+{
+    const double a = -0.75;
+    taps.resize(dstSize * kLetterboxCubicTaps);
+    weights.resize(dstSize * kLetterboxCubicTaps);
+    for (uint i = 0; i < dstSize; ++i)
+    {
+        const double s = (i + 0.5) * scale - 0.5;
+        const int s0 = static_cast<int>(std::floor(s));
+        const double t = s - s0;
+        const double w[kLetterboxCubicTaps]
+            = {((a * (t + 1) - 5 * a) * (t + 1) + 8 * a) * (t + 1) - 4 * a,
+               ((a + 2) * t - (a + 3)) * t * t + 1,
+               ((a + 2) * (1 - t) - (a + 3)) * (1 - t) * (1 - t) + 1,
+               ((a * (2 - t) - 5 * a) * (2 - t) + 8 * a) * (2 - t) - 4 * a};
+        for (uint k = 0; k < kLetterboxCubicTaps; ++k)
+        {
+            const int tap = std::min(std::max(s0 - 1 + static_cast<int>(k), 0),
+                                     static_cast<int>(srcSize) - 1);
+            taps.at(i * kLetterboxCubicTaps + k) = tap * tapStride;
+            weights.at(i * kLetterboxCubicTaps + k) = w[k];
+        }
+    }
+}
+
+LetterboxFilter parseLetterboxFilter(const std::string& name)
+{
+    if (name == "bilinear")
+        return LetterboxFilter::kBILINEAR;
+    else if (name == "cubic")
+        return LetterboxFilter::kCUBIC;
+
+    std::cout << "Unrecognized letterbox filter " << name << std::endl;
+    assert(0);
+    return LetterboxFilter::kBILINEAR;
+}
+
+LetterboxPlan getLetterboxPlan(const uint srcW, const uint srcH, const uint dstW,
+                               const uint dstH, const uint scaleDenom,
+                               const LetterboxFilter filter)
+{
+    assert((srcW > 0) && (srcH > 0) && (dstW > 0) && (dstH > 0) && (scaleDenom > 0));
+    LetterboxPlan plan;
+    plan.srcW = (srcW + scaleDenom - 1) / scaleDenom;
+    plan.srcH = (srcH + scaleDenom - 1) / scaleDenom;
+    plan.dstW = dstW;
+    plan.dstH = dstH;
+
+    const bool fitWidth
+        = static_cast<uint64_t>(srcW) * dstH >= static_cast<uint64_t>(srcH) * dstW;
+    int resizeH = fitWidth ? ((srcH / static_cast<float>(srcW)) * dstW) : dstH;
+    int resizeW = fitWidth ? dstW : ((srcW / static_cast<float>(srcH)) * dstH);
+    // the border is split evenly between both sides
+    if ((dstW - resizeW) % 2) resizeW--;
+    if ((dstH - resizeH) % 2) resizeH--;
+    assert((resizeW > 0) && (resizeH > 0) && "Image is too narrow to letterbox");
+    plan.resizeW = resizeW;
+    plan.resizeH = resizeH;
+    plan.xOffset = (dstW - resizeW) / 2;
+    plan.yOffset = (dstH - resizeH) / 2;
+
+    // a decoded pixel covers scaleDenom full size pixels, including in the last partial block
+    const double xScale = static_cast<double>(srcW) / scaleDenom / plan.resizeW;
+    const double yScale = static_cast<double>(srcH) / scaleDenom / plan.resizeH;
+    plan.filter = filter;
+    if (filter == LetterboxFilter::kCUBIC)
+    {
+        getCubicTaps(plan.srcW, plan.resizeW, xScale, 3, plan.xCubicTaps, plan.xCubicWeights);
+        getCubicTaps(plan.srcH, plan.resizeH, yScale, 1, plan.yCubicTaps, plan.yCubicWeights);
+    }
+    else
+    {
+        getTaps(plan.srcW, plan.resizeW, xScale, 3, plan.xTap0, plan.xTap1, plan.xWeight);
+        getTaps(plan.srcH, plan.resizeH, yScale, 1, plan.yTap0, plan.yTap1, plan.yWeight);
+    }
+    return plan;
+}
+
+LetterboxPlanCache::LetterboxPlanCache(const uint maxPlans, const LetterboxFilter filter) :
+    m_MaxPlans(std::max(maxPlans, 1u)),
+    m_Filter(filter),
+    m_NumLookups(0),
+    m_NumMisses(0)
+{
+    m_Entries.reserve(m_MaxPlans);
+}
+
+const LetterboxPlan& LetterboxPlanCache::getPlan(const uint srcW, const uint srcH,
+                                                 const uint dstW, const uint dstH)
+{
+    ++m_NumLookups;
+    Entry* lru = nullptr;
+    for (auto& entry : m_Entries)
+    {
+        const LetterboxPlan& plan = entry.plan;
+        if ((plan.srcW == srcW) && (plan.srcH == srcH) && (plan.dstW == dstW)
+            && (plan.dstH == dstH))
+        {
+            entry.lastUse = m_NumLookups;
+            return plan;
+        }
+        if (!lru || (entry.lastUse < lru->lastUse)) lru = &entry;
+    }
+
+    ++m_NumMisses;
+    if (m_Entries.size() < m_MaxPlans)
+    {
+        m_Entries.push_back(Entry());
+        lru = &m_Entries.back();
+    }
+    lru->plan = getLetterboxPlan(srcW, srcH, dstW, dstH, 1, m_Filter);
+    lru->lastUse = m_NumLookups;
+    return lru->plan;
+}
+
+// Resizes one source row horizontally into a plane per channel, in output channel order
+static void resizeRow(const LetterboxPlan& plan, const uint8_t* srcRow, const bool swapRB,
+                      float* row)
+{
+    const uint width = plan.resizeW;
+    float* c0 = row;
+    float* c1 = row + width;
+    float* c2 = row + 2 * width;
+    if (swapRB) std::swap(c0, c2);
+    const uint* tap0 = plan.xTap0.data();
+    const uint* tap1 = plan.xTap1.data();
+    const float* weight = plan.xWeight.data();
+    for (uint x = 0; x < width; ++x)
+    {
+        // a table lookup is cheaper than converting each byte to float
+        const uint8_t* p0 = srcRow + tap0[x];
+        const uint8_t* p1 = srcRow + tap1[x];
+        const float w = weight[x];
+        const float a0 = kByteToFloat[p0[0]], a1 = kByteToFloat[p0[1]], a2 = kByteToFloat[p0[2]];
+        c0[x] = a0 + (kByteToFloat[p1[0]] - a0) * w;
+        c1[x] = a1 + (kByteToFloat[p1[1]] - a1) * w;
+        c2[x] = a2 + (kByteToFloat[p1[2]] - a2) * w;
+    }
+}
+
+// Cubic counterpart of resizeRow
+static void resizeRowCubic(const LetterboxPlan& plan, const uint8_t* srcRow, const bool swapRB,
+                           float* row)
+{
+    const uint width = plan.resizeW;
+    float* c0 = row;
+    float* c1 = row + width;
+    float* c2 = row + 2 * width;
+    if (swapRB) std::swap(c0, c2);
+    for (uint x = 0; x < width; ++x)
+    {
+        const uint* taps = plan.xCubicTaps.data() + x * kLetterboxCubicTaps;
+        const float* weights = plan.xCubicWeights.data() + x * kLetterboxCubicTaps;
+        float v0 = 0, v1 = 0, v2 = 0;
+        for (uint k = 0; k < kLetterboxCubicTaps; ++k)
+        {
+            const uint8_t* p = srcRow + taps[k];
+            v0 += kByteToFloat[p[0]] * weights[k];
+            v1 += kByteToFloat[p[1]] * weights[k];
+            v2 += kByteToFloat[p[2]] * weights[k];
+        }
+        c0[x] = v0;
+        c1[x] = v1;
+        c2[x] = v2;
+    }
+}
+
+// The cubic kernel overshoots next to edges, values are clamped as cv::resize saturates them
+static void storeCubic(const float value, float* dst)
+{
+    *dst = std::min(std::max(value, 0.0f), 255.0f);
+}
+
+static void storeCubic(const float value, uint8_t* dst)
+{
+    *dst = static_cast<uint8_t>(std::min(std::max(value, 0.0f), 255.0f) + 0.5f);
+}
+
+static void blendRowsScalar(const float* row0, const float* row1, const float weight,
+                            const uint n, float* dst)
+{
+    for (uint i = 0; i < n; ++i) dst[i] = row0[i] + (row1[i] - row0[i]) * weight;
+}
+
+static void blendRowsScalar(const float* row0, const float* row1, const float weight,
+                            const uint n, uint8_t* dst)
+{
+    for (uint i = 0; i < n; ++i)
+        dst[i] = static_cast<uint8_t>(row0[i] + (row1[i] - row0[i]) * weight + 0.5f);
+}
+
+#ifdef LETTERBOX_X86_SIMD
+__attribute__((target("avx2"))) static void blendRowsAVX2(const float* row0, const float* row1,
+                                                           const float weight, const uint n,
+                                                           float* dst)
+{
+    const __m256 w = _mm256_set1_ps(weight);
+    uint i = 0;
+    for (; i + 8 <= n; i += 8)
+    {
+        const __m256 a = _mm256_loadu_ps(row0 + i);
+        const __m256 b = _mm256_loadu_ps(row1 + i);
+        _mm256_storeu_ps(dst + i, _mm256_add_ps(a, _mm256_mul_ps(_mm256_sub_ps(b, a), w)));
+    }
+    blendRowsScalar(row0 + i, row1 + i, weight, n - i, dst + i);
+}
+
+__attribute__((target("avx2"))) static void blendRowsAVX2(const float* row0, const float* row1,
+                                                           const float weight, const uint n,
+                                                           uint8_t* dst)
+{
+    const __m256 w = _mm256_set1_ps(weight);
+    const __m256 half = _mm256_set1_ps(0.5f);
+    uint i = 0;
+    for (; i + 16 <= n; i += 16)
+    {
+        const __m256 a0 = _mm256_loadu_ps(row0 + i), b0 = _mm256_loadu_ps(row1 + i);
+        const __m256 a1 = _mm256_loadu_ps(row0 + i + 8), b1 = _mm256_loadu_ps(row1 + i + 8);
+        // values are within [0, 255], truncating after adding 0.5 rounds them
+        const __m256i v0 = _mm256_cvttps_epi32(
+            _mm256_add_ps(_mm256_add_ps(a0, _mm256_mul_ps(_mm256_sub_ps(b0, a0), w)), half));
+        const __m256i v1 = _mm256_cvttps_epi32(
+            _mm256_add_ps(_mm256_add_ps(a1, _mm256_mul_ps(_mm256_sub_ps(b1, a1), w)), half));
+        // packs interleave the 128-bit lanes, the permute restores the element order
+        const __m256i packed = _mm256_permute4x64_epi64(_mm256_packs_epi32(v0, v1), 0xD8);
+        const __m128i bytes = _mm_packus_epi16(_mm256_castsi256_si128(packed),
+                                               _mm256_extracti128_si256(packed, 1));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), bytes);
+    }
+    blendRowsScalar(row0 + i, row1 + i, weight, n - i, dst + i);
+}
+#endif
+
+template <typename T>
+static BlendRows<T> selectBlendRows()
+{
+#ifdef LETTERBOX_X86_SIMD
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) return blendRowsAVX2;
+#endif
+    return blendRowsScalar;
+}
+
+// Pads the rows above and below the resized image
+template <typename T>
+static void padRows(const LetterboxPlan& plan, T* dst)
+{
+    const T pad = static_cast<T>(kLetterboxPadValue);
+    const size_t planeSize = static_cast<size_t>(plan.dstW) * plan.dstH;
+    for (uint c = 0; c < 3; ++c)
+    {
+        T* plane = dst + c * planeSize;
+        std::fill(plane, plane + static_cast<size_t>(plan.yOffset) * plan.dstW, pad);
+        std::fill(plane + static_cast<size_t>(plan.yOffset + plan.resizeH) * plan.dstW,
+                  plane + planeSize, pad);
+    }
+}
+
+template <typename T>
+static void letterboxCubic(const LetterboxPlan& plan, const uint8_t* src, const size_t srcStep,
+                           const bool swapRB, T* dst)
+{
+    const T pad = static_cast<T>(kLetterboxPadValue);
+    const uint width = plan.resizeW;
+    const size_t planeSize = static_cast<size_t>(plan.dstW) * plan.dstH;
+
+    // The taps of an output row are consecutive source rows, so a source row can be kept in
+    // slot row % kLetterboxCubicTaps without evicting another one the row blends
+    static thread_local std::vector<float> rows;
+    rows.resize(kLetterboxCubicTaps * 3 * width);
+    int64_t cached[kLetterboxCubicTaps] = {-1, -1, -1, -1};
+    padRows(plan, dst);
+
+    for (uint y = 0; y < plan.resizeH; ++y)
+    {
+        const uint* taps = plan.yCubicTaps.data() + y * kLetterboxCubicTaps;
+        const float* weights = plan.yCubicWeights.data() + y * kLetterboxCubicTaps;
+        const float* tapRows[kLetterboxCubicTaps];
+        for (uint k = 0; k < kLetterboxCubicTaps; ++k)
+        {
+            const uint slot = taps[k] % kLetterboxCubicTaps;
+            float* row = rows.data() + slot * 3 * width;
+            if (cached[slot] != taps[k])
+            {
+                resizeRowCubic(plan, src + taps[k] * srcStep, swapRB, row);
+                cached[slot] = taps[k];
+            }
+            tapRows[k] = row;
+        }
+
+        for (uint c = 0; c < 3; ++c)
+        {
+            T* out = dst + c * planeSize + static_cast<size_t>(plan.yOffset + y) * plan.dstW;
+            std::fill(out, out + plan.xOffset, pad);
+            const size_t offset = c * width;
+            for (uint x = 0; x < width; ++x)
+            {
+                float value = 0;
+                for (uint k = 0; k < kLetterboxCubicTaps; ++k)
+                    value += tapRows[k][offset + x] * weights[k];
+                storeCubic(value, out + plan.xOffset + x);
+            }
+            std::fill(out + plan.xOffset + width, out + plan.dstW, pad);
+        }
+    }
+}
+
+template <typename T>
+static void letterbox(const LetterboxPlan& plan, const uint8_t* src, const size_t srcStep,
+                      const bool swapRB, T* dst)
+{
+    if (plan.filter == LetterboxFilter::kCUBIC)
+    {
+        letterboxCubic(plan, src, srcStep, swapRB, dst);
+        return;
+    }
+
+    // Picked once from the instruction sets of the CPU we are running on
+    static const BlendRows<T> blendRows = selectBlendRows<T>();
+    const T pad = static_cast<T>(kLetterboxPadValue);
+    const uint width = plan.resizeW;
+    const size_t planeSize = static_cast<size_t>(plan.dstW) * plan.dstH;
+
+    // The two source rows the current output row blends, resized horizontally. Consecutive
+    // output rows often share source rows when upscaling, those are only resized once. Kept
+    // per thread so steady state letterboxing does not allocate
+    static thread_local std::vector<float> rows;
+    rows.resize(6 * width);
+    float* row0 = rows.data();
+    float* row1 = row0 + 3 * width;
+    int64_t cached0 = -1, cached1 = -1;
+    padRows(plan, dst);
+
+    for (uint y = 0; y < plan.resizeH; ++y)
+    {
+        const uint y0 = plan.yTap0[y];
+        const uint y1 = plan.yTap1[y];
+        if (cached0 != y0)
+        {
+            if (cached1 == y0)
+            {
+                std::swap(row0, row1);
+                std::swap(cached0, cached1);
+            }
+            else
+            {
+                resizeRow(plan, src + y0 * srcStep, swapRB, row0);
+                cached0 = y0;
+            }
+        }
+        if (cached1 != y1)
+        {
+            resizeRow(plan, src + y1 * srcStep, swapRB, row1);
+            cached1 = y1;
+        }
+
+        for (uint c = 0; c < 3; ++c)
+        {
+            T* out = dst + c * planeSize + static_cast<size_t>(plan.yOffset + y) * plan.dstW;
+            std::fill(out, out + plan.xOffset, pad);
+            blendRows(row0 + c * width, row1 + c * width, plan.yWeight[y], width,
+                      out + plan.xOffset);
+            std::fill(out + plan.xOffset + width, out + plan.dstW, pad);
+        }
+    }
+}
+
+void letterboxToCHW(const LetterboxPlan& plan, const uint8_t* src, const size_t srcStep,
+                    const bool swapRB, float* dst)
+{
+    letterbox(plan, src, srcStep, swapRB, dst);
+}
+
+void letterboxToCHW(const LetterboxPlan& plan, const uint8_t* src, const size_t srcStep,
+                    const bool swapRB, uint8_t* dst)
+{
+    letterbox(plan, src, srcStep, swapRB, dst);
+}
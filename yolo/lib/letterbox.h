@@ -0,0 +1,135 @@
+/**
+MIT License
+
+Copyright (c) 2018 NVIDIA CORPORATION. All rights reserved.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*
+*/
+
+#ifndef _LETTERBOX_H_
+#define _LETTERBOX_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+#include <sys/types.h>
+#include <vector>
+
+// Value of the border around a letterboxed image
+const uint8_t kLetterboxPadValue = 128;
+
+// How the image is resized into the letterbox
+enum class LetterboxFilter
+{
+    // 2x2 taps, as darknet resizes its inputs. The fast path
+    kBILINEAR,
+    // 4x4 taps with the kernel of cv::INTER_CUBIC, which the blobs were built with before the
+    // letterbox was fused. Scalar only, kept to compare the accuracy of both filters
+    kCUBIC
+};
+
+LetterboxFilter parseLetterboxFilter(const std::string& name);
+
+/**
+ * Geometry of letterboxing a srcW x srcH image into a dstW x dstH network input, along with
+ * the taps of every resized row and column. It only depends on the sizes, so it can be computed
+ * once and reused for every frame of a stream.
+ */
+struct LetterboxPlan
+{
+    // size of the image the taps sample
+    uint srcW;
+    uint srcH;
+    uint dstW;
+    uint dstH;
+    // the image is resized with the largest scale that fits it in the input and centred
+    uint resizeW;
+    uint resizeH;
+    uint xOffset;
+    uint yOffset;
+    // byte offsets within a source row of the two pixels each resized column blends, and the
+    // weight of the second one
+    std::vector<uint> xTap0;
+    std::vector<uint> xTap1;
+    std::vector<float> xWeight;
+    // source rows each resized row blends, and the weight of the second one
+    std::vector<uint> yTap0;
+    std::vector<uint> yTap1;
+    std::vector<float> yWeight;
+    // The bilinear taps above are left empty for kCUBIC plans, which instead blend
+    // kLetterboxCubicTaps consecutive entries for each resized column and row
+    LetterboxFilter filter;
+    std::vector<uint> xCubicTaps;
+    std::vector<float> xCubicWeights;
+    std::vector<uint> yCubicTaps;
+    std::vector<float> yCubicWeights;
+};
+
+const uint kLetterboxCubicTaps = 4;
+
+// scaleDenom > 1 plans for a srcW x srcH image decoded at 1 / scaleDenom of its size, rounded
+// up as libjpeg does. The geometry stays that of the full size image, so boxes map back to it
+// unchanged, while the taps sample the smaller decode.
+LetterboxPlan getLetterboxPlan(const uint srcW, const uint srcH, const uint dstW,
+                               const uint dstH, const uint scaleDenom = 1,
+                               const LetterboxFilter filter = LetterboxFilter::kBILINEAR);
+
+/**
+ * Letterbox plans keyed by source and input size. Every frame of a video stream has the same
+ * size, so once each stream has been seen no plan is computed or allocated again. The least
+ * recently used plan is replaced once maxPlans sizes are cached. All plans use the same filter.
+ */
+class LetterboxPlanCache
+{
+public:
+    explicit LetterboxPlanCache(const uint maxPlans = 16,
+                                const LetterboxFilter filter = LetterboxFilter::kBILINEAR);
+
+    // Computes the plan on a miss. The reference stays valid until maxPlans other sizes have
+    // been looked up. Not thread safe.
+    const LetterboxPlan& getPlan(const uint srcW, const uint srcH, const uint dstW,
+                                 const uint dstH);
+    uint getNumPlans() const { return m_Entries.size(); }
+    uint64_t getNumMisses() const { return m_NumMisses; }
+
+private:
+    struct Entry
+    {
+        LetterboxPlan plan;
+        uint64_t lastUse;
+    };
+    uint m_MaxPlans;
+    LetterboxFilter m_Filter;
+    uint64_t m_NumLookups;
+    uint64_t m_NumMisses;
+    // reserved up front, so entries never move
+    std::vector<Entry> m_Entries;
+};
+
+// Letterboxes a packed 3 channel 8-bit image with rows srcStep bytes apart in a single pass:
+// resize with the filter of the plan, padding, channel swap and planar packing. swapRB swaps
+// the first and last channel, e.g. to feed BGR frames to a network trained on RGB. dst receives
+// 3 planes of dstH x dstW values, pixel values are kept in [0, 255].
+void letterboxToCHW(const LetterboxPlan& plan, const uint8_t* src, const size_t srcStep,
+                    const bool swapRB, float* dst);
+void letterboxToCHW(const LetterboxPlan& plan, const uint8_t* src, const size_t srcStep,
+                    const bool swapRB, uint8_t* dst);
+
+#endif // _LETTERBOX_H_
@@ -0,0 +1,164 @@
+/**
+MIT License
+
+Copyright (c) 2018 NVIDIA CORPORATION. All rights reserved.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*
+*/
+
+#include "mapped_file.h"
+
+#include <cassert>
+#include <cstring>
+#include <fcntl.h>
+#include <iostream>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+MappedFile::MappedFile(const std::string& filePath) :
+    m_FilePath(filePath),
+    m_Data(nullptr),
+    m_Size(0)
+{
+    const int fd = open(m_FilePath.c_str(), O_RDONLY);
+    if (fd < 0)
+    {
+        std::cout << "Unable to open file : " << m_FilePath << std::endl;
+        assert(0);
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size <= 0)
+    {
+        std::cout << "Unable to map empty or unreadable file : " << m_FilePath << std::endl;
+        close(fd);
+        assert(0);
+    }
+    m_Size = static_cast<size_t>(st.st_size);
+    void* addr = mmap(nullptr, m_Size, PROT_READ, MAP_PRIVATE, fd, 0);
+    // the mapping holds its own reference to the file
+    close(fd);
+    if (addr == MAP_FAILED)
+    {
+        std::cout << "mmap failed for file : " << m_FilePath << std::endl;
+        assert(0);
+    }
+    // the file is consumed front to back, let the kernel read ahead aggressively
+    madvise(addr, m_Size, MADV_SEQUENTIAL);
+    m_Data = static_cast<const uint8_t*>(addr);
+}
+
+MappedFile::~MappedFile()
+{
+    if (m_Data) munmap(const_cast<uint8_t*>(m_Data), m_Size);
+}
+
+DarknetWeights::DarknetWeights(const std::string& weightsFilePath) :
+    m_File(weightsFilePath),
+    m_Major(0),
+    m_Minor(0),
+    m_Revision(0),
+    m_Seen(0),
+    m_HeaderSize(0),
+    m_Weights(nullptr),
+    m_NumWeights(0)
+{
+    const uint8_t* bytes = m_File.data();
+    const size_t numBytes = m_File.size();
+    int32_t version[3];
+    if (numBytes < sizeof(version) + sizeof(int32_t))
+    {
+        std::cout << "Truncated darknet header in weights file : " << weightsFilePath
+                  << std::endl;
+        assert(0);
+    }
+    memcpy(version, bytes, sizeof(version));
+    m_Major = version[0];
+    m_Minor = version[1];
+    m_Revision = version[2];
+    m_HeaderSize = sizeof(version);
+
+    // darknet widened "seen" from int32 to size_t in version 0.2
+    if ((m_Major * 10 + m_Minor) >= 2 && m_Major < 1000 && m_Minor < 1000)
+    {
+        if (numBytes < m_HeaderSize + sizeof(uint64_t))
+        {
+            std::cout << "Truncated darknet header in weights file : " << weightsFilePath
+                      << std::endl;
+            assert(0);
+        }
+        memcpy(&m_Seen, bytes + m_HeaderSize, sizeof(uint64_t));
+        m_HeaderSize += sizeof(uint64_t);
+    }
+    else
+    {
+        int32_t seen;
+        memcpy(&seen, bytes + m_HeaderSize, sizeof(int32_t));
+        m_Seen = static_cast<uint64_t>(seen);
+        m_HeaderSize += sizeof(int32_t);
+    }
+
+    if ((numBytes - m_HeaderSize) % sizeof(float) != 0)
+    {
+        std::cout << "Weights file " << weightsFilePath << " has a payload of "
+                  << numBytes - m_HeaderSize << " bytes, which is not a whole number of floats"
+                  << std::endl;
+        assert(0);
+    }
+    // the header is 16 or 20 bytes long and mmap is page aligned, so the payload is float aligned
+    m_Weights = reinterpret_cast<const float*>(bytes + m_HeaderSize);
+    m_NumWeights = (numBytes - m_HeaderSize) / sizeof(float);
+}
+
+const float* DarknetWeights::span(int& weightPtr, const int count) const
+{
+    assert(weightPtr >= 0 && count >= 0);
+    if (static_cast<size_t>(weightPtr) + static_cast<size_t>(count) > m_NumWeights)
+    {
+        std::cout << "Weights file " << m_File.getPath() << " holds " << m_NumWeights
+                  << " weights, layer needs " << count << " more at offset " << weightPtr
+                  << std::endl;
+        assert(0);
+    }
+    const float* values = m_Weights + weightPtr;
+    weightPtr += count;
+    return values;
+}
+
+uint64_t fnv1a64(const void* data, const size_t size)
+{
+    const uint8_t* bytes = static_cast<const uint8_t*>(data);
+    uint64_t hash = 14695981039346656037ULL;
+    size_t i = 0;
+    for (; i + sizeof(uint64_t) <= size; i += sizeof(uint64_t))
+    {
+        uint64_t word;
+        memcpy(&word, bytes + i, sizeof(uint64_t));
+        hash = (hash ^ word) * 1099511628211ULL;
+    }
+    for (; i < size; ++i) hash = (hash ^ bytes[i]) * 1099511628211ULL;
+    return hash;
+}
+
+uint64_t fileChecksum(const std::string& filePath)
+{
+    MappedFile file(filePath);
+    return fnv1a64(file.data(), file.size());
+}
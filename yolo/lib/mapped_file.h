@@ -0,0 +1,93 @@
+/**
+MIT License
+
+Copyright (c) 2018 NVIDIA CORPORATION. All rights reserved.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*
+*/
+
+#ifndef _MAPPED_FILE_H_
+#define _MAPPED_FILE_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+
+/**
+ * Read-only memory mapping of a whole file. Pages are faulted in from the page cache on first
+ * access, so nothing is copied onto the heap and the mapping stays valid until destruction.
+ */
+class MappedFile
+{
+public:
+    explicit MappedFile(const std::string& filePath);
+    ~MappedFile();
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    const std::string& getPath() const { return m_FilePath; }
+    const uint8_t* data() const { return m_Data; }
+    size_t size() const { return m_Size; }
+
+private:
+    std::string m_FilePath;
+    const uint8_t* m_Data;
+    size_t m_Size;
+};
+
+/**
+ * Darknet .weights file backed by a MappedFile. The header (major, minor, revision, seen) is
+ * parsed from the file itself, seen being 64 bits wide from version 0.2 onwards, and the float
+ * payload following it is handed out as spans into the mapping.
+ */
+class DarknetWeights
+{
+public:
+    explicit DarknetWeights(const std::string& weightsFilePath);
+
+    int getMajor() const { return m_Major; }
+    int getMinor() const { return m_Minor; }
+    int getRevision() const { return m_Revision; }
+    uint64_t getSeen() const { return m_Seen; }
+    size_t getHeaderSize() const { return m_HeaderSize; }
+    // Number of floats following the header
+    size_t size() const { return m_NumWeights; }
+    const float* data() const { return m_Weights; }
+    // Returns the next count weights starting at weightPtr and advances weightPtr past them.
+    // The span points into the mapping and is valid for the lifetime of this object.
+    const float* span(int& weightPtr, const int count) const;
+
+private:
+    MappedFile m_File;
+    int m_Major;
+    int m_Minor;
+    int m_Revision;
+    uint64_t m_Seen;
+    size_t m_HeaderSize;
+    const float* m_Weights;
+    size_t m_NumWeights;
+};
+
+// FNV-1a 64 bit hash, consumed 8 bytes at a time so checksumming a .weights file stays cheap
+uint64_t fnv1a64(const void* data, const size_t size);
+// FNV-1a of the whole content of a file
+uint64_t fileChecksum(const std::string& filePath);
+
+#endif // _MAPPED_FILE_H_
@@ -0,0 +1,604 @@
+/**
+MIT License
+
+Copyright (c) 2018 NVIDIA CORPORATION. All rights reserved.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*
+*/
+
+#include "nms.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cfloat>
+#include <cmath>
+#include <iostream>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define NMS_X86_SIMD
+#endif
+
+// Largest number of cells along each side of the grid used by the grid NMS engine
+static const uint kMaxGridCells = 64;
+// Below this many proposals building the grid costs more than the greedy loop saves
+static const uint kMinGridProposals = 64;
+// Widest vector of kept boxes compared at once, the SoA arrays are padded by this much
+static const uint kMaxSimdLanes = 16;
+
+// Bound by reference in cellHeads.assign(), so it needs a definition before C++17
+const uint NMSGrid::kEmpty;
+
+static float overlap1D(float x1min, float x1max, float x2min, float x2max)
+{
+    if (x1min > x2min)
+    {
+        std::swap(x1min, x2min);
+        std::swap(x1max, x2max);
+    }
+    return x1max < x2min ? 0 : std::min(x1max, x2max) - x2min;
+}
+
+static float computeIoU(const BBox& bbox1, const BBox& bbox2)
+{
+    float overlapX = overlap1D(bbox1.x1, bbox1.x2, bbox2.x1, bbox2.x2);
+    float overlapY = overlap1D(bbox1.y1, bbox1.y2, bbox2.y1, bbox2.y2);
+    float area1 = (bbox1.x2 - bbox1.x1) * (bbox1.y2 - bbox1.y1);
+    float area2 = (bbox2.x2 - bbox2.x1) * (bbox2.y2 - bbox2.y1);
+    float overlap2D = overlapX * overlapY;
+    float u = area1 + area2 - overlap2D;
+    return u == 0 ? 0 : overlap2D / u;
+}
+
+// Squared distance between the box centers over the squared diagonal of the smallest box
+// enclosing both
+static float computeCenterDistance(const BBox& bbox1, const BBox& bbox2)
+{
+    float dx = (bbox1.x1 + bbox1.x2) - (bbox2.x1 + bbox2.x2);
+    float dy = (bbox1.y1 + bbox1.y2) - (bbox2.y1 + bbox2.y2);
+    float cw = std::max(bbox1.x2, bbox2.x2) - std::min(bbox1.x1, bbox2.x1);
+    float ch = std::max(bbox1.y2, bbox2.y2) - std::min(bbox1.y1, bbox2.y1);
+    float c2 = cw * cw + ch * ch;
+    // The center deltas are twice the real ones
+    return c2 == 0 ? 0 : 0.25f * (dx * dx + dy * dy) / c2;
+}
+
+// The grid and SIMD engines assume finite boxes with x1 <= x2 and y1 <= y2
+static bool boxesAreWellFormed(const std::vector<BBoxInfo>& binfo, const uint* order,
+                               const uint count)
+{
+    for (uint i = 0; i < count; ++i)
+    {
+        const BBox& box = binfo[order[i]].box;
+        if (!(std::isfinite(box.x1) && std::isfinite(box.x2) && std::isfinite(box.y1)
+              && std::isfinite(box.y2) && (box.x1 <= box.x2) && (box.y1 <= box.y2)))
+            return false;
+    }
+    return true;
+}
+
+static void sortByProb(const std::vector<BBoxInfo>& binfo, std::vector<uint>& order)
+{
+    // Sorting indices with the original position as tie-break gives the same order as a
+    // stable sort, without the temporary buffer std::stable_sort allocates
+    order.resize(binfo.size());
+    for (uint i = 0; i < order.size(); ++i) order[i] = i;
+    std::sort(order.begin(), order.end(), [&binfo](const uint i1, const uint i2) {
+        return (binfo[i1].prob > binfo[i2].prob)
+            || ((binfo[i1].prob == binfo[i2].prob) && (i1 < i2));
+    });
+}
+
+static void sortByLabelAndProb(const std::vector<BBoxInfo>& binfo, std::vector<uint>& order)
+{
+    // Same order as bucketing the boxes by class and sorting every bucket with sortByProb, in a
+    // single sort. Sorting on the label plays the role of offsetting every box by
+    // label * maxCoord, without rounding the coordinates the IoU is computed from.
+    order.resize(binfo.size());
+    for (uint i = 0; i < order.size(); ++i) order[i] = i;
+    std::sort(order.begin(), order.end(), [&binfo](const uint i1, const uint i2) {
+        if (binfo[i1].label != binfo[i2].label) return binfo[i1].label < binfo[i2].label;
+        return (binfo[i1].prob > binfo[i2].prob)
+            || ((binfo[i1].prob == binfo[i2].prob) && (i1 < i2));
+    });
+}
+
+NMSEngine parseNMSEngine(const std::string& name)
+{
+    if (name == "greedy")
+        return NMSEngine::kGREEDY;
+    else if (name == "grid")
+        return NMSEngine::kGRID;
+    else if (name == "simd")
+        return NMSEngine::kSIMD;
+
+    std::cout << "Unrecognized NMS engine " << name << std::endl;
+    assert(0);
+    return NMSEngine::kGREEDY;
+}
+
+NMSType parseNMSType(const std::string& name)
+{
+    if (name == "hard")
+        return NMSType::kHARD;
+    else if (name == "soft_linear")
+        return NMSType::kSOFT_LINEAR;
+    else if (name == "soft_gaussian")
+        return NMSType::kSOFT_GAUSSIAN;
+    else if (name == "diou")
+        return NMSType::kDIOU;
+
+    std::cout << "Unrecognized NMS type " << name << std::endl;
+    assert(0);
+    return NMSType::kHARD;
+}
+
+void DetectionArena::reserve(const uint numClasses, const uint maxProposals)
+{
+    proposals.reserve(maxProposals);
+    order.reserve(maxProposals);
+    detections.reserve(maxProposals);
+    classProposals.resize(numClasses);
+    grid.cellHeads.reserve(kMaxGridCells * kMaxGridCells);
+    grid.visited.reserve(maxProposals);
+    keptBoxes.resize(maxProposals);
+    softCandidates.reserve(maxProposals);
+}
+
+void NMSKeptBoxes::resize(const uint maxBoxes)
+{
+    // Never shrinks, so the arrays stop reallocating once they fit the largest class seen
+    if (x1.size() >= maxBoxes + kMaxSimdLanes) return;
+    x1.resize(maxBoxes + kMaxSimdLanes);
+    y1.resize(maxBoxes + kMaxSimdLanes);
+    x2.resize(maxBoxes + kMaxSimdLanes);
+    y2.resize(maxBoxes + kMaxSimdLanes);
+    area.resize(maxBoxes + kMaxSimdLanes);
+}
+
+std::vector<BBoxInfo> nmsAllClasses(const float nmsThresh, std::vector<BBoxInfo>& binfo,
+                                    const uint numClasses)
+{
+    DetectionArena arena;
+    arena.proposals = binfo;
+    nmsAllClasses(NMSParams{nmsThresh, 0, NMSEngine::kGREEDY, false, NMSType::kHARD, 0, 0},
+                  numClasses, arena);
+    return arena.detections;
+}
+
+void selectTopK(const uint k, std::vector<BBoxInfo>& binfo)
+{
+    if ((k == 0) || (binfo.size() <= k)) return;
+    // Linear-time selection, the survivors are sorted by NMS anyway
+    std::nth_element(binfo.begin(), binfo.begin() + (k - 1), binfo.end(),
+                     [](const BBoxInfo& b1, const BBoxInfo& b2) { return b1.prob > b2.prob; });
+    binfo.resize(k);
+}
+
+std::vector<BBoxInfo> nonMaximumSuppression(const float nmsThresh, std::vector<BBoxInfo> binfo)
+{
+    std::vector<uint> order;
+    std::vector<BBoxInfo> out;
+    nonMaximumSuppression(nmsThresh, binfo, order, out);
+    return out;
+}
+
+// The suppress* routines run NMS on binfo[order[0]] ... binfo[order[count - 1]], which have to
+// be sorted by decreasing probability already. Kept boxes are appended after whatever the caller
+// already has in 'out'.
+static void greedySuppress(const float nmsThresh, const std::vector<BBoxInfo>& binfo,
+                           const uint* order, const uint count, std::vector<BBoxInfo>& out)
+{
+    const uint outStart = out.size();
+    for (uint i = 0; i < count; ++i)
+    {
+        const uint idx = order[i];
+        const BBox& box = binfo[idx].box;
+        bool keep = true;
+        for (uint j = outStart; j < out.size(); ++j)
+        {
+            if (keep)
+            {
+                float overlap = computeIoU(box, out[j].box);
+                keep = overlap <= nmsThresh;
+            }
+            else
+                break;
+        }
+        if (keep) out.push_back(binfo[idx]);
+    }
+}
+
+static void gridSuppress(const float nmsThresh, const std::vector<BBoxInfo>& binfo,
+                         const uint* order, const uint count, NMSGrid& grid,
+                         std::vector<BBoxInfo>& out)
+{
+    // A box can only push the IoU with a kept box above a non-negative threshold if the two
+    // intersect, and intersecting boxes always share a cell. Every kept box that can suppress a
+    // candidate is therefore visited, which keeps the result identical to the greedy loop.
+    if (!(nmsThresh >= 0) || (count < kMinGridProposals))
+    {
+        greedySuppress(nmsThresh, binfo, order, count, out);
+        return;
+    }
+
+    // Inverted or non-finite boxes can't be placed in the grid
+    if (!boxesAreWellFormed(binfo, order, count))
+    {
+        greedySuppress(nmsThresh, binfo, order, count, out);
+        return;
+    }
+
+    float minX = FLT_MAX, minY = FLT_MAX, maxX = -FLT_MAX, maxY = -FLT_MAX;
+    float sumW = 0, sumH = 0;
+    for (uint i = 0; i < count; ++i)
+    {
+        const BBox& box = binfo[order[i]].box;
+        minX = std::min(minX, box.x1);
+        minY = std::min(minY, box.y1);
+        maxX = std::max(maxX, box.x2);
+        maxY = std::max(maxY, box.y2);
+        sumW += box.x2 - box.x1;
+        sumH += box.y2 - box.y1;
+    }
+
+    // Cells roughly the size of an average box keep the number of cells a box spans small
+    const float rangeX = maxX - minX, rangeY = maxY - minY;
+    const float cellsX = rangeX * count / sumW, cellsY = rangeY * count / sumH;
+    const uint cols = cellsX < kMaxGridCells ? static_cast<uint>(cellsX) + 1 : kMaxGridCells;
+    const uint rows = cellsY < kMaxGridCells ? static_cast<uint>(cellsY) + 1 : kMaxGridCells;
+    const float scaleX = rangeX > 0 ? cols / rangeX : 0, scaleY = rangeY > 0 ? rows / rangeY : 0;
+    // Monotonic in the coordinate, so the cell range of a box covers every point inside it
+    auto cellX = [&](const float x) {
+        return std::min(cols - 1, static_cast<uint>((x - minX) * scaleX));
+    };
+    auto cellY = [&](const float y) {
+        return std::min(rows - 1, static_cast<uint>((y - minY) * scaleY));
+    };
+
+    grid.cellHeads.assign(cols * rows, NMSGrid::kEmpty);
+    grid.entryBoxes.clear();
+    grid.entryNext.clear();
+    grid.visited.clear();
+
+    const uint outStart = out.size();
+    for (uint i = 0; i < count; ++i)
+    {
+        const BBox& box = binfo[order[i]].box;
+        const uint cx1 = cellX(box.x1), cx2 = cellX(box.x2);
+        const uint cy1 = cellY(box.y1), cy2 = cellY(box.y2);
+        bool keep = true;
+        for (uint cy = cy1; keep && cy <= cy2; ++cy)
+        {
+            for (uint cx = cx1; keep && cx <= cx2; ++cx)
+            {
+                for (uint e = grid.cellHeads[cy * cols + cx]; e != NMSGrid::kEmpty;
+                     e = grid.entryNext[e])
+                {
+                    const uint k = grid.entryBoxes[e];
+                    if (grid.visited[k] == i) continue;
+                    grid.visited[k] = i;
+                    float overlap = computeIoU(box, out[outStart + k].box);
+                    keep = overlap <= nmsThresh;
+                    if (!keep) break;
+                }
+            }
+        }
+        if (!keep) continue;
+
+        const uint k = out.size() - outStart;
+        out.push_back(binfo[order[i]]);
+        grid.visited.push_back(i);
+        for (uint cy = cy1; cy <= cy2; ++cy)
+        {
+            for (uint cx = cx1; cx <= cx2; ++cx)
+            {
+                const uint cell = cy * cols + cx;
+                grid.entryBoxes.push_back(k);
+                grid.entryNext.push_back(grid.cellHeads[cell]);
+                grid.cellHeads[cell] = grid.entryBoxes.size() - 1;
+            }
+        }
+    }
+}
+
+// Overlap tests of one candidate against the first 'count' kept boxes. They return true if the
+// IoU with any of them is above nmsThresh. For well formed boxes max(min(max) - max(min), 0) is
+// exactly what overlap1D computes, and the IoU is built from the same operations in the same
+// order as computeIoU, so all of them agree with the greedy loop bit for bit.
+typedef bool (*OverlapTest)(const BBox& box, const float area, const NMSKeptBoxes& kept,
+                            const uint count, const float nmsThresh);
+
+static bool overlapsKeptScalar(const BBox& box, const float area, const NMSKeptBoxes& kept,
+                               const uint count, const float nmsThresh)
+{
+    for (uint j = 0; j < count; ++j)
+    {
+        float overlapX
+            = std::max(std::min(box.x2, kept.x2[j]) - std::max(box.x1, kept.x1[j]), 0.0f);
+        float overlapY
+            = std::max(std::min(box.y2, kept.y2[j]) - std::max(box.y1, kept.y1[j]), 0.0f);
+        float overlap2D = overlapX * overlapY;
+        float u = area + kept.area[j] - overlap2D;
+        float overlap = u == 0 ? 0 : overlap2D / u;
+        if (!(overlap <= nmsThresh)) return true;
+    }
+    return false;
+}
+
+#ifdef NMS_X86_SIMD
+__attribute__((target("avx2"))) static bool overlapsKeptAVX2(const BBox& box, const float area,
+                                                              const NMSKeptBoxes& kept,
+                                                              const uint count,
+                                                              const float nmsThresh)
+{
+    const __m256 bx1 = _mm256_set1_ps(box.x1), by1 = _mm256_set1_ps(box.y1);
+    const __m256 bx2 = _mm256_set1_ps(box.x2), by2 = _mm256_set1_ps(box.y2);
+    const __m256 barea = _mm256_set1_ps(area), thresh = _mm256_set1_ps(nmsThresh);
+    const __m256 zero = _mm256_setzero_ps();
+    for (uint j = 0; j < count; j += 8)
+    {
+        __m256 overlapX = _mm256_sub_ps(_mm256_min_ps(bx2, _mm256_loadu_ps(&kept.x2[j])),
+                                        _mm256_max_ps(bx1, _mm256_loadu_ps(&kept.x1[j])));
+        __m256 overlapY = _mm256_sub_ps(_mm256_min_ps(by2, _mm256_loadu_ps(&kept.y2[j])),
+                                        _mm256_max_ps(by1, _mm256_loadu_ps(&kept.y1[j])));
+        __m256 overlap2D
+            = _mm256_mul_ps(_mm256_max_ps(overlapX, zero), _mm256_max_ps(overlapY, zero));
+        __m256 u = _mm256_sub_ps(_mm256_add_ps(barea, _mm256_loadu_ps(&kept.area[j])), overlap2D);
+        __m256 overlap = _mm256_andnot_ps(_mm256_cmp_ps(u, zero, _CMP_EQ_OQ),
+                                          _mm256_div_ps(overlap2D, u));
+        // One bit per kept box that suppresses the candidate, lanes past 'count' are padding
+        uint mask = _mm256_movemask_ps(_mm256_cmp_ps(overlap, thresh, _CMP_NLE_UQ));
+        if (count - j < 8) mask &= (1u << (count - j)) - 1;
+        if (mask) return true;
+    }
+    return false;
+}
+
+// GCC 12 reports false maybe-uninitialized warnings inside the AVX-512 min/max intrinsics
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+__attribute__((target("avx512f"))) static bool overlapsKeptAVX512(const BBox& box,
+                                                                  const float area,
+                                                                  const NMSKeptBoxes& kept,
+                                                                  const uint count,
+                                                                  const float nmsThresh)
+{
+    const __m512 bx1 = _mm512_set1_ps(box.x1), by1 = _mm512_set1_ps(box.y1);
+    const __m512 bx2 = _mm512_set1_ps(box.x2), by2 = _mm512_set1_ps(box.y2);
+    const __m512 barea = _mm512_set1_ps(area), thresh = _mm512_set1_ps(nmsThresh);
+    const __m512 zero = _mm512_setzero_ps();
+    for (uint j = 0; j < count; j += 16)
+    {
+        __m512 overlapX = _mm512_sub_ps(_mm512_min_ps(bx2, _mm512_loadu_ps(&kept.x2[j])),
+                                        _mm512_max_ps(bx1, _mm512_loadu_ps(&kept.x1[j])));
+        __m512 overlapY = _mm512_sub_ps(_mm512_min_ps(by2, _mm512_loadu_ps(&kept.y2[j])),
+                                        _mm512_max_ps(by1, _mm512_loadu_ps(&kept.y1[j])));
+        __m512 overlap2D
+            = _mm512_mul_ps(_mm512_max_ps(overlapX, zero), _mm512_max_ps(overlapY, zero));
+        __m512 u = _mm512_sub_ps(_mm512_add_ps(barea, _mm512_loadu_ps(&kept.area[j])), overlap2D);
+        __m512 overlap = _mm512_mask_blend_ps(_mm512_cmp_ps_mask(u, zero, _CMP_EQ_OQ),
+                                              _mm512_div_ps(overlap2D, u), zero);
+        // One bit per kept box that suppresses the candidate, lanes past 'count' are padding
+        __mmask16 mask = _mm512_cmp_ps_mask(overlap, thresh, _CMP_NLE_UQ);
+        if (count - j < 16) mask &= (1u << (count - j)) - 1;
+        if (mask) return true;
+    }
+    return false;
+}
+#pragma GCC diagnostic pop
+#endif
+
+static OverlapTest selectOverlapTest()
+{
+#ifdef NMS_X86_SIMD
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f")) return overlapsKeptAVX512;
+    if (__builtin_cpu_supports("avx2")) return overlapsKeptAVX2;
+#endif
+    return overlapsKeptScalar;
+}
+
+static void simdSuppress(const float nmsThresh, const std::vector<BBoxInfo>& binfo,
+                         const uint* order, const uint count, NMSKeptBoxes& keptBoxes,
+                         std::vector<BBoxInfo>& out)
+{
+    // Picked once from the instruction sets of the CPU we are running on
+    static const OverlapTest overlapsKept = selectOverlapTest();
+
+    if (!boxesAreWellFormed(binfo, order, count))
+    {
+        greedySuppress(nmsThresh, binfo, order, count, out);
+        return;
+    }
+
+    keptBoxes.resize(count);
+    keptBoxes.count = 0;
+
+    for (uint i = 0; i < count; ++i)
+    {
+        const uint idx = order[i];
+        const BBox& box = binfo[idx].box;
+        const float area = (box.x2 - box.x1) * (box.y2 - box.y1);
+        if (overlapsKept(box, area, keptBoxes, keptBoxes.count, nmsThresh)) continue;
+
+        const uint k = keptBoxes.count++;
+        keptBoxes.x1[k] = box.x1;
+        keptBoxes.y1[k] = box.y1;
+        keptBoxes.x2[k] = box.x2;
+        keptBoxes.y2[k] = box.y2;
+        keptBoxes.area[k] = area;
+        out.push_back(binfo[idx]);
+    }
+}
+
+static void diouSuppress(const float nmsThresh, const std::vector<BBoxInfo>& binfo,
+                         const uint* order, const uint count, std::vector<BBoxInfo>& out)
+{
+    const uint outStart = out.size();
+    for (uint i = 0; i < count; ++i)
+    {
+        const uint idx = order[i];
+        const BBox& box = binfo[idx].box;
+        bool keep = true;
+        for (uint j = outStart; keep && j < out.size(); ++j)
+        {
+            float overlap = computeIoU(box, out[j].box) - computeCenterDistance(box, out[j].box);
+            keep = overlap <= nmsThresh;
+        }
+        if (keep) out.push_back(binfo[idx]);
+    }
+}
+
+static void softSuppress(const NMSParams& params, const std::vector<BBoxInfo>& binfo,
+                         const uint* order, const uint count, std::vector<BBoxInfo>& candidates,
+                         std::vector<BBoxInfo>& out)
+{
+    candidates.clear();
+    for (uint i = 0; i < count; ++i) candidates.push_back(binfo[order[i]]);
+
+    // Scores change after every pick, so the next box to keep has to be searched for each time.
+    // Ties go to the earliest candidate, which keeps the result independent of the engine.
+    while (!candidates.empty())
+    {
+        uint best = 0;
+        for (uint j = 1; j < candidates.size(); ++j)
+        {
+            if (candidates[j].prob > candidates[best].prob) best = j;
+        }
+        const BBoxInfo kept = candidates[best];
+        out.push_back(kept);
+
+        // Decay the rest in place, dropping the ones that no longer pass the threshold
+        uint remaining = 0;
+        for (uint j = 0; j < candidates.size(); ++j)
+        {
+            if (j == best) continue;
+            BBoxInfo& cand = candidates[j];
+            float overlap = computeIoU(cand.box, kept.box);
+            if (params.type == NMSType::kSOFT_LINEAR)
+            {
+                if (overlap > params.nmsThresh) cand.prob *= 1 - overlap;
+            }
+            else
+            {
+                cand.prob *= std::exp(-(overlap * overlap) / params.softNMSSigma);
+            }
+            if (cand.prob > params.probThresh) candidates[remaining++] = cand;
+        }
+        candidates.resize(remaining);
+    }
+}
+
+static void suppress(const NMSParams& params, const std::vector<BBoxInfo>& binfo,
+                     const uint* order, const uint count, DetectionArena& arena)
+{
+    switch (params.type)
+    {
+    case NMSType::kSOFT_LINEAR:
+    case NMSType::kSOFT_GAUSSIAN:
+        softSuppress(params, binfo, order, count, arena.softCandidates, arena.detections);
+        return;
+    case NMSType::kDIOU:
+        diouSuppress(params.nmsThresh, binfo, order, count, arena.detections);
+        return;
+    default: break;
+    }
+
+    switch (params.engine)
+    {
+    case NMSEngine::kGRID:
+        gridSuppress(params.nmsThresh, binfo, order, count, arena.grid, arena.detections);
+        break;
+    case NMSEngine::kSIMD:
+        simdSuppress(params.nmsThresh, binfo, order, count, arena.keptBoxes, arena.detections);
+        break;
+    default: greedySuppress(params.nmsThresh, binfo, order, count, arena.detections); break;
+    }
+}
+
+void nonMaximumSuppression(const float nmsThresh, const std::vector<BBoxInfo>& binfo,
+                           std::vector<uint>& order, std::vector<BBoxInfo>& out)
+{
+    sortByProb(binfo, order);
+    greedySuppress(nmsThresh, binfo, order.data(), order.size(), out);
+}
+
+void gridNonMaximumSuppression(const float nmsThresh, const std::vector<BBoxInfo>& binfo,
+                               std::vector<uint>& order, NMSGrid& grid,
+                               std::vector<BBoxInfo>& out)
+{
+    sortByProb(binfo, order);
+    gridSuppress(nmsThresh, binfo, order.data(), order.size(), grid, out);
+}
+
+void simdNonMaximumSuppression(const float nmsThresh, const std::vector<BBoxInfo>& binfo,
+                               std::vector<uint>& order, NMSKeptBoxes& keptBoxes,
+                               std::vector<BBoxInfo>& out)
+{
+    sortByProb(binfo, order);
+    simdSuppress(nmsThresh, binfo, order.data(), order.size(), keptBoxes, out);
+}
+
+void nmsAllClasses(const NMSParams& params, const uint numClasses, DetectionArena& arena)
+{
+    arena.detections.clear();
+    if (params.batched)
+    {
+        // One sort over all the proposals, then every run of equal labels is suppressed in place
+        sortByLabelAndProb(arena.proposals, arena.order);
+        uint begin = 0;
+        while (begin < arena.order.size())
+        {
+            const int label = arena.proposals[arena.order[begin]].label;
+            assert(label >= 0 && static_cast<uint>(label) < numClasses);
+            uint end = begin + 1;
+            while ((end < arena.order.size()) && (arena.proposals[arena.order[end]].label == label))
+                ++end;
+            suppress(params, arena.proposals, arena.order.data() + begin, end - begin, arena);
+            begin = end;
+        }
+    }
+    else
+    {
+        if (arena.classProposals.size() < numClasses) arena.classProposals.resize(numClasses);
+        for (uint c = 0; c < numClasses; ++c) arena.classProposals[c].clear();
+        for (auto& box : arena.proposals)
+        {
+            arena.classProposals.at(box.label).push_back(box);
+        }
+
+        for (uint c = 0; c < numClasses; ++c)
+        {
+            sortByProb(arena.classProposals[c], arena.order);
+            suppress(params, arena.classProposals[c], arena.order.data(), arena.order.size(),
+                     arena);
+        }
+    }
+
+    if ((params.maxDetections > 0) && (arena.detections.size() > params.maxDetections))
+    {
+        std::partial_sort(
+            arena.detections.begin(), arena.detections.begin() + params.maxDetections,
+            arena.detections.end(),
+            [](const BBoxInfo& b1, const BBoxInfo& b2) { return b1.prob > b2.prob; });
+        arena.detections.resize(params.maxDetections);
+    }
+}
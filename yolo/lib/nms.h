@@ -0,0 +1,165 @@
+/**
+MIT License
+
+Copyright (c) 2018 NVIDIA CORPORATION. All rights reserved.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*
+*/
+
+#ifndef _NMS_H_
+#define _NMS_H_
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+struct BBox
+{
+    float x1, y1, x2, y2;
+};
+
+struct BBoxInfo
+{
+    BBox box;
+    int label;
+    int classId; // For coco benchmarking
+    float prob;
+};
+
+// Implementations of the greedy per-class suppression, all of them keep the same boxes
+enum class NMSEngine
+{
+    // Compares every candidate against every box kept so far
+    kGREEDY,
+    // Buckets kept boxes in a uniform grid and only compares candidates against boxes sharing a
+    // cell with them
+    kGRID,
+    // Compares every candidate against a vector register of kept boxes at a time
+    kSIMD
+};
+
+// How a kept box treats the boxes overlapping it
+enum class NMSType
+{
+    // Drops boxes whose IoU with a kept box is above nmsThresh
+    kHARD,
+    // Scales the score of boxes whose IoU is above nmsThresh by (1 - IoU)
+    kSOFT_LINEAR,
+    // Scales the score of every box by exp(-IoU^2 / softNMSSigma)
+    kSOFT_GAUSSIAN,
+    // Drops boxes whose IoU minus the normalized distance between the box centers is above
+    // nmsThresh, so neighbouring objects in crowds survive more often
+    kDIOU
+};
+
+/**
+ * Settings used to suppress overlapping detections of an image.
+ */
+struct NMSParams
+{
+    float nmsThresh;
+    // Number of highest-confidence detections kept after NMS, 0 keeps all of them
+    uint maxDetections;
+    NMSEngine engine;
+    // Suppress all classes in one pass over a single sort instead of bucketing them by class
+    // first. Keeps the same detections in the same order.
+    bool batched;
+    // Suppression rule, the engine only applies to NMSType::kHARD
+    NMSType type;
+    // Soft-NMS only. Width of the Gaussian decay, and the score a decayed box has to stay above
+    // to be kept
+    float softNMSSigma;
+    float probThresh;
+};
+
+/**
+ * Uniform grid over the boxes kept by the grid NMS engine. Every cell holds a linked list of the
+ * kept boxes overlapping it, stored in flat arrays so the grid can be reused across classes and
+ * frames without touching the heap.
+ */
+struct NMSGrid
+{
+    // Index of the first entry of every cell, or kEmpty
+    std::vector<uint> cellHeads;
+    // Kept box referenced by every entry and the next entry of the same cell
+    std::vector<uint> entryBoxes;
+    std::vector<uint> entryNext;
+    // Last candidate every kept box was compared against, so boxes spanning several cells are
+    // only compared once per candidate
+    std::vector<uint> visited;
+
+    static const uint kEmpty = UINT32_MAX;
+};
+
+/**
+ * Boxes kept by the SIMD NMS engine, stored as structure-of-arrays so a candidate can be compared
+ * against 8 (AVX2) or 16 (AVX-512) kept boxes with a single instruction per operation. The arrays
+ * are padded past the last kept box so full vectors can always be loaded.
+ */
+struct NMSKeptBoxes
+{
+    std::vector<float> x1, y1, x2, y2, area;
+    uint count;
+
+    void resize(const uint maxBoxes);
+};
+
+/**
+ * Caller-owned scratch space used to decode and suppress the detections of a single image.
+ * Buffers are cleared but never shrunk between frames, so once an arena has grown to the
+ * working size of a stream, decoding and NMS no longer touch the heap.
+ */
+struct DetectionArena
+{
+    // Proposals decoded from all the output tensors of the image
+    std::vector<BBoxInfo> proposals;
+    // Proposals split by class label
+    std::vector<std::vector<BBoxInfo>> classProposals;
+    // Sort order of the proposals being suppressed
+    std::vector<uint> order;
+    // Spatial index used by NMSEngine::kGRID
+    NMSGrid grid;
+    // Kept boxes used by NMSEngine::kSIMD
+    NMSKeptBoxes keptBoxes;
+    // Boxes whose scores are still being decayed by soft-NMS
+    std::vector<BBoxInfo> softCandidates;
+    // Detections left after NMS
+    std::vector<BBoxInfo> detections;
+
+    void reserve(const uint numClasses, const uint maxProposals);
+};
+
+NMSEngine parseNMSEngine(const std::string& name);
+NMSType parseNMSType(const std::string& name);
+std::vector<BBoxInfo> nmsAllClasses(const float nmsThresh, std::vector<BBoxInfo>& binfo,
+                                    const uint numClasses);
+void nmsAllClasses(const NMSParams& params, const uint numClasses, DetectionArena& arena);
+void selectTopK(const uint k, std::vector<BBoxInfo>& binfo);
+std::vector<BBoxInfo> nonMaximumSuppression(const float nmsThresh, std::vector<BBoxInfo> binfo);
+void nonMaximumSuppression(const float nmsThresh, const std::vector<BBoxInfo>& binfo,
+                           std::vector<uint>& order, std::vector<BBoxInfo>& out);
+void gridNonMaximumSuppression(const float nmsThresh, const std::vector<BBoxInfo>& binfo,
+                               std::vector<uint>& order, NMSGrid& grid,
+                               std::vector<BBoxInfo>& out);
+void simdNonMaximumSuppression(const float nmsThresh, const std::vector<BBoxInfo>& binfo,
+                               std::vector<uint>& order, NMSKeptBoxes& keptBoxes,
+                               std::vector<BBoxInfo>& out);
+
+#endif // _NMS_H_
@@ -0,0 +1,225 @@
+/**
+MIT License
+
+Copyright (c) 2018 NVIDIA CORPORATION. All rights reserved.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*
+*/
+
+#ifndef _PIPELINE_H_
+#define _PIPELINE_H_
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <stdint.h>
+#include <string>
+#include <sys/types.h>
+#include <thread>
+#include <vector>
+
+/**
+ * Fixed capacity FIFO connecting two pipeline stages. Producers block while it is full, which
+ * bounds the number of items in flight, and consumers block while it is empty until it is closed.
+ */
+template <typename T>
+class BoundedQueue
+{
+public:
+    explicit BoundedQueue(const uint capacity) :
+        m_Capacity(std::max(capacity, 1u)),
+        m_Closed(false)
+    {
+    }
+    BoundedQueue(const BoundedQueue&) = delete;
+    BoundedQueue& operator=(const BoundedQueue&) = delete;
+
+    // Blocks while the queue is full. Returns false and drops the item if the queue is closed
+    bool push(T item)
+    {
+        std::unique_lock<std::mutex> lock(m_Mutex);
+        m_NotFull.wait(lock, [this] { return m_Closed || (m_Items.size() < m_Capacity); });
+        if (m_Closed) return false;
+        m_Items.push_back(std::move(item));
+        m_NotEmpty.notify_one();
+        return true;
+    }
+    // Blocks while the queue is empty. Returns false once it is closed and drained
+    bool pop(T& item)
+    {
+        std::unique_lock<std::mutex> lock(m_Mutex);
+        m_NotEmpty.wait(lock, [this] { return m_Closed || !m_Items.empty(); });
+        if (m_Items.empty()) return false;
+        item = std::move(m_Items.front());
+        m_Items.pop_front();
+        m_NotFull.notify_one();
+        return true;
+    }
+    // Called by the last producer, consumers still get the items already queued
+    void close()
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        m_Closed = true;
+        m_NotFull.notify_all();
+        m_NotEmpty.notify_all();
+    }
+
+private:
+    const uint m_Capacity;
+    bool m_Closed;
+    std::deque<T> m_Items;
+    std::mutex m_Mutex;
+    std::condition_variable m_NotFull;
+    std::condition_variable m_NotEmpty;
+};
+
+struct PipelineStageStats
+{
+    std::string name;
+    uint numThreads;
+    // Items processed, weighted by the item count function of the stage
+    uint64_t numItems;
+    // Summed over the threads of the stage
+    double busyMs;
+    // Time spent waiting on an empty input queue, i.e. on upstream stages
+    double starvedMs;
+    // Time spent waiting on a full output queue, i.e. on downstream stages
+    double blockedMs;
+
+    // Items per second the stage sustains with all its threads busy
+    double getThroughput() const
+    {
+        return busyMs > 0 ? numItems * numThreads * 1000.0 / busyMs : 0;
+    }
+};
+
+/**
+ * Set of threads that pop items from an input queue, run the work of the stage on them and push
+ * them to an output queue. The output queue is closed once the input queue is closed and every
+ * thread of the stage is done, so closing the first queue of a chain shuts all of it down.
+ * With more than one thread items can leave the stage out of order.
+ */
+template <typename T>
+class PipelineStage
+{
+public:
+    typedef std::function<void(T&)> Work;
+    typedef std::function<uint(const T&)> ItemCount;
+
+    PipelineStage(const std::string& name, const uint numThreads, BoundedQueue<T>& input,
+                  BoundedQueue<T>& output, const Work& work, const ItemCount& itemCount = nullptr) :
+        m_Stats{name, std::max(numThreads, 1u), 0, 0.0, 0.0, 0.0},
+        m_Input(input),
+        m_Output(output),
+        m_Work(work),
+        m_ItemCount(itemCount),
+        m_ActiveThreads(m_Stats.numThreads)
+    {
+        for (uint i = 0; i < m_Stats.numThreads; ++i)
+            m_Threads.emplace_back(&PipelineStage::threadLoop, this);
+    }
+    ~PipelineStage() { join(); }
+    PipelineStage(const PipelineStage&) = delete;
+    PipelineStage& operator=(const PipelineStage&) = delete;
+
+    // Returns once the input queue is closed and drained
+    void join()
+    {
+        for (auto& thread : m_Threads)
+            if (thread.joinable()) thread.join();
+    }
+    // Complete once join() has returned
+    const PipelineStageStats& getStats() const { return m_Stats; }
+
+private:
+    typedef std::chrono::steady_clock Clock;
+    static double elapsedMs(const Clock::time_point& start, const Clock::time_point& end)
+    {
+        return std::chrono::duration<double, std::milli>(end - start).count();
+    }
+
+    void threadLoop()
+    {
+        PipelineStageStats local{m_Stats.name, 1, 0, 0.0, 0.0, 0.0};
+        T item;
+        Clock::time_point waitStart = Clock::now();
+        while (m_Input.pop(item))
+        {
+            const Clock::time_point workStart = Clock::now();
+            m_Work(item);
+            const Clock::time_point workEnd = Clock::now();
+            local.numItems += m_ItemCount ? m_ItemCount(item) : 1;
+            m_Output.push(std::move(item));
+            local.starvedMs += elapsedMs(waitStart, workStart);
+            local.busyMs += elapsedMs(workStart, workEnd);
+            waitStart = Clock::now();
+            local.blockedMs += elapsedMs(workEnd, waitStart);
+        }
+
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        m_Stats.numItems += local.numItems;
+        m_Stats.busyMs += local.busyMs;
+        m_Stats.starvedMs += local.starvedMs;
+        m_Stats.blockedMs += local.blockedMs;
+        if (--m_ActiveThreads == 0) m_Output.close();
+    }
+
+    PipelineStageStats m_Stats;
+    BoundedQueue<T>& m_Input;
+    BoundedQueue<T>& m_Output;
+    const Work m_Work;
+    const ItemCount m_ItemCount;
+    std::mutex m_Mutex;
+    uint m_ActiveThreads;
+    std::vector<std::thread> m_Threads;
+};
+
+/**
+ * Puts items that left multi-threaded stages out of order back in sequence. Items are numbered
+ * from 0 by the producer, each one is released once all the items before it have been.
+ */
+template <typename T>
+class ReorderBuffer
+{
+public:
+    ReorderBuffer() : m_NextIndex(0) {}
+
+    void push(const uint index, T item) { m_Pending[index] = std::move(item); }
+    // Returns false while the next item in sequence hasn't been pushed
+    bool pop(T& item)
+    {
+        if (m_Pending.empty() || (m_Pending.begin()->first != m_NextIndex)) return false;
+        item = std::move(m_Pending.begin()->second);
+        m_Pending.erase(m_Pending.begin());
+        ++m_NextIndex;
+        return true;
+    }
+    uint getNumPending() const { return m_Pending.size(); }
+
+private:
+    uint m_NextIndex;
+    std::map<uint, T> m_Pending;
+};
+
+#endif // _PIPELINE_H_
@@ -109,20 +109,30 @@ YoloLayerV3::YoloLayerV3(const void* data, size_t length)
     const char *d = static_cast<const char*>(data), *a = d;
     read(d, m_NumBoxes);
     read(d, m_NumClasses);
-    read(d, m_GridSize);
+    read(d, m_GridW);
     read(d, m_OutputSize);
-    assert(d = a + length);
+    // Engines serialized before the raw output mode existed end here
+    m_RawOutput = false;
+    if (d < a + length) read(d, m_RawOutput);
+    // and engines serialized before rectangular grids existed here
+    m_GridH = m_GridW;
+    if (d < a + length) read(d, m_GridH);
+    assert(d == a + length);
 };
 
-YoloLayerV3::YoloLayerV3(const uint& numBoxes, const uint& numClasses, const uint& gridSize) :
+YoloLayerV3::YoloLayerV3(const uint& numBoxes, const uint& numClasses, const uint& gridW,
+                         const uint& gridH, const bool rawOutput) :
     m_NumBoxes(numBoxes),
     m_NumClasses(numClasses),
-    m_GridSize(gridSize)
+    m_GridW(gridW),
+    m_RawOutput(rawOutput),
+    m_GridH(gridH)
 {
     assert(m_NumBoxes > 0);
     assert(m_NumClasses > 0);
-    assert(m_GridSize > 0);
-    m_OutputSize = m_GridSize * m_GridSize * (m_NumBoxes * (4 + 1 + m_NumClasses));
+    assert(m_GridW > 0);
+    assert(m_GridH > 0);
+    m_OutputSize = m_GridW * m_GridH * (m_NumBoxes * (4 + 1 + m_NumClasses));
 };
 
 int YoloLayerV3::getNbOutputs() const { return 1; }
@@ -151,14 +161,22 @@ size_t YoloLayerV3::getWorkspaceSize(int maxBatchSize) const { return 0; }
 int YoloLayerV3::enqueue(int batchSize, const void* const* inputs, void** outputs, void* workspace,
                          cudaStream_t stream)
 {
-    NV_CUDA_CHECK(cudaYoloLayerV3(inputs[0], outputs[0], batchSize, m_GridSize, m_NumClasses,
-                                  m_NumBoxes, m_OutputSize, stream));
+    if (m_RawOutput)
+    {
+        NV_CUDA_CHECK(cudaMemcpyAsync(outputs[0], inputs[0],
+                                      batchSize * m_OutputSize * sizeof(float),
+                                      cudaMemcpyDeviceToDevice, stream));
+        return 0;
+    }
+    NV_CUDA_CHECK(cudaYoloLayerV3(inputs[0], outputs[0], batchSize, m_GridW, m_GridH,
+                                  m_NumClasses, m_NumBoxes, m_OutputSize, stream));
     return 0;
 }
 
 size_t YoloLayerV3::getSerializationSize()
 {
-    return sizeof(m_NumBoxes) + sizeof(m_NumClasses) + sizeof(m_GridSize) + sizeof(m_OutputSize);
+    return sizeof(m_NumBoxes) + sizeof(m_NumClasses) + sizeof(m_GridW) + sizeof(m_OutputSize)
+        + sizeof(m_RawOutput) + sizeof(m_GridH);
 }
 
 void YoloLayerV3::serialize(void* buffer)
@@ -166,7 +184,9 @@ void YoloLayerV3::serialize(void* buffer)
     char *d = static_cast<char*>(buffer), *a = d;
     write(d, m_NumBoxes);
     write(d, m_NumClasses);
-    write(d, m_GridSize);
+    write(d, m_GridW);
     write(d, m_OutputSize);
+    write(d, m_RawOutput);
+    write(d, m_GridH);
     assert(d == a + getSerializationSize());
 }
\ No newline at end of file
@@ -46,7 +46,7 @@ SOFTWARE.
 
 // Forward declaration of cuda kernels
 cudaError_t cudaYoloLayerV3(const void* input, void* output, const uint& batchSize,
-                            const uint& gridSize, const uint& numOutputClasses,
+                            const uint& gridW, const uint& gridH, const uint& numOutputClasses,
                             const uint& numBBoxes, uint64_t outputSize, cudaStream_t stream);
 
 class PluginFactory : public nvinfer1::IPluginFactory
@@ -105,7 +105,10 @@ class YoloLayerV3 : public nvinfer1::IPlugin
 {
 public:
     YoloLayerV3(const void* data, size_t length);
-    YoloLayerV3(const uint& numBoxes, const uint& numClasses, const uint& gridSize);
+    // With rawOutput set the layer passes the conv outputs through untouched and the host applies
+    // the activations to the cells it decodes
+    YoloLayerV3(const uint& numBoxes, const uint& numClasses, const uint& gridW,
+                const uint& gridH, const bool rawOutput = false);
     int getNbOutputs() const override;
     nvinfer1::Dims getOutputDimensions(int index, const nvinfer1::Dims* inputs,
                                        int nbInputDims) override;
@@ -135,8 +138,10 @@ private:
     }
     uint m_NumBoxes;
     uint m_NumClasses;
-    uint m_GridSize;
+    uint m_GridW;
     uint64_t m_OutputSize;
+    bool m_RawOutput;
+    uint m_GridH;
 };
 
 #endif // __PLUGIN_LAYER_H__
\ No newline at end of file
@@ -0,0 +1,93 @@
+/**
+MIT License
+
+Copyright (c) 2018 NVIDIA CORPORATION. All rights reserved.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*
+*/
+
+#include "resolution_controller.h"
+
+#include <cassert>
+
+ResolutionController::ResolutionController(const std::vector<double>& levelCosts,
+                                           const ResolutionControllerParams& params) :
+    m_LevelCosts(levelCosts),
+    m_Params(params),
+    m_Level(0),
+    m_Window(params.windowSize, 0.0f),
+    m_WindowFill(0),
+    m_WindowNext(0),
+    m_WindowSum(0.0),
+    m_NumSwitches(0)
+{
+    assert(!m_LevelCosts.empty() && "Resolution controller needs at least one level");
+    assert(m_LevelCosts.front() > 0.0 && "Level costs have to be positive");
+    for (uint l = 1; l < m_LevelCosts.size(); ++l)
+        assert(m_LevelCosts.at(l) > m_LevelCosts.at(l - 1)
+               && "Levels have to be ordered from the cheapest to the most expensive");
+    assert(m_Params.latencySLOMs > 0.0f && "Latency SLO has to be positive");
+    assert(m_Params.headroom > 0.0f && m_Params.headroom <= 1.0f
+           && "Headroom has to be in (0, 1]");
+    assert(m_Params.windowSize > 0 && "Window size has to be positive");
+    m_Level = m_LevelCosts.size() - 1;
+}
+
+uint ResolutionController::update(const float latencyMs)
+{
+    if (m_WindowFill == m_Params.windowSize)
+        m_WindowSum -= m_Window.at(m_WindowNext);
+    else
+        ++m_WindowFill;
+    m_Window.at(m_WindowNext) = latencyMs;
+    m_WindowSum += latencyMs;
+    m_WindowNext = (m_WindowNext + 1) % m_Params.windowSize;
+
+    if (m_WindowFill < m_Params.windowSize) return m_Level;
+
+    // latency is assumed to scale with the cost of the level, fixed per batch overheads make
+    // the prediction pessimistic for cheaper levels and optimistic for more expensive ones
+    const double meanMs = m_WindowSum / m_WindowFill;
+    const double msPerCost = meanMs / m_LevelCosts.at(m_Level);
+    if (meanMs > m_Params.latencySLOMs)
+    {
+        uint level = m_Level;
+        while ((level > 0) && (msPerCost * m_LevelCosts.at(level) > m_Params.latencySLOMs))
+            --level;
+        if (level != m_Level) switchTo(level);
+    }
+    else if ((m_Level + 1 < m_LevelCosts.size())
+             && (msPerCost * m_LevelCosts.at(m_Level + 1)
+                 <= m_Params.headroom * m_Params.latencySLOMs))
+    {
+        switchTo(m_Level + 1);
+    }
+    return m_Level;
+}
+
+void ResolutionController::switchTo(const uint level)
+{
+    // measurements of the previous level say nothing about the new one
+    m_Level = level;
+    m_WindowFill = 0;
+    m_WindowNext = 0;
+    m_WindowSum = 0.0;
+    ++m_NumSwitches;
+}
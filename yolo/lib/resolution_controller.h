@@ -0,0 +1,83 @@
+/**
+MIT License
+
+Copyright (c) 2018 NVIDIA CORPORATION. All rights reserved.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*
+*/
+
+#ifndef _RESOLUTION_CONTROLLER_H_
+#define _RESOLUTION_CONTROLLER_H_
+
+#include <stdint.h>
+#include <sys/types.h>
+#include <vector>
+
+struct ResolutionControllerParams
+{
+    // per batch latency target in ms
+    float latencySLOMs;
+    // the resolution is only raised when the next engine is predicted to run under
+    // headroom * latencySLOMs. The gap to the SLO keeps the controller from oscillating between
+    // two engines that both sit close to it
+    float headroom;
+    // number of batches averaged before each decision, which is also the minimum number of
+    // batches run at a level after switching to it
+    uint windowSize;
+};
+
+/**
+ * Picks which of several engines of the same network, ordered from the cheapest input size to
+ * the most expensive, the next batch runs on. The caller reports the measured latency of every
+ * batch. Once a full window has been measured at the current level, the controller predicts
+ * the latency of the other levels by scaling the window mean with their relative cost. It
+ * drops to the largest level predicted to meet the SLO when the mean exceeds it, and raises the
+ * resolution one level at a time when the next one is predicted to stay under the headroom.
+ * Holds no GPU state, so it can be driven by a simulated latency source.
+ */
+class ResolutionController
+{
+public:
+    // levelCosts holds the relative cost of every level, strictly increasing, e.g. their MACs.
+    // The controller starts at the most expensive level
+    ResolutionController(const std::vector<double>& levelCosts,
+                         const ResolutionControllerParams& params);
+
+    uint getLevel() const { return m_Level; }
+    uint getNumLevels() const { return m_LevelCosts.size(); }
+    uint64_t getNumSwitches() const { return m_NumSwitches; }
+    // Records the latency of a batch that ran at getLevel() and returns the level for the next
+    uint update(const float latencyMs);
+
+private:
+    void switchTo(const uint level);
+
+    const std::vector<double> m_LevelCosts;
+    const ResolutionControllerParams m_Params;
+    uint m_Level;
+    // ring buffer of the latencies measured at the current level
+    std::vector<float> m_Window;
+    uint m_WindowFill;
+    uint m_WindowNext;
+    double m_WindowSum;
+    uint64_t m_NumSwitches;
+};
+
+#endif // _RESOLUTION_CONTROLLER_H_
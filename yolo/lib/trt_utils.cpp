@@ -25,20 +25,28 @@ SOFTWARE.
 
 #include "trt_utils.h"
 
+#include <chrono>
 #include <experimental/filesystem>
 #include <fstream>
 #include <iomanip>
 
 cv::Mat blobFromDsImages(const std::vector<DsImage>& inputImages, const int& inputH,
-                         const int& inputW)
+                         const int& inputW, WorkerPool* pool)
 {
-    std::vector<cv::Mat> letterboxStack(inputImages.size());
-    for (uint i = 0; i < inputImages.size(); ++i)
-    {
-        inputImages.at(i).getLetterBoxedImage().copyTo(letterboxStack.at(i));
-    }
-    return cv::dnn::blobFromImages(letterboxStack, 1.0, cv::Size(inputW, inputH),
-                                   cv::Scalar(0.0, 0.0, 0.0), false, false);
+    const int dims[] = {static_cast<int>(inputImages.size()), 3, inputH, inputW};
+    cv::Mat blob(4, dims, CV_32F);
+    // every image is written to its own slice of the blob
+    const std::function<void(const uint)> letterboxImage = [&](const uint i) {
+        const cv::Mat image = inputImages.at(i).getOriginalImage();
+        // images are read as BGR, the network expects RGB
+        letterboxToCHW(inputImages.at(i).getLetterboxPlan(), image.data, image.step[0], true,
+                       blob.ptr<float>(i));
+    };
+    if (pool)
+        pool->parallelFor(inputImages.size(), letterboxImage);
+    else
+        for (uint i = 0; i < inputImages.size(); ++i) letterboxImage(i);
+    return blob;
 }
 
 static void leftTrim(std::string& s)
@@ -74,44 +82,6 @@ bool fileExists(const std::string fileName, bool verbose)
     return true;
 }
 
-BBox convertBBoxNetRes(const float& bx, const float& by, const float& bw, const float& bh,
-                       const uint& stride, const uint& netW, const uint& netH)
-{
-    BBox b;
-    // Restore coordinates to network input resolution
-    float x = bx * stride;
-    float y = by * stride;
-
-    b.x1 = x - bw / 2;
-    b.x2 = x + bw / 2;
-
-    b.y1 = y - bh / 2;
-    b.y2 = y + bh / 2;
-
-    b.x1 = clamp(b.x1, 0, netW);
-    b.x2 = clamp(b.x2, 0, netW);
-    b.y1 = clamp(b.y1, 0, netH);
-    b.y2 = clamp(b.y2, 0, netH);
-
-    return b;
-}
-
-void convertBBoxImgRes(const float scalingFactor, const float& xOffset, const float& yOffset,
-                       BBox& bbox)
-{
-    // Undo Letterbox
-    bbox.x1 -= xOffset;
-    bbox.x2 -= xOffset;
-    bbox.y1 -= yOffset;
-    bbox.y2 -= yOffset;
-
-    // Restore to input resolution
-    bbox.x1 /= scalingFactor;
-    bbox.x2 /= scalingFactor;
-    bbox.y1 /= scalingFactor;
-    bbox.y2 /= scalingFactor;
-}
-
 void printPredictions(const BBoxInfo& b, const std::string& className)
 {
     std::cout << " label:" << b.label << "(" << className << ")"
@@ -164,134 +134,50 @@ std::vector<std::string> loadImageList(const std::string filename, const std::st
     return fileList;
 }
 
-std::vector<BBoxInfo> nmsAllClasses(const float nmsThresh, std::vector<BBoxInfo>& binfo,
-                                    const uint numClasses)
-{
-    std::vector<BBoxInfo> result;
-    std::vector<std::vector<BBoxInfo>> splitBoxes(numClasses);
-    for (auto& box : binfo)
-    {
-        splitBoxes.at(box.label).push_back(box);
-    }
-
-    for (auto& boxes : splitBoxes)
-    {
-        boxes = nonMaximumSuppression(nmsThresh, boxes);
-        result.insert(result.end(), boxes.begin(), boxes.end());
-    }
-
-    return result;
-}
-
-std::vector<BBoxInfo> nonMaximumSuppression(const float nmsThresh, std::vector<BBoxInfo> binfo)
-{
-    auto overlap1D = [](float x1min, float x1max, float x2min, float x2max) -> float {
-        if (x1min > x2min)
-        {
-            std::swap(x1min, x2min);
-            std::swap(x1max, x2max);
-        }
-        return x1max < x2min ? 0 : std::min(x1max, x2max) - x2min;
-    };
-    auto computeIoU = [&overlap1D](BBox& bbox1, BBox& bbox2) -> float {
-        float overlapX = overlap1D(bbox1.x1, bbox1.x2, bbox2.x1, bbox2.x2);
-        float overlapY = overlap1D(bbox1.y1, bbox1.y2, bbox2.y1, bbox2.y2);
-        float area1 = (bbox1.x2 - bbox1.x1) * (bbox1.y2 - bbox1.y1);
-        float area2 = (bbox2.x2 - bbox2.x1) * (bbox2.y2 - bbox2.y1);
-        float overlap2D = overlapX * overlapY;
-        float u = area1 + area2 - overlap2D;
-        return u == 0 ? 0 : overlap2D / u;
-    };
-
-    std::stable_sort(binfo.begin(), binfo.end(),
-                     [](const BBoxInfo& b1, const BBoxInfo& b2) { return b1.prob > b2.prob; });
-    std::vector<BBoxInfo> out;
-    for (auto& i : binfo)
-    {
-        bool keep = true;
-        for (auto& j : out)
-        {
-            if (keep)
-            {
-                float overlap = computeIoU(i.box, j.box);
-                keep = overlap <= nmsThresh;
-            }
-            else
-                break;
-        }
-        if (keep) out.push_back(i);
-    }
-    return out;
-}
-
 nvinfer1::ICudaEngine* loadTRTEngine(const std::string planFilePath, PluginFactory* pluginFactory,
                                      Logger& logger)
 {
-    // reading the model in memory
+    // the plan is deserialized straight out of a read-only mapping of the file
     std::cout << "Loading TRT Engine..." << std::endl;
     assert(fileExists(planFilePath));
-    std::stringstream trtModelStream;
-    trtModelStream.seekg(0, trtModelStream.beg);
-    std::ifstream cache(planFilePath);
-    assert(cache.good());
-    trtModelStream << cache.rdbuf();
-    cache.close();
-
-    // calculating model size
-    trtModelStream.seekg(0, std::ios::end);
-    const int modelSize = trtModelStream.tellg();
-    trtModelStream.seekg(0, std::ios::beg);
-    void* modelMem = malloc(modelSize);
-    trtModelStream.read((char*) modelMem, modelSize);
+    auto start = std::chrono::steady_clock::now();
+    MappedFile plan(planFilePath);
 
     nvinfer1::IRuntime* runtime = nvinfer1::createInferRuntime(logger);
     nvinfer1::ICudaEngine* engine
-        = runtime->deserializeCudaEngine(modelMem, modelSize, pluginFactory);
-    free(modelMem);
+        = runtime->deserializeCudaEngine(plan.data(), plan.size(), pluginFactory);
     runtime->destroy();
-    std::cout << "Loading Complete!" << std::endl;
+    auto end = std::chrono::steady_clock::now();
+    std::cout << "Loading Complete! Read " << plan.size() << " bytes from " << planFilePath
+              << " in " << std::chrono::duration<double, std::milli>(end - start).count()
+              << " ms" << std::endl;
 
     return engine;
 }
 
-std::vector<float> loadWeights(const std::string weightsFilePath, const std::string& networkType)
+void writePlanFile(const std::string planFilePath, const nvinfer1::IHostMemory* plan)
 {
-    assert(fileExists(weightsFilePath));
-    std::cout << "Loading pre-trained weights..." << std::endl;
-    std::ifstream file(weightsFilePath, std::ios_base::binary);
-    assert(file.good());
-    std::string line;
-
-    if (networkType == "yolov2")
-    {
-        // Remove 4 int32 bytes of data from the stream belonging to the header
-        file.ignore(4 * 4);
-    }
-    else if ((networkType == "yolov3") || (networkType == "yolov3-tiny")
-             || (networkType == "yolov2-tiny"))
-    {
-        // Remove 5 int32 bytes of data from the stream belonging to the header
-        file.ignore(4 * 5);
-    }
-    else
+    std::ofstream outFile(planFilePath, std::ios_base::binary | std::ios_base::trunc);
+    outFile.write(static_cast<const char*>(plan->data()), plan->size());
+    outFile.close();
+    if (!outFile.good())
     {
-        std::cout << "Invalid network type" << std::endl;
+        std::cout << "Unable to write plan file : " << planFilePath << std::endl;
         assert(0);
     }
+}
 
-    std::vector<float> weights;
-    char* floatWeight = new char[4];
-    while (!file.eof())
-    {
-        file.read(floatWeight, 4);
-        assert(file.gcount() == 4);
-        weights.push_back(*reinterpret_cast<float*>(floatWeight));
-        if (file.peek() == std::istream::traits_type::eof()) break;
-    }
+std::unique_ptr<DarknetWeights> loadWeights(const std::string weightsFilePath)
+{
+    assert(fileExists(weightsFilePath));
+    std::cout << "Loading pre-trained weights..." << std::endl;
+    std::unique_ptr<DarknetWeights> weights(new DarknetWeights(weightsFilePath));
     std::cout << "Loading complete!" << std::endl;
-    delete[] floatWeight;
 
-    std::cout << "Total Number of weights read : " << weights.size() << std::endl;
+    std::cout << "Darknet weights version : " << weights->getMajor() << "."
+              << weights->getMinor() << "." << weights->getRevision()
+              << ", images seen : " << weights->getSeen() << std::endl;
+    std::cout << "Total Number of weights read : " << weights->size() << std::endl;
     return weights;
 }
 
@@ -338,15 +224,11 @@ uint64_t get3DTensorVolume(nvinfer1::Dims inputDims)
     return inputDims.d[0] * inputDims.d[1] * inputDims.d[2];
 }
 
-nvinfer1::ILayer* netAddMaxpool(int layerIdx, std::map<std::string, std::string>& block,
+nvinfer1::ILayer* netAddMaxpool(int layerIdx, const MaxpoolParams& params,
                                 nvinfer1::ITensor* input, nvinfer1::INetworkDefinition* network)
 {
-    assert(block.at("type") == "maxpool");
-    assert(block.find("size") != block.end());
-    assert(block.find("stride") != block.end());
-
-    int size = std::stoi(block.at("size"));
-    int stride = std::stoi(block.at("stride"));
+    int size = params.size;
+    int stride = params.stride;
 
     nvinfer1::IPoolingLayer* pool
         = network->addPooling(*input, nvinfer1::PoolingType::kMAX, nvinfer1::DimsHW{size, size});
@@ -358,50 +240,44 @@ nvinfer1::ILayer* netAddMaxpool(int layerIdx, std::map<std::string, std::string>
     return pool;
 }
 
-nvinfer1::ILayer* netAddConvLinear(int layerIdx, std::map<std::string, std::string>& block,
-                                   std::vector<float>& weights,
+nvinfer1::ILayer* netAddConvLinear(int layerIdx, const ConvParams& params,
+                                   const DarknetWeights& weights,
                                    std::vector<nvinfer1::Weights>& trtWeights, int& weightPtr,
                                    int& inputChannels, nvinfer1::ITensor* input,
                                    nvinfer1::INetworkDefinition* network)
 {
-    assert(block.at("type") == "convolutional");
-    assert(block.find("batch_normalize") == block.end());
-    assert(block.at("activation") == "linear");
-    assert(block.find("filters") != block.end());
-    assert(block.find("pad") != block.end());
-    assert(block.find("size") != block.end());
-    assert(block.find("stride") != block.end());
-
-    int filters = std::stoi(block.at("filters"));
-    int padding = std::stoi(block.at("pad"));
-    int kernelSize = std::stoi(block.at("size"));
-    int stride = std::stoi(block.at("stride"));
-    int pad;
-    if (padding)
-        pad = (kernelSize - 1) / 2;
-    else
-        pad = 0;
-    // load the convolution layer bias
-    nvinfer1::Weights convBias{nvinfer1::DataType::kFLOAT, nullptr, filters};
-    float* val = new float[filters];
-    for (int i = 0; i < filters; ++i)
-    {
-        val[i] = weights[weightPtr];
-        weightPtr++;
-    }
-    convBias.values = val;
-    trtWeights.push_back(convBias);
-    // load the convolutional layer weights
+    int filters = params.filters;
+    int kernelSize = params.kernelSize;
+
+    // the conv bias and weights (GKCRS) are used as stored, so both point into the mapped file
+    // and are not added to trtWeights, which only tracks buffers owned by the network
+    CachedConvWeights conv;
+    conv.layerIdx = layerIdx;
+    conv.filters = filters;
+    conv.kernelVolume = inputChannels * kernelSize * kernelSize;
+    conv.batchNormalize = false;
+    conv.bias = weights.span(weightPtr, filters);
+    conv.kernel = weights.span(weightPtr, filters * conv.kernelVolume);
+    conv.scale = nullptr;
+    conv.power = nullptr;
+    return netAddConvLinear(layerIdx, params, conv, inputChannels, input, network);
+}
+
+nvinfer1::ILayer* netAddConvLinear(int layerIdx, const ConvParams& params,
+                                   const CachedConvWeights& weights, int& inputChannels,
+                                   nvinfer1::ITensor* input, nvinfer1::INetworkDefinition* network)
+{
+    assert(!params.batchNormalize && params.activation == Activation::kLinear);
+    int filters = params.filters;
+    int kernelSize = params.kernelSize;
+    int stride = params.stride;
+    int pad = params.pad;
+    assert(!weights.batchNormalize && weights.filters == static_cast<uint>(filters));
+    assert(weights.kernelVolume == static_cast<uint>(inputChannels * kernelSize * kernelSize));
+
+    nvinfer1::Weights convBias{nvinfer1::DataType::kFLOAT, weights.bias, filters};
     int size = filters * inputChannels * kernelSize * kernelSize;
-    nvinfer1::Weights convWt{nvinfer1::DataType::kFLOAT, nullptr, size};
-    val = new float[size];
-    for (int i = 0; i < size; ++i)
-    {
-        val[i] = weights[weightPtr];
-        weightPtr++;
-    }
-    convWt.values = val;
-    trtWeights.push_back(convWt);
+    nvinfer1::Weights convWt{nvinfer1::DataType::kFLOAT, weights.kernel, size};
     nvinfer1::IConvolutionLayer* conv = network->addConvolution(
         *input, filters, nvinfer1::DimsHW{kernelSize, kernelSize}, convWt, convBias);
     assert(conv != nullptr);
@@ -413,90 +289,63 @@ nvinfer1::ILayer* netAddConvLinear(int layerIdx, std::map<std::string, std::stri
     return conv;
 }
 
-nvinfer1::ILayer* netAddConvBNLeaky(int layerIdx, std::map<std::string, std::string>& block,
-                                    std::vector<float>& weights,
+nvinfer1::ILayer* netAddConvBNLeaky(int layerIdx, const ConvParams& params,
+                                    const DarknetWeights& weights,
                                     std::vector<nvinfer1::Weights>& trtWeights, int& weightPtr,
                                     int& inputChannels, nvinfer1::ITensor* input,
                                     nvinfer1::INetworkDefinition* network)
 {
-    assert(block.at("type") == "convolutional");
-    assert(block.find("batch_normalize") != block.end());
-    assert(block.at("batch_normalize") == "1");
-    assert(block.at("activation") == "leaky");
-    assert(block.find("filters") != block.end());
-    assert(block.find("pad") != block.end());
-    assert(block.find("size") != block.end());
-    assert(block.find("stride") != block.end());
-
-    bool batchNormalize, bias;
-    if (block.find("batch_normalize") != block.end())
-    {
-        batchNormalize = (block.at("batch_normalize") == "1");
-        bias = false;
-    }
-    else
-    {
-        batchNormalize = false;
-        bias = true;
-    }
+    int filters = params.filters;
+    int kernelSize = params.kernelSize;
+
+    // batch norm weights are before the conv layer
+    // load BN biases (bn_biases), BN weights, BN running_mean and BN running_var
+    const float* bnBiases = weights.span(weightPtr, filters);
+    const float* bnWeights = weights.span(weightPtr, filters);
+    const float* bnRunningMean = weights.span(weightPtr, filters);
+    const float* bnRunningVar = weights.span(weightPtr, filters);
+    // fold them into the shift, scale and power of the batch norm scale layer
+    float* shiftWt = new float[filters];
+    float* scaleWt = new float[filters];
+    float* powerWt = new float[filters];
+    foldBatchNorm(filters, bnBiases, bnWeights, bnRunningMean, bnRunningVar, shiftWt, scaleWt,
+                  powerWt);
+    trtWeights.push_back(nvinfer1::Weights{nvinfer1::DataType::kFLOAT, shiftWt, filters});
+    trtWeights.push_back(nvinfer1::Weights{nvinfer1::DataType::kFLOAT, scaleWt, filters});
+    trtWeights.push_back(nvinfer1::Weights{nvinfer1::DataType::kFLOAT, powerWt, filters});
+
+    // load Conv layer weights (GKCRS), used as stored so they point into the mapped file
+    CachedConvWeights conv;
+    conv.layerIdx = layerIdx;
+    conv.filters = filters;
+    conv.kernelVolume = inputChannels * kernelSize * kernelSize;
+    conv.batchNormalize = true;
+    conv.kernel = weights.span(weightPtr, filters * conv.kernelVolume);
+    conv.bias = shiftWt;
+    conv.scale = scaleWt;
+    conv.power = powerWt;
+    return netAddConvBNLeaky(layerIdx, params, conv, inputChannels, input, network);
+}
+
+nvinfer1::ILayer* netAddConvBNLeaky(int layerIdx, const ConvParams& params,
+                                    const CachedConvWeights& weights, int& inputChannels,
+                                    nvinfer1::ITensor* input,
+                                    nvinfer1::INetworkDefinition* network)
+{
+    assert(params.batchNormalize && params.activation == Activation::kLeaky);
+    int filters = params.filters;
+    int kernelSize = params.kernelSize;
+    int stride = params.stride;
+    int pad = params.pad;
     // all conv_bn_leaky layers assume bias is false
-    assert(batchNormalize == true && bias == false);
-
-    int filters = std::stoi(block.at("filters"));
-    int padding = std::stoi(block.at("pad"));
-    int kernelSize = std::stoi(block.at("size"));
-    int stride = std::stoi(block.at("stride"));
-    int pad;
-    if (padding)
-        pad = (kernelSize - 1) / 2;
-    else
-        pad = 0;
+    assert(weights.batchNormalize && weights.filters == static_cast<uint>(filters));
+    assert(weights.kernelVolume == static_cast<uint>(inputChannels * kernelSize * kernelSize));
 
     /***** CONVOLUTION LAYER *****/
     /*****************************/
-    // batch norm weights are before the conv layer
-    // load BN biases (bn_biases)
-    std::vector<float> bnBiases;
-    for (int i = 0; i < filters; ++i)
-    {
-        bnBiases.push_back(weights[weightPtr]);
-        weightPtr++;
-    }
-    // load BN weights
-    std::vector<float> bnWeights;
-    for (int i = 0; i < filters; ++i)
-    {
-        bnWeights.push_back(weights[weightPtr]);
-        weightPtr++;
-    }
-    // load BN running_mean
-    std::vector<float> bnRunningMean;
-    for (int i = 0; i < filters; ++i)
-    {
-        bnRunningMean.push_back(weights[weightPtr]);
-        weightPtr++;
-    }
-    // load BN running_var
-    std::vector<float> bnRunningVar;
-    for (int i = 0; i < filters; ++i)
-    {
-        // 1e-05 for numerical stability
-        bnRunningVar.push_back(sqrt(weights[weightPtr] + 1.0e-5));
-        weightPtr++;
-    }
-    // load Conv layer weights (GKCRS)
     int size = filters * inputChannels * kernelSize * kernelSize;
-    nvinfer1::Weights convWt{nvinfer1::DataType::kFLOAT, nullptr, size};
-    float* val = new float[size];
-    for (int i = 0; i < size; ++i)
-    {
-        val[i] = weights[weightPtr];
-        weightPtr++;
-    }
-    convWt.values = val;
-    trtWeights.push_back(convWt);
+    nvinfer1::Weights convWt{nvinfer1::DataType::kFLOAT, weights.kernel, size};
     nvinfer1::Weights convBias{nvinfer1::DataType::kFLOAT, nullptr, 0};
-    trtWeights.push_back(convBias);
     nvinfer1::IConvolutionLayer* conv = network->addConvolution(
         *input, filters, nvinfer1::DimsHW{kernelSize, kernelSize}, convWt, convBias);
     assert(conv != nullptr);
@@ -507,33 +356,9 @@ nvinfer1::ILayer* netAddConvBNLeaky(int layerIdx, std::map<std::string, std::str
 
     /***** BATCHNORM LAYER *****/
     /***************************/
-    size = filters;
-    // create the weights
-    nvinfer1::Weights shift{nvinfer1::DataType::kFLOAT, nullptr, size};
-    nvinfer1::Weights scale{nvinfer1::DataType::kFLOAT, nullptr, size};
-    nvinfer1::Weights power{nvinfer1::DataType::kFLOAT, nullptr, size};
-    float* shiftWt = new float[size];
-    for (int i = 0; i < size; ++i)
-    {
-        shiftWt[i]
-            = bnBiases.at(i) - ((bnRunningMean.at(i) * bnWeights.at(i)) / bnRunningVar.at(i));
-    }
-    shift.values = shiftWt;
-    float* scaleWt = new float[size];
-    for (int i = 0; i < size; ++i)
-    {
-        scaleWt[i] = bnWeights.at(i) / bnRunningVar[i];
-    }
-    scale.values = scaleWt;
-    float* powerWt = new float[size];
-    for (int i = 0; i < size; ++i)
-    {
-        powerWt[i] = 1.0;
-    }
-    power.values = powerWt;
-    trtWeights.push_back(shift);
-    trtWeights.push_back(scale);
-    trtWeights.push_back(power);
+    nvinfer1::Weights shift{nvinfer1::DataType::kFLOAT, weights.bias, filters};
+    nvinfer1::Weights scale{nvinfer1::DataType::kFLOAT, weights.scale, filters};
+    nvinfer1::Weights power{nvinfer1::DataType::kFLOAT, weights.power, filters};
     // Add the batch norm layers
     nvinfer1::IScaleLayer* bn = network->addScale(
         *conv->getOutput(0), nvinfer1::ScaleMode::kCHANNEL, shift, scale, power);
@@ -553,27 +378,24 @@ nvinfer1::ILayer* netAddConvBNLeaky(int layerIdx, std::map<std::string, std::str
     return leaky;
 }
 
-nvinfer1::ILayer* netAddUpsample(int layerIdx, std::map<std::string, std::string>& block,
-                                 std::vector<float>& weights,
+nvinfer1::ILayer* netAddUpsample(int layerIdx, const UpsampleParams& params,
                                  std::vector<nvinfer1::Weights>& trtWeights, int& inputChannels,
                                  nvinfer1::ITensor* input, nvinfer1::INetworkDefinition* network)
 {
-    assert(block.at("type") == "upsample");
     nvinfer1::Dims inpDims = input->getDimensions();
     assert(inpDims.nbDims == 3);
-    assert(inpDims.d[1] == inpDims.d[2]);
     int h = inpDims.d[1];
     int w = inpDims.d[2];
-    int stride = std::stoi(block.at("stride"));
+    int stride = params.stride;
     // add pre multiply matrix as a constant
     nvinfer1::Dims preDims{3,
-                           {1, stride * h, w},
+                           {1, stride * h, h},
                            {nvinfer1::DimensionType::kCHANNEL, nvinfer1::DimensionType::kSPATIAL,
                             nvinfer1::DimensionType::kSPATIAL}};
-    int size = stride * h * w;
+    int size = stride * h * h;
     nvinfer1::Weights preMul{nvinfer1::DataType::kFLOAT, nullptr, size};
     float* preWt = new float[size];
-    /* (2*h * w)
+    /* (2*h * h)
     [ [1, 0, ..., 0],
       [1, 0, ..., 0],
       [0, 1, ..., 0],
@@ -587,7 +409,7 @@ nvinfer1::ILayer* netAddUpsample(int layerIdx, std::map<std::string, std::string
     {
         for (int s = 0; s < stride; ++s)
         {
-            for (int j = 0; j < w; ++j, ++idx)
+            for (int j = 0; j < h; ++j, ++idx)
             {
                 preWt[idx] = (i == j) ? 1.0 : 0.0;
             }
@@ -601,20 +423,20 @@ nvinfer1::ILayer* netAddUpsample(int layerIdx, std::map<std::string, std::string
     preM->setName(preLayerName.c_str());
     // add post multiply matrix as a constant
     nvinfer1::Dims postDims{3,
-                            {1, h, stride * w},
+                            {1, w, stride * w},
                             {nvinfer1::DimensionType::kCHANNEL, nvinfer1::DimensionType::kSPATIAL,
                              nvinfer1::DimensionType::kSPATIAL}};
-    size = stride * h * w;
+    size = stride * w * w;
     nvinfer1::Weights postMul{nvinfer1::DataType::kFLOAT, nullptr, size};
     float* postWt = new float[size];
-    /* (h * 2*w)
+    /* (w * 2*w)
     [ [1, 1, 0, 0, ..., 0, 0],
       [0, 0, 1, 1, ..., 0, 0],
       ...,
       ...,
       [0, 0, 0, 0, ..., 1, 1] ]
     */
-    for (int i = 0, idx = 0; i < h; ++i)
+    for (int i = 0, idx = 0; i < w; ++i)
     {
         for (int j = 0; j < stride * w; ++j, ++idx)
         {
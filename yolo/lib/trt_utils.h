@@ -34,26 +34,20 @@ SOFTWARE.
 #include <opencv2/highgui/highgui.hpp>
 #include <opencv2/imgproc/imgproc.hpp>
 
+#include <memory>
 #include <set>
 
 #include "NvInfer.h"
 
 #include "ds_image.h"
+#include "mapped_file.h"
+#include "nms.h"
 #include "plugin_factory.h"
+#include "weights_cache.h"
+#include "worker_pool.h"
+#include "yolo_cfg.h"
 
 class DsImage;
-struct BBox
-{
-    float x1, y1, x2, y2;
-};
-
-struct BBoxInfo
-{
-    BBox box;
-    int label;
-    int classId; // For coco benchmarking
-    float prob;
-};
 
 class Logger : public nvinfer1::ILogger
 {
@@ -85,23 +79,21 @@ private:
                              nvinfer1::DimsHW stride, nvinfer1::DimsHW padding,
                              nvinfer1::DimsHW dilation, const char* layerName) const override
     {
-        assert(inputDims.d[0] == inputDims.d[1]);
-        assert(kernelSize.d[0] == kernelSize.d[1]);
-        assert(stride.d[0] == stride.d[1]);
-        assert(padding.d[0] == padding.d[1]);
-
-        int outputDim;
-        // Only layer maxpool_12 makes use of same padding
-        if (m_SamePaddingLayers.find(layerName) != m_SamePaddingLayers.end())
-        {
-            outputDim = (inputDims.d[0] + 2 * padding.d[0]) / stride.d[0];
-        }
-        // Valid Padding
-        else
+        nvinfer1::DimsHW outputDims;
+        for (int i = 0; i < 2; ++i)
         {
-            outputDim = (inputDims.d[0] - kernelSize.d[0]) / stride.d[0] + 1;
+            // Only layer maxpool_12 makes use of same padding
+            if (m_SamePaddingLayers.find(layerName) != m_SamePaddingLayers.end())
+            {
+                outputDims.d[i] = (inputDims.d[i] + 2 * padding.d[i]) / stride.d[i];
+            }
+            // Valid Padding
+            else
+            {
+                outputDims.d[i] = (inputDims.d[i] - kernelSize.d[i]) / stride.d[i] + 1;
+            }
         }
-        return nvinfer1::DimsHW{outputDim, outputDim};
+        return outputDims;
     }
 
 public:
@@ -109,44 +101,46 @@ public:
 };
 
 // Common helper functions
+// Letterboxes the images into a new NCHW blob, in parallel over pool when given
 cv::Mat blobFromDsImages(const std::vector<DsImage>& inputImages, const int& inputH,
-                         const int& inputW);
+                         const int& inputW, WorkerPool* pool = nullptr);
 std::string trim(std::string s);
 float clamp(const float val, const float minVal, const float maxVal);
 bool fileExists(const std::string fileName, bool verbose = true);
-BBox convertBBoxNetRes(const float& bx, const float& by, const float& bw, const float& bh,
-                       const uint& stride, const uint& netW, const uint& netH);
-void convertBBoxImgRes(const float scalingFactor, const float& xOffset, const float& yOffset,
-                       BBox& bbox);
 void printPredictions(const BBoxInfo& info, const std::string& className);
 std::vector<std::string> loadListFromTextFile(const std::string filename);
 std::vector<std::string> loadImageList(const std::string filename, const std::string prefix);
-std::vector<BBoxInfo> nmsAllClasses(const float nmsThresh, std::vector<BBoxInfo>& binfo,
-                                    const uint numClasses);
-std::vector<BBoxInfo> nonMaximumSuppression(const float nmsThresh, std::vector<BBoxInfo> binfo);
 nvinfer1::ICudaEngine* loadTRTEngine(const std::string planFilePath, PluginFactory* pluginFactory,
                                      Logger& logger);
-std::vector<float> loadWeights(const std::string weightsFilePath, const std::string& networkType);
+void writePlanFile(const std::string planFilePath, const nvinfer1::IHostMemory* plan);
+std::unique_ptr<DarknetWeights> loadWeights(const std::string weightsFilePath);
 std::string dimsToString(const nvinfer1::Dims d);
 void displayDimType(const nvinfer1::Dims d);
 int getNumChannels(nvinfer1::ITensor* t);
 uint64_t get3DTensorVolume(nvinfer1::Dims inputDims);
 
 // Helper functions to create yolo engine
-nvinfer1::ILayer* netAddMaxpool(int layerIdx, std::map<std::string, std::string>& block,
+nvinfer1::ILayer* netAddMaxpool(int layerIdx, const MaxpoolParams& params,
                                 nvinfer1::ITensor* input, nvinfer1::INetworkDefinition* network);
-nvinfer1::ILayer* netAddConvLinear(int layerIdx, std::map<std::string, std::string>& block,
-                                   std::vector<float>& weights,
+nvinfer1::ILayer* netAddConvLinear(int layerIdx, const ConvParams& params,
+                                   const DarknetWeights& weights,
                                    std::vector<nvinfer1::Weights>& trtWeights, int& weightPtr,
                                    int& inputChannels, nvinfer1::ITensor* input,
                                    nvinfer1::INetworkDefinition* network);
-nvinfer1::ILayer* netAddConvBNLeaky(int layerIdx, std::map<std::string, std::string>& block,
-                                    std::vector<float>& weights,
+nvinfer1::ILayer* netAddConvBNLeaky(int layerIdx, const ConvParams& params,
+                                    const DarknetWeights& weights,
                                     std::vector<nvinfer1::Weights>& trtWeights, int& weightPtr,
                                     int& inputChannels, nvinfer1::ITensor* input,
                                     nvinfer1::INetworkDefinition* network);
-nvinfer1::ILayer* netAddUpsample(int layerIdx, std::map<std::string, std::string>& block,
-                                 std::vector<float>& weights,
+// Overloads building the conv layers from a weights cache entry, see weights_cache.h
+nvinfer1::ILayer* netAddConvLinear(int layerIdx, const ConvParams& params,
+                                   const CachedConvWeights& weights, int& inputChannels,
+                                   nvinfer1::ITensor* input, nvinfer1::INetworkDefinition* network);
+nvinfer1::ILayer* netAddConvBNLeaky(int layerIdx, const ConvParams& params,
+                                    const CachedConvWeights& weights, int& inputChannels,
+                                    nvinfer1::ITensor* input,
+                                    nvinfer1::INetworkDefinition* network);
+nvinfer1::ILayer* netAddUpsample(int layerIdx, const UpsampleParams& params,
                                  std::vector<nvinfer1::Weights>& trtWeights, int& inputChannels,
                                  nvinfer1::ITensor* input, nvinfer1::INetworkDefinition* network);
 void printLayerInfo(std::string layerIndex, std::string layerName, std::string layerInput,
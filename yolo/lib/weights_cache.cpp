@@ -0,0 +1,232 @@
+/**
+MIT License
+
+Copyright (c) 2018 NVIDIA CORPORATION. All rights reserved.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*
+*/
+
+#include "weights_cache.h"
+#include "yolo_cfg.h"
+
+#include <cassert>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sys/stat.h>
+
+static const char kWeightsCacheMagic[8] = {'Y', 'O', 'L', 'O', 'W', 'T', 'C', '\0'};
+
+WeightsCache::WeightsCache(const std::string& cachePath) : m_File(cachePath), m_Valid(false)
+{
+    const uint8_t* bytes = m_File.data();
+    const size_t numBytes = m_File.size();
+    if (numBytes < sizeof(WeightsCacheHeader)) return;
+    memcpy(&m_Header, bytes, sizeof(WeightsCacheHeader));
+    if (memcmp(m_Header.magic, kWeightsCacheMagic, sizeof(kWeightsCacheMagic)) != 0
+        || m_Header.version != kVersion)
+        return;
+
+    size_t offset = sizeof(WeightsCacheHeader);
+    for (uint i = 0; i < m_Header.numLayers; ++i)
+    {
+        WeightsCacheLayer layer;
+        if (offset + sizeof(WeightsCacheLayer) > numBytes)
+        {
+            std::cout << "Truncated layer header in weights cache : " << cachePath << std::endl;
+            assert(0);
+        }
+        memcpy(&layer, bytes + offset, sizeof(WeightsCacheLayer));
+        offset += sizeof(WeightsCacheLayer);
+
+        const uint64_t kernelSize = static_cast<uint64_t>(layer.filters) * layer.kernelVolume;
+        const uint64_t numFloats
+            = kernelSize + (layer.batchNormalize ? 3 * layer.filters : layer.filters);
+        if (offset + numFloats * sizeof(float) > numBytes)
+        {
+            std::cout << "Truncated weights for layer " << layer.layerIdx
+                      << " in weights cache : " << cachePath << std::endl;
+            assert(0);
+        }
+        // records are a multiple of 4 bytes long and the mapping is page aligned
+        const float* values = reinterpret_cast<const float*>(bytes + offset);
+        CachedConvWeights conv;
+        conv.layerIdx = layer.layerIdx;
+        conv.filters = layer.filters;
+        conv.kernelVolume = layer.kernelVolume;
+        conv.batchNormalize = layer.batchNormalize != 0;
+        conv.kernel = values;
+        conv.bias = values + kernelSize;
+        conv.scale = conv.batchNormalize ? conv.bias + layer.filters : nullptr;
+        conv.power = conv.batchNormalize ? conv.scale + layer.filters : nullptr;
+        m_Layers.push_back(conv);
+        offset += numFloats * sizeof(float);
+    }
+    m_Valid = true;
+}
+
+// Size and modification time, in nanoseconds since epoch, of the file at filePath
+static bool getFileStamp(const std::string& filePath, uint64_t& size, uint64_t& mtime)
+{
+    struct stat st;
+    if (stat(filePath.c_str(), &st) != 0) return false;
+    size = st.st_size;
+    mtime = static_cast<uint64_t>(st.st_mtim.tv_sec) * 1000000000ull + st.st_mtim.tv_nsec;
+    return true;
+}
+
+const CachedConvWeights* WeightsCache::getLayer(const uint layerIdx) const
+{
+    for (const CachedConvWeights& layer : m_Layers)
+    {
+        if (layer.layerIdx == layerIdx) return &layer;
+    }
+    return nullptr;
+}
+
+void foldBatchNorm(const uint filters, const float* bnBiases, const float* bnWeights,
+                   const float* bnRunningMean, const float* bnRunningVar, float* shift,
+                   float* scale, float* power)
+{
+    for (uint i = 0; i < filters; ++i)
+    {
+        // 1e-05 for numerical stability
+        const float runningVar = sqrt(bnRunningVar[i] + 1.0e-5);
+        shift[i] = bnBiases[i] - ((bnRunningMean[i] * bnWeights[i]) / runningVar);
+        scale[i] = bnWeights[i] / runningVar;
+        power[i] = 1.0;
+    }
+}
+
+void writeWeightsCache(const std::string& cachePath, const std::string& cfgFilePath,
+                       const std::string& wtsFilePath)
+{
+    const std::vector<ConvLayerInfo> convLayers = getConvLayers(parseNetworkCfg(cfgFilePath));
+    DarknetWeights weights(wtsFilePath);
+
+    WeightsCacheHeader header;
+    memcpy(header.magic, kWeightsCacheMagic, sizeof(kWeightsCacheMagic));
+    header.version = WeightsCache::kVersion;
+    header.numLayers = convLayers.size();
+    header.cfgChecksum = fileChecksum(cfgFilePath);
+    header.weightsChecksum = fileChecksum(wtsFilePath);
+    if (!getFileStamp(wtsFilePath, header.weightsSize, header.weightsMtime))
+    {
+        std::cout << "Unable to stat weights file : " << wtsFilePath << std::endl;
+        assert(0);
+    }
+
+    // write next to the destination and rename, so a reader never sees a partial cache
+    const std::string tmpPath = cachePath + ".tmp";
+    std::ofstream out(tmpPath, std::ios_base::binary | std::ios_base::trunc);
+    if (!out.good())
+    {
+        std::cout << "Unable to open " << tmpPath << " for writing" << std::endl;
+        assert(0);
+    }
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+    int weightPtr = 0;
+    std::vector<float> shift, scale, power;
+    for (const ConvLayerInfo& conv : convLayers)
+    {
+        const WeightsCacheLayer layer{conv.layerIdx, conv.filters,
+                                      static_cast<uint32_t>(conv.kernelVolume()),
+                                      conv.batchNormalize ? 1u : 0u};
+        out.write(reinterpret_cast<const char*>(&layer), sizeof(layer));
+        const int kernelSize = static_cast<int>(conv.filters * conv.kernelVolume());
+        if (conv.batchNormalize)
+        {
+            // darknet stores the batch norm parameters before the conv kernel
+            const float* bnBiases = weights.span(weightPtr, conv.filters);
+            const float* bnWeights = weights.span(weightPtr, conv.filters);
+            const float* bnRunningMean = weights.span(weightPtr, conv.filters);
+            const float* bnRunningVar = weights.span(weightPtr, conv.filters);
+            const float* kernel = weights.span(weightPtr, kernelSize);
+            shift.resize(conv.filters);
+            scale.resize(conv.filters);
+            power.resize(conv.filters);
+            foldBatchNorm(conv.filters, bnBiases, bnWeights, bnRunningMean, bnRunningVar,
+                          shift.data(), scale.data(), power.data());
+            out.write(reinterpret_cast<const char*>(kernel), kernelSize * sizeof(float));
+            out.write(reinterpret_cast<const char*>(shift.data()), conv.filters * sizeof(float));
+            out.write(reinterpret_cast<const char*>(scale.data()), conv.filters * sizeof(float));
+            out.write(reinterpret_cast<const char*>(power.data()), conv.filters * sizeof(float));
+        }
+        else
+        {
+            const float* bias = weights.span(weightPtr, conv.filters);
+            const float* kernel = weights.span(weightPtr, kernelSize);
+            out.write(reinterpret_cast<const char*>(kernel), kernelSize * sizeof(float));
+            out.write(reinterpret_cast<const char*>(bias), conv.filters * sizeof(float));
+        }
+    }
+    if (weights.size() != static_cast<size_t>(weightPtr))
+    {
+        std::cout << "Number of unused weights left : " << weights.size() - weightPtr
+                  << std::endl;
+        out.close();
+        std::remove(tmpPath.c_str());
+        assert(0);
+    }
+    out.close();
+    if (!out.good() || std::rename(tmpPath.c_str(), cachePath.c_str()) != 0)
+    {
+        std::cout << "Unable to write weights cache : " << cachePath << std::endl;
+        std::remove(tmpPath.c_str());
+        assert(0);
+    }
+    std::cout << "Wrote " << convLayers.size() << " conv layers to weights cache : " << cachePath
+              << std::endl;
+}
+
+std::unique_ptr<WeightsCache> loadWeightsCache(const std::string& cachePath,
+                                               const std::string& cfgFilePath,
+                                               const std::string& wtsFilePath)
+{
+    if (!std::ifstream(cachePath).good())
+    {
+        std::cout << "Weights cache " << cachePath << " not found, generate it with "
+                  << "yolo-weights-cache. Falling back to " << wtsFilePath << std::endl;
+        return nullptr;
+    }
+    std::unique_ptr<WeightsCache> cache(new WeightsCache(cachePath));
+    if (!cache->isValid())
+    {
+        std::cout << cachePath << " is not a version " << WeightsCache::kVersion
+                  << " weights cache. Falling back to " << wtsFilePath << std::endl;
+        return nullptr;
+    }
+    // the cfg is a few KB and hashed, the .weights are only compared by size and mtime
+    uint64_t weightsSize, weightsMtime;
+    if (cache->getCfgChecksum() != fileChecksum(cfgFilePath)
+        || !getFileStamp(wtsFilePath, weightsSize, weightsMtime)
+        || cache->getWeightsSize() != weightsSize || cache->getWeightsMtime() != weightsMtime)
+    {
+        std::cout << "Weights cache " << cachePath << " is out of date with the cfg or weights "
+                  << "file, regenerate it with yolo-weights-cache. Falling back to "
+                  << wtsFilePath << std::endl;
+        return nullptr;
+    }
+    std::cout << "Using weights cache " << cachePath << std::endl;
+    return cache;
+}
@@ -0,0 +1,128 @@
+/**
+MIT License
+
+Copyright (c) 2018 NVIDIA CORPORATION. All rights reserved.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*
+*/
+
+#ifndef _WEIGHTS_CACHE_H_
+#define _WEIGHTS_CACHE_H_
+
+#include "mapped_file.h"
+
+#include <memory>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+/**
+ * Pre-packed conv weights of a darknet network, written offline by apps/yolo-weights-cache so
+ * that engine builds only map the file instead of re-deriving every layer from the .weights.
+ *
+ * Layout, host endian like the .weights file, every field 4 byte aligned:
+ *   WeightsCacheHeader
+ *   numLayers x { WeightsCacheLayer, kernel[filters * kernelVolume], bias[filters],
+ *                 scale[filters] and power[filters] if batchNormalize }
+ * For batch normalized layers the bias is the folded batch norm shift, otherwise it is the conv
+ * bias. The file is tied to the cfg it was generated from through its checksum and to the
+ * .weights through their size and modification time, so checking it never reads the .weights.
+ * The checksum of the .weights is computed once when the cache is written.
+ */
+struct WeightsCacheHeader
+{
+    char magic[8];
+    uint32_t version;
+    uint32_t numLayers;
+    uint64_t cfgChecksum;
+    uint64_t weightsChecksum;
+    uint64_t weightsSize;
+    // nanoseconds since epoch
+    uint64_t weightsMtime;
+};
+
+struct WeightsCacheLayer
+{
+    uint32_t layerIdx;
+    uint32_t filters;
+    uint32_t kernelVolume;
+    uint32_t batchNormalize;
+};
+
+/**
+ * Conv layer read from a weights cache, all arrays point into the mapping.
+ */
+struct CachedConvWeights
+{
+    uint layerIdx;
+    uint filters;
+    uint kernelVolume;
+    bool batchNormalize;
+    const float* kernel;
+    const float* bias;
+    const float* scale;
+    const float* power;
+
+    // number of floats the layer occupies in the darknet .weights file it was generated from
+    uint64_t numDarknetWeights() const
+    {
+        return static_cast<uint64_t>(filters) * kernelVolume
+            + (batchNormalize ? 4 * filters : filters);
+    }
+};
+
+class WeightsCache
+{
+public:
+    static const uint32_t kVersion = 2;
+
+    explicit WeightsCache(const std::string& cachePath);
+
+    // false if the file is not a weights cache or was written by another version of the format
+    bool isValid() const { return m_Valid; }
+    uint64_t getCfgChecksum() const { return m_Header.cfgChecksum; }
+    uint64_t getWeightsChecksum() const { return m_Header.weightsChecksum; }
+    uint64_t getWeightsSize() const { return m_Header.weightsSize; }
+    uint64_t getWeightsMtime() const { return m_Header.weightsMtime; }
+    // Returns nullptr if the cache holds no conv layer at block index layerIdx
+    const CachedConvWeights* getLayer(const uint layerIdx) const;
+
+private:
+    MappedFile m_File;
+    bool m_Valid;
+    WeightsCacheHeader m_Header;
+    std::vector<CachedConvWeights> m_Layers;
+};
+
+// Folds darknet batch norm parameters into the shift, scale and power of a TensorRT scale layer
+void foldBatchNorm(const uint filters, const float* bnBiases, const float* bnWeights,
+                   const float* bnRunningMean, const float* bnRunningVar, float* shift,
+                   float* scale, float* power);
+// Folds the batch norm parameters of every conv layer in the cfg and writes them to cachePath
+void writeWeightsCache(const std::string& cachePath, const std::string& cfgFilePath,
+                       const std::string& wtsFilePath);
+// Opens the cache at cachePath and checks it against the cfg checksum and the size and
+// modification time of the .weights file. Returns nullptr, after saying why, if the cache is
+// missing or was generated from other files.
+std::unique_ptr<WeightsCache> loadWeightsCache(const std::string& cachePath,
+                                               const std::string& cfgFilePath,
+                                               const std::string& wtsFilePath);
+
+#endif // _WEIGHTS_CACHE_H_
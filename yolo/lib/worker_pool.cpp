@@ -0,0 +1,91 @@
+/**
+MIT License
+
+Copyright (c) 2018 NVIDIA CORPORATION. All rights reserved.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*
+*/
+
+#include "worker_pool.h"
+
+WorkerPool::WorkerPool(const uint numWorkers) :
+    m_Task(nullptr),
+    m_NumTasks(0),
+    m_NextTask(0),
+    m_PendingTasks(0),
+    m_Stop(false)
+{
+    for (uint i = 1; i < numWorkers; ++i) m_Threads.emplace_back(&WorkerPool::workerLoop, this);
+}
+
+WorkerPool::~WorkerPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        m_Stop = true;
+    }
+    m_WorkAvailable.notify_all();
+    for (auto& thread : m_Threads) thread.join();
+}
+
+void WorkerPool::parallelFor(const uint numTasks, const std::function<void(const uint)>& task)
+{
+    if (numTasks == 0) return;
+    if (m_Threads.empty() || numTasks == 1)
+    {
+        for (uint i = 0; i < numTasks; ++i) task(i);
+        return;
+    }
+
+    std::unique_lock<std::mutex> lock(m_Mutex);
+    m_Task = &task;
+    m_NumTasks = numTasks;
+    m_NextTask = 0;
+    m_PendingTasks = numTasks;
+    m_WorkAvailable.notify_all();
+
+    runTasks(lock);
+    m_WorkDone.wait(lock, [this] { return m_PendingTasks == 0; });
+    m_Task = nullptr;
+}
+
+void WorkerPool::workerLoop()
+{
+    std::unique_lock<std::mutex> lock(m_Mutex);
+    while (true)
+    {
+        m_WorkAvailable.wait(lock, [this] { return m_Stop || (m_NextTask < m_NumTasks); });
+        if (m_Stop) return;
+        runTasks(lock);
+    }
+}
+
+void WorkerPool::runTasks(std::unique_lock<std::mutex>& lock)
+{
+    while (m_NextTask < m_NumTasks)
+    {
+        const uint taskIdx = m_NextTask++;
+        const std::function<void(const uint)>& task = *m_Task;
+        lock.unlock();
+        task(taskIdx);
+        lock.lock();
+        if (--m_PendingTasks == 0) m_WorkDone.notify_all();
+    }
+}
@@ -0,0 +1,69 @@
+/**
+MIT License
+
+Copyright (c) 2018 NVIDIA CORPORATION. All rights reserved.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*
+*/
+
+#ifndef _WORKER_POOL_H_
+#define _WORKER_POOL_H_
+
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <stdint.h>
+#include <thread>
+#include <vector>
+
+/**
+ * Fixed set of persistent threads used to fan per-image work of a batch out across cores.
+ * The calling thread takes part in every job, so a pool of N workers spawns N - 1 threads and a
+ * pool of size 0 or 1 runs everything inline.
+ */
+class WorkerPool
+{
+public:
+    explicit WorkerPool(const uint numWorkers);
+    ~WorkerPool();
+    WorkerPool(const WorkerPool&) = delete;
+    WorkerPool& operator=(const WorkerPool&) = delete;
+
+    uint getNumWorkers() const { return m_Threads.size() + 1; }
+    // Runs task(i) for every i in [0, numTasks) and returns once all of them have completed.
+    // Tasks may run in any order, so each one must only write to state owned by its index.
+    void parallelFor(const uint numTasks, const std::function<void(const uint)>& task);
+
+private:
+    void workerLoop();
+    void runTasks(std::unique_lock<std::mutex>& lock);
+
+    std::vector<std::thread> m_Threads;
+    std::mutex m_Mutex;
+    std::condition_variable m_WorkAvailable;
+    std::condition_variable m_WorkDone;
+    const std::function<void(const uint)>* m_Task;
+    uint m_NumTasks;
+    uint m_NextTask;
+    uint m_PendingTasks;
+    bool m_Stop;
+};
+
+#endif // _WORKER_POOL_H_
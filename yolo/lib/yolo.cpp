@@ -32,6 +32,7 @@ Yolo::Yolo(const uint batchSize, const NetworkInfo& networkInfo, const InferPara
     m_NetworkType(networkInfo.networkType),
     m_ConfigFilePath(networkInfo.configFilePath),
     m_WtsFilePath(networkInfo.wtsFilePath),
+    m_WeightsCachePath(networkInfo.weightsCachePath),
     m_LabelsFilePath(networkInfo.labelsFilePath),
     m_Precision(networkInfo.precision),
     m_DeviceType(networkInfo.deviceType),
@@ -45,6 +46,14 @@ Yolo::Yolo(const uint batchSize, const NetworkInfo& networkInfo, const InferPara
     m_InputSize(0),
     m_ProbThresh(inferParams.probThresh),
     m_NMSThresh(inferParams.nmsThresh),
+    m_PreNMSTopK(inferParams.preNMSTopK),
+    m_MaxDetections(inferParams.maxDetections),
+    m_NMSEngine(parseNMSEngine(inferParams.nmsEngine)),
+    m_BatchedNMS(inferParams.batchedNMS),
+    m_NMSType(parseNMSType(inferParams.nmsType)),
+    m_SoftNMSSigma(inferParams.softNMSSigma),
+    m_LogitDecode(inferParams.logitDecode),
+    m_LetterboxFilter(parseLetterboxFilter(inferParams.letterboxFilter)),
     m_PrintPerfInfo(inferParams.printPerfInfo),
     m_PrintPredictions(inferParams.printPredictionInfo),
     m_Logger(Logger()),
@@ -57,13 +66,56 @@ Yolo::Yolo(const uint batchSize, const NetworkInfo& networkInfo, const InferPara
     m_InputBindingIndex(-1),
     m_CudaStream(nullptr),
     m_PluginFactory(new PluginFactory),
-    m_TinyMaxpoolPaddingFormula(new YoloTinyMaxpoolPaddingFormula)
+    m_TinyMaxpoolPaddingFormula(new YoloTinyMaxpoolPaddingFormula),
+    m_WeightsChecksum(0)
 {
     m_ClassNames = loadListFromTextFile(m_LabelsFilePath);
-    m_configBlocks = parseConfigFile(m_ConfigFilePath);
+    assert(fileExists(m_ConfigFilePath));
+    m_NetworkDesc = parseNetworkCfg(m_ConfigFilePath, networkInfo.inputW, networkInfo.inputH);
     parseConfigBlocks();
 
-    if (m_Precision == "kFLOAT")
+    // Engines built at an input size other than the cfg's get it as a suffix, so a set of them
+    // derived from one cfg don't overwrite each other
+    if ((networkInfo.inputW != 0) || (networkInfo.inputH != 0))
+    {
+        const std::string suffix = "-" + std::to_string(m_InputW) + "x" + std::to_string(m_InputH);
+        const size_t extIndex = m_EnginePath.rfind(".engine");
+        if (extIndex != std::string::npos)
+            m_EnginePath.insert(extIndex, suffix);
+        else
+            m_EnginePath += suffix;
+    }
+
+    // pre-packed conv layers, see apps/yolo-weights-cache. Without one they are built from the
+    // .weights file
+    if (!m_WeightsCachePath.empty() && m_WeightsCachePath != "not-specified")
+        m_WeightsCache = loadWeightsCache(m_WeightsCachePath, m_ConfigFilePath, m_WtsFilePath);
+
+    // With an engine cache the plan is looked up by everything it was built from instead of by
+    // m_EnginePath
+    bool engineFound;
+    if (!networkInfo.engineCacheDir.empty() && networkInfo.engineCacheDir != "not-specified")
+    {
+        m_EngineCache.reset(new EngineCache(networkInfo.engineCacheDir,
+                                            networkInfo.engineCacheMaxSizeMB * 1024 * 1024));
+        // hashed once per engine, or not at all when the weights cache recorded the checksum
+        m_WeightsChecksum = m_WeightsCache ? m_WeightsCache->getWeightsChecksum()
+                                           : fileChecksum(m_WtsFilePath);
+        const EngineCacheKey key = getEngineCacheKey();
+        m_EnginePath = m_EngineCache->getPlanPath(key);
+        engineFound = m_EngineCache->lookup(key);
+    }
+    else
+        engineFound = fileExists(m_EnginePath, false);
+
+    // The output tensors are fully described by the cfg, so the weights are only loaded and the
+    // network only built when there is no engine to deserialize
+    if (engineFound)
+    {
+        std::cout << "Using previously generated plan file located at " << m_EnginePath
+                  << std::endl;
+    }
+    else if (m_Precision == "kFLOAT")
     {
         createYOLOEngine();
     }
@@ -71,7 +123,7 @@ Yolo::Yolo(const uint batchSize, const NetworkInfo& networkInfo, const InferPara
     {
         Int8EntropyCalibrator calibrator(m_BatchSize, m_CalibImages, m_CalibImagesFilePath,
                                          m_CalibTableFilePath, m_InputSize, m_InputH, m_InputW,
-                                         m_InputBlobName);
+                                         m_InputBlobName, m_LetterboxFilter);
         createYOLOEngine(nvinfer1::DataType::kINT8, &calibrator);
     }
     else if (m_Precision == "kHALF")
@@ -83,6 +135,8 @@ Yolo::Yolo(const uint batchSize, const NetworkInfo& networkInfo, const InferPara
         std::cout << "Unrecognized precision type " << m_Precision << std::endl;
         assert(0);
     }
+    // the conv layers are part of the engine from here on
+    m_WeightsCache.reset();
     assert(m_PluginFactory != nullptr);
     m_Engine = loadTRTEngine(m_EnginePath, m_PluginFactory, m_Logger);
     assert(m_Engine != nullptr);
@@ -124,7 +178,10 @@ Yolo::~Yolo()
 
 void Yolo::createYOLOEngine(const nvinfer1::DataType dataType, Int8EntropyCalibrator* calibrator)
 {
-    std::vector<float> weights = loadWeights(m_WtsFilePath, m_NetworkType);
+    // Without a weights cache the .weights are mapped for the whole build, conv layers reference
+    // them without a copy. With one they are not read at all
+    std::unique_ptr<DarknetWeights> weights;
+    if (!m_WeightsCache) weights = loadWeights(m_WtsFilePath);
     std::vector<nvinfer1::Weights> trtWeights;
     int weightPtr = 0;
     int channels = m_InputC;
@@ -170,32 +227,51 @@ void Yolo::createYOLOEngine(const nvinfer1::DataType dataType, Int8EntropyCalibr
     m_Network->setPoolingOutputDimensionsFormula(m_TinyMaxpoolPaddingFormula.get());
 
     // build the network using the network API
-    for (uint i = 0; i < m_configBlocks.size(); ++i)
+    printLayerInfo("", "layer", "     inp_size", "     out_size", "weightPtr");
+    for (const LayerDesc& layer : m_NetworkDesc.layers)
     {
         // check if num. of channels is correct
         assert(getNumChannels(previous) == channels);
+        const uint i = layer.layerIdx;
         std::string layerIndex = "(" + std::to_string(i) + ")";
 
-        if (m_configBlocks.at(i).at("type") == "net")
+        switch (layer.type)
         {
-            printLayerInfo("", "layer", "     inp_size", "     out_size", "weightPtr");
-        }
-        else if (m_configBlocks.at(i).at("type") == "convolutional")
+        case LayerType::kConvolutional:
         {
             std::string inputVol = dimsToString(previous->getDimensions());
             nvinfer1::ILayer* out;
             std::string layerType;
+            const CachedConvWeights* cached
+                = m_WeightsCache ? m_WeightsCache->getLayer(i) : nullptr;
+            if (m_WeightsCache && !cached)
+            {
+                std::cout << "Weights cache has no entry for layer " << i << std::endl;
+                assert(0);
+            }
             // check if batch_norm enabled
-            if (m_configBlocks.at(i).find("batch_normalize") != m_configBlocks.at(i).end())
+            if (layer.conv.batchNormalize)
             {
-                out = netAddConvBNLeaky(i, m_configBlocks.at(i), weights, trtWeights, weightPtr,
-                                        channels, previous, m_Network);
+                if (cached)
+                {
+                    out = netAddConvBNLeaky(i, layer.conv, *cached, channels, previous, m_Network);
+                    weightPtr += cached->numDarknetWeights();
+                }
+                else
+                    out = netAddConvBNLeaky(i, layer.conv, *weights, trtWeights, weightPtr,
+                                            channels, previous, m_Network);
                 layerType = "conv-bn-leaky";
             }
             else
             {
-                out = netAddConvLinear(i, m_configBlocks.at(i), weights, trtWeights, weightPtr,
-                                       channels, previous, m_Network);
+                if (cached)
+                {
+                    out = netAddConvLinear(i, layer.conv, *cached, channels, previous, m_Network);
+                    weightPtr += cached->numDarknetWeights();
+                }
+                else
+                    out = netAddConvLinear(i, layer.conv, *weights, trtWeights, weightPtr,
+                                           channels, previous, m_Network);
                 layerType = "conv-linear";
             }
             previous = out->getOutput(0);
@@ -204,21 +280,15 @@ void Yolo::createYOLOEngine(const nvinfer1::DataType dataType, Int8EntropyCalibr
             std::string outputVol = dimsToString(previous->getDimensions());
             tensorOutputs.push_back(out->getOutput(0));
             printLayerInfo(layerIndex, layerType, inputVol, outputVol, std::to_string(weightPtr));
+            break;
         }
-        else if (m_configBlocks.at(i).at("type") == "shortcut")
+        case LayerType::kShortcut:
         {
-            assert(m_configBlocks.at(i).at("activation") == "linear");
-            assert(m_configBlocks.at(i).find("from") != m_configBlocks.at(i).end());
-            int from = stoi(m_configBlocks.at(i).at("from"));
-
             std::string inputVol = dimsToString(previous->getDimensions());
-            // check if indexes are correct
-            assert((i - 2 >= 0) && (i - 2 < tensorOutputs.size()));
-            assert((i + from - 1 >= 0) && (i + from - 1 < tensorOutputs.size()));
-            assert(i + from - 1 < i - 2);
-            nvinfer1::IElementWiseLayer* ew
-                = m_Network->addElementWise(*tensorOutputs[i - 2], *tensorOutputs[i + from - 1],
-                                            nvinfer1::ElementWiseOperation::kSUM);
+            // the sum of the previous layer and the one the shortcut comes from
+            nvinfer1::IElementWiseLayer* ew = m_Network->addElementWise(
+                *tensorOutputs.back(), *tensorOutputs.at(layer.shortcut.input),
+                nvinfer1::ElementWiseOperation::kSUM);
             assert(ew != nullptr);
             std::string ewLayerName = "shortcut_" + std::to_string(i);
             ew->setName(ewLayerName.c_str());
@@ -227,23 +297,19 @@ void Yolo::createYOLOEngine(const nvinfer1::DataType dataType, Int8EntropyCalibr
             std::string outputVol = dimsToString(previous->getDimensions());
             tensorOutputs.push_back(ew->getOutput(0));
             printLayerInfo(layerIndex, "skip", inputVol, outputVol, "    -");
+            break;
         }
-        else if (m_configBlocks.at(i).at("type") == "yolo")
+        case LayerType::kYolo:
         {
             nvinfer1::Dims prevTensorDims = previous->getDimensions();
-            assert(prevTensorDims.d[1] == prevTensorDims.d[2]);
             TensorInfo& curYoloTensor = m_OutputTensors.at(outputTensorCount);
-            curYoloTensor.gridSize = prevTensorDims.d[1];
-            curYoloTensor.stride = m_InputW / curYoloTensor.gridSize;
-            m_OutputTensors.at(outputTensorCount).volume = curYoloTensor.gridSize
-                * curYoloTensor.gridSize
-                * (curYoloTensor.numBBoxes * (5 + curYoloTensor.numClasses));
-            std::string layerName = "yolo_" + std::to_string(i);
-            curYoloTensor.blobName = layerName;
+            // the grid size derived from the cfg has to agree with the network
+            assert(prevTensorDims.d[1] == static_cast<int>(curYoloTensor.gridH));
+            assert(prevTensorDims.d[2] == static_cast<int>(curYoloTensor.gridW));
+            std::string layerName = curYoloTensor.blobName;
             nvinfer1::IPlugin* yoloPlugin
-                = new YoloLayerV3(m_OutputTensors.at(outputTensorCount).numBBoxes,
-                                  m_OutputTensors.at(outputTensorCount).numClasses,
-                                  m_OutputTensors.at(outputTensorCount).gridSize);
+                = new YoloLayerV3(curYoloTensor.numBBoxes, curYoloTensor.numClasses,
+                                  curYoloTensor.gridW, curYoloTensor.gridH, m_LogitDecode);
             assert(yoloPlugin != nullptr);
             nvinfer1::IPluginLayer* yolo = m_Network->addPlugin(&previous, 1, *yoloPlugin);
             assert(yolo != nullptr);
@@ -258,19 +324,16 @@ void Yolo::createYOLOEngine(const nvinfer1::DataType dataType, Int8EntropyCalibr
             tensorOutputs.push_back(yolo->getOutput(0));
             printLayerInfo(layerIndex, "yolo", inputVol, outputVol, std::to_string(weightPtr));
             ++outputTensorCount;
+            break;
         }
-        else if (m_configBlocks.at(i).at("type") == "region")
+        case LayerType::kRegion:
         {
             nvinfer1::Dims prevTensorDims = previous->getDimensions();
-            assert(prevTensorDims.d[1] == prevTensorDims.d[2]);
             TensorInfo& curRegionTensor = m_OutputTensors.at(outputTensorCount);
-            curRegionTensor.gridSize = prevTensorDims.d[1];
-            curRegionTensor.stride = m_InputW / curRegionTensor.gridSize;
-            m_OutputTensors.at(outputTensorCount).volume = curRegionTensor.gridSize
-                * curRegionTensor.gridSize
-                * (curRegionTensor.numBBoxes * (5 + curRegionTensor.numClasses));
-            std::string layerName = "region_" + std::to_string(i);
-            curRegionTensor.blobName = layerName;
+            // the grid size derived from the cfg has to agree with the network
+            assert(prevTensorDims.d[1] == static_cast<int>(curRegionTensor.gridH));
+            assert(prevTensorDims.d[2] == static_cast<int>(curRegionTensor.gridW));
+            std::string layerName = curRegionTensor.blobName;
             nvinfer1::plugin::RegionParameters RegionParameters{
                 static_cast<int>(curRegionTensor.numBBoxes), 4,
                 static_cast<int>(curRegionTensor.numClasses), nullptr};
@@ -289,15 +352,14 @@ void Yolo::createYOLOEngine(const nvinfer1::DataType dataType, Int8EntropyCalibr
             channels = getNumChannels(previous);
             tensorOutputs.push_back(region->getOutput(0));
             printLayerInfo(layerIndex, "region", inputVol, outputVol, std::to_string(weightPtr));
-            std::cout << "Anchors are being converted to network input resolution i.e. Anchors x "
-                      << curRegionTensor.stride << " (stride)" << std::endl;
-            for (auto& anchor : curRegionTensor.anchors) anchor *= curRegionTensor.stride;
             ++outputTensorCount;
+            break;
         }
-        else if (m_configBlocks.at(i).at("type") == "reorg")
+        case LayerType::kReorg:
         {
             std::string inputVol = dimsToString(previous->getDimensions());
-            nvinfer1::IPlugin* reorgPlugin = nvinfer1::plugin::createYOLOReorgPlugin(2);
+            nvinfer1::IPlugin* reorgPlugin
+                = nvinfer1::plugin::createYOLOReorgPlugin(layer.reorg.stride);
             assert(reorgPlugin != nullptr);
             nvinfer1::IPluginLayer* reorg = m_Network->addPlugin(&previous, 1, *reorgPlugin);
             assert(reorg != nullptr);
@@ -310,115 +372,82 @@ void Yolo::createYOLOEngine(const nvinfer1::DataType dataType, Int8EntropyCalibr
             channels = getNumChannels(previous);
             tensorOutputs.push_back(reorg->getOutput(0));
             printLayerInfo(layerIndex, "reorg", inputVol, outputVol, std::to_string(weightPtr));
+            break;
         }
         // route layers (single or concat)
-        else if (m_configBlocks.at(i).at("type") == "route")
+        case LayerType::kRoute:
         {
-            size_t found = m_configBlocks.at(i).at("layers").find(",");
-            if (found != std::string::npos)
+            if (layer.route.inputs.size() > 1)
             {
-                int idx1 = std::stoi(trim(m_configBlocks.at(i).at("layers").substr(0, found)));
-                int idx2 = std::stoi(trim(m_configBlocks.at(i).at("layers").substr(found + 1)));
-                if (idx1 < 0)
-                {
-                    idx1 = tensorOutputs.size() + idx1;
-                }
-                if (idx2 < 0)
-                {
-                    idx2 = tensorOutputs.size() + idx2;
-                }
-                assert(idx1 < static_cast<int>(tensorOutputs.size()) && idx1 >= 0);
-                assert(idx2 < static_cast<int>(tensorOutputs.size()) && idx2 >= 0);
-                nvinfer1::ITensor** concatInputs
-                    = reinterpret_cast<nvinfer1::ITensor**>(malloc(sizeof(nvinfer1::ITensor*) * 2));
-                concatInputs[0] = tensorOutputs[idx1];
-                concatInputs[1] = tensorOutputs[idx2];
+                std::vector<nvinfer1::ITensor*> concatInputs;
+                for (const uint idx : layer.route.inputs)
+                    concatInputs.push_back(tensorOutputs.at(idx));
                 nvinfer1::IConcatenationLayer* concat
-                    = m_Network->addConcatenation(concatInputs, 2);
+                    = m_Network->addConcatenation(concatInputs.data(),
+                                                static_cast<int>(concatInputs.size()));
                 assert(concat != nullptr);
                 std::string concatLayerName = "route_" + std::to_string(i - 1);
                 concat->setName(concatLayerName.c_str());
                 // concatenate along the channel dimension
                 concat->setAxis(0);
                 previous = concat->getOutput(0);
-                assert(previous != nullptr);
-                std::string outputVol = dimsToString(previous->getDimensions());
-                // set the output volume depth
-                channels
-                    = getNumChannels(tensorOutputs[idx1]) + getNumChannels(tensorOutputs[idx2]);
-                tensorOutputs.push_back(concat->getOutput(0));
-                printLayerInfo(layerIndex, "route", "        -", outputVol,
-                               std::to_string(weightPtr));
             }
             else
             {
-                int idx = std::stoi(trim(m_configBlocks.at(i).at("layers")));
-                if (idx < 0)
-                {
-                    idx = tensorOutputs.size() + idx;
-                }
-                assert(idx < static_cast<int>(tensorOutputs.size()) && idx >= 0);
-                previous = tensorOutputs[idx];
-                assert(previous != nullptr);
-                std::string outputVol = dimsToString(previous->getDimensions());
-                // set the output volume depth
-                channels = getNumChannels(tensorOutputs[idx]);
-                tensorOutputs.push_back(tensorOutputs[idx]);
-                printLayerInfo(layerIndex, "route", "        -", outputVol,
-                               std::to_string(weightPtr));
+                previous = tensorOutputs.at(layer.route.inputs.front());
             }
+            assert(previous != nullptr);
+            std::string outputVol = dimsToString(previous->getDimensions());
+            // set the output volume depth
+            channels = getNumChannels(previous);
+            tensorOutputs.push_back(previous);
+            printLayerInfo(layerIndex, "route", "        -", outputVol, std::to_string(weightPtr));
+            break;
         }
-        else if (m_configBlocks.at(i).at("type") == "upsample")
+        case LayerType::kUpsample:
         {
             std::string inputVol = dimsToString(previous->getDimensions());
-            nvinfer1::ILayer* out = netAddUpsample(i - 1, m_configBlocks[i], weights, trtWeights,
-                                                   channels, previous, m_Network);
+            nvinfer1::ILayer* out = netAddUpsample(i - 1, layer.upsample, trtWeights, channels,
+                                                   previous, m_Network);
             previous = out->getOutput(0);
             std::string outputVol = dimsToString(previous->getDimensions());
             tensorOutputs.push_back(out->getOutput(0));
             printLayerInfo(layerIndex, "upsample", inputVol, outputVol, "    -");
+            break;
         }
-        else if (m_configBlocks.at(i).at("type") == "maxpool")
+        case LayerType::kMaxpool:
         {
             // Add same padding layers
-            if (m_configBlocks.at(i).at("size") == "2" && m_configBlocks.at(i).at("stride") == "1")
+            if (layer.maxpool.size == 2 && layer.maxpool.stride == 1)
             {
                 m_TinyMaxpoolPaddingFormula->addSamePaddingLayer("maxpool_" + std::to_string(i));
             }
             std::string inputVol = dimsToString(previous->getDimensions());
-            nvinfer1::ILayer* out = netAddMaxpool(i, m_configBlocks.at(i), previous, m_Network);
+            nvinfer1::ILayer* out = netAddMaxpool(i, layer.maxpool, previous, m_Network);
             previous = out->getOutput(0);
             assert(previous != nullptr);
             std::string outputVol = dimsToString(previous->getDimensions());
             tensorOutputs.push_back(out->getOutput(0));
             printLayerInfo(layerIndex, "maxpool", inputVol, outputVol, std::to_string(weightPtr));
+            break;
         }
-        else
-        {
-            std::cout << "Unsupported layer type --> \"" << m_configBlocks.at(i).at("type") << "\""
-                      << std::endl;
-            assert(0);
         }
+        // the shapes derived from the cfg have to agree with the network
+        assert(getNumChannels(previous) == static_cast<int>(layer.output.channels));
+        assert(previous->getDimensions().d[1] == static_cast<int>(layer.output.height));
+        assert(previous->getDimensions().d[2] == static_cast<int>(layer.output.width));
     }
 
-    if (weights.size() != weightPtr)
+    // a weights cache was checked to use up the whole .weights file when it was written
+    if (weights && weights->size() != weightPtr)
     {
-        std::cout << "Number of unused weights left : " << weights.size() - weightPtr << std::endl;
+        std::cout << "Number of unused weights left : " << weights->size() - weightPtr << std::endl;
         assert(0);
     }
 
     std::cout << "Output blob names :" << std::endl;
     for (auto& tensor : m_OutputTensors) std::cout << tensor.blobName << std::endl;
 
-    // Create and cache the engine if not already present
-    if (fileExists(m_EnginePath))
-    {
-        std::cout << "Using previously generated plan file located at " << m_EnginePath
-                  << std::endl;
-        destroyNetworkUtils(trtWeights);
-        return;
-    }
-
     std::cout << "Unable to find cached TensorRT engine for network : " << m_NetworkType
               << " precision : " << m_Precision << " and batch size :" << m_BatchSize << std::endl;
 
@@ -483,135 +512,45 @@ void Yolo::doInference(const unsigned char* input, const uint batchSize)
     cudaStreamSynchronize(m_CudaStream);
 }
 
-std::vector<BBoxInfo> Yolo::decodeDetections(const int& imageIdx, const int& imageH,
-                                             const int& imageW)
+uint Yolo::getMaxProposals() const
 {
-    std::vector<BBoxInfo> binfo;
+    uint maxProposals = 0;
     for (auto& tensor : m_OutputTensors)
     {
-        std::vector<BBoxInfo> curBInfo = decodeTensor(imageIdx, imageH, imageW, tensor);
-        binfo.insert(binfo.end(), curBInfo.begin(), curBInfo.end());
+        maxProposals += tensor.gridW * tensor.gridH * tensor.numBBoxes;
     }
+    return maxProposals;
+}
+
+std::vector<BBoxInfo> Yolo::decodeDetections(const int& imageIdx, const int& imageH,
+                                             const int& imageW)
+{
+    std::vector<BBoxInfo> binfo;
+    decodeDetections(imageIdx, imageH, imageW, binfo);
     return binfo;
 }
 
-std::vector<std::map<std::string, std::string>> Yolo::parseConfigFile(const std::string cfgFilePath)
+void Yolo::decodeDetections(const int& imageIdx, const int& imageH, const int& imageW,
+                            std::vector<BBoxInfo>& binfo)
 {
-    assert(fileExists(cfgFilePath));
-    std::ifstream file(cfgFilePath);
-    assert(file.good());
-    std::string line;
-    std::vector<std::map<std::string, std::string>> blocks;
-    std::map<std::string, std::string> block;
-
-    while (getline(file, line))
+    binfo.clear();
+    const DecodeParams params{m_InputW, m_InputH, imageW, imageH, m_ProbThresh, m_ClassIds.data()};
+    for (auto& tensor : m_OutputTensors)
     {
-        if (line.size() == 0) continue;
-        if (line.front() == '#') continue;
-        line = trim(line);
-        if (line.front() == '[')
-        {
-            if (block.size() > 0)
-            {
-                blocks.push_back(block);
-                block.clear();
-            }
-            std::string key = "type";
-            std::string value = trim(line.substr(1, line.size() - 2));
-            block.insert(std::pair<std::string, std::string>(key, value));
-        }
-        else
-        {
-            int cpos = line.find('=');
-            std::string key = trim(line.substr(0, cpos));
-            std::string value = trim(line.substr(cpos + 1));
-            block.insert(std::pair<std::string, std::string>(key, value));
-        }
+        tensor.decoder(tensor, &tensor.hostBuffer[imageIdx * tensor.volume], params, binfo);
     }
-    blocks.push_back(block);
-    return blocks;
+    // Bound the work NMS has to do on crowded frames
+    selectTopK(m_PreNMSTopK, binfo);
 }
 
 void Yolo::parseConfigBlocks()
 {
-    for (auto block : m_configBlocks)
-    {
-        if (block.at("type") == "net")
-        {
-            assert((block.find("height") != block.end())
-                   && "Missing 'height' param in network cfg");
-            assert((block.find("width") != block.end()) && "Missing 'width' param in network cfg");
-            assert((block.find("channels") != block.end())
-                   && "Missing 'channels' param in network cfg");
-
-            m_InputH = std::stoul(block.at("height"));
-            m_InputW = std::stoul(block.at("width"));
-            m_InputC = std::stoul(block.at("channels"));
-            assert(m_InputW == m_InputH);
-            m_InputSize = m_InputC * m_InputH * m_InputW;
-        }
-        else if ((block.at("type") == "region") || (block.at("type") == "yolo"))
-        {
-            assert((block.find("num") != block.end())
-                   && std::string("Missing 'num' param in " + block.at("type") + " layer").c_str());
-            assert((block.find("classes") != block.end())
-                   && std::string("Missing 'classes' param in " + block.at("type") + " layer")
-                          .c_str());
-            assert((block.find("anchors") != block.end())
-                   && std::string("Missing 'anchors' param in " + block.at("type") + " layer")
-                          .c_str());
-
-            TensorInfo outputTensor;
-            std::string anchorString = block.at("anchors");
-            while (!anchorString.empty())
-            {
-                int npos = anchorString.find_first_of(',');
-                if (npos != -1)
-                {
-                    float anchor = std::stof(trim(anchorString.substr(0, npos)));
-                    outputTensor.anchors.push_back(anchor);
-                    anchorString.erase(0, npos + 1);
-                }
-                else
-                {
-                    float anchor = std::stof(trim(anchorString));
-                    outputTensor.anchors.push_back(anchor);
-                    break;
-                }
-            }
-
-            if ((m_NetworkType == "yolov3") || (m_NetworkType == "yolov3-tiny"))
-            {
-                assert((block.find("mask") != block.end())
-                       && std::string("Missing 'mask' param in " + block.at("type") + " layer")
-                              .c_str());
-
-                std::string maskString = block.at("mask");
-                while (!maskString.empty())
-                {
-                    int npos = maskString.find_first_of(',');
-                    if (npos != -1)
-                    {
-                        uint mask = std::stoul(trim(maskString.substr(0, npos)));
-                        outputTensor.masks.push_back(mask);
-                        maskString.erase(0, npos + 1);
-                    }
-                    else
-                    {
-                        uint mask = std::stoul(trim(maskString));
-                        outputTensor.masks.push_back(mask);
-                        break;
-                    }
-                }
-            }
+    m_InputH = m_NetworkDesc.inputH;
+    m_InputW = m_NetworkDesc.inputW;
+    m_InputC = m_NetworkDesc.inputC;
+    m_InputSize = m_InputC * m_InputH * m_InputW;
 
-            outputTensor.numBBoxes = outputTensor.masks.size() > 0
-                ? outputTensor.masks.size()
-                : std::stoul(trim(block.at("num")));
-            outputTensor.numClasses = std::stoul(block.at("classes"));
-            m_OutputTensors.push_back(outputTensor);
-        }
-    }
+    m_OutputTensors = getOutputTensors(m_NetworkDesc, m_LogitDecode);
 }
 
 void Yolo::allocateBuffers()
@@ -675,14 +614,38 @@ void Yolo::writePlanFileToDisk()
     assert(m_ModelStream && "Unable to serialize engine");
     assert(!m_EnginePath.empty() && "Enginepath is empty");
 
+    if (m_EngineCache)
+    {
+        // keyed again as an INT8 build may just have generated the calibration table
+        const EngineCacheKey key = getEngineCacheKey();
+        m_EngineCache->insert(key, m_ModelStream->data(), m_ModelStream->size());
+        m_EnginePath = m_EngineCache->getPlanPath(key);
+        std::cout << "Serialized plan file cached at location : " << m_EnginePath << std::endl;
+        return;
+    }
+
     // write data to output file
-    std::stringstream gieModelStream;
-    gieModelStream.seekg(0, gieModelStream.beg);
-    gieModelStream.write(static_cast<const char*>(m_ModelStream->data()), m_ModelStream->size());
-    std::ofstream outFile;
-    outFile.open(m_EnginePath);
-    outFile << gieModelStream.rdbuf();
-    outFile.close();
+    writePlanFile(m_EnginePath, m_ModelStream);
 
     std::cout << "Serialized plan file cached at location : " << m_EnginePath << std::endl;
 }
+
+EngineCacheKey Yolo::getEngineCacheKey() const
+{
+    EngineCacheKey key;
+    key.add("networkType", m_NetworkType);
+    key.addFileChecksum("cfg", m_ConfigFilePath);
+    key.addChecksum("weights", m_WeightsChecksum);
+    if (m_Precision == "kINT8")
+        key.addFileChecksum("calibrationTable", m_CalibTableFilePath);
+    else
+        key.add("calibrationTable", "none");
+    key.add("precision", m_Precision);
+    key.add("deviceType", m_DeviceType);
+    key.add("batchSize", std::to_string(m_BatchSize));
+    key.add("inputBlobName", m_InputBlobName);
+    key.add("inputSize", std::to_string(m_InputW) + "x" + std::to_string(m_InputH));
+    key.add("logitDecode", m_LogitDecode ? "true" : "false");
+    key.add("tensorrtVersion", std::to_string(getInferLibVersion()));
+    return key;
+}
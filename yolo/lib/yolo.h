@@ -27,8 +27,11 @@ SOFTWARE.
 #define _YOLO_H_
 
 #include "calibrator.h"
+#include "engine_cache.h"
 #include "plugin_factory.h"
 #include "trt_utils.h"
+#include "yolo_cfg.h"
+#include "yolo_decode.h"
 
 #include "NvInfer.h"
 
@@ -50,6 +53,12 @@ struct NetworkInfo
     std::string calibrationTablePath;
     std::string enginePath;
     std::string inputBlobName;
+    std::string weightsCachePath;
+    std::string engineCacheDir;
+    uint64_t engineCacheMaxSizeMB;
+    // Input size the engine is built for, 0 keeps the width/height of the cfg
+    uint inputW;
+    uint inputH;
 };
 
 /**
@@ -63,23 +72,14 @@ struct InferParams
     std::string calibImagesPath;
     float probThresh;
     float nmsThresh;
-};
-
-/**
- * Holds information about an output tensor of the yolo network.
- */
-struct TensorInfo
-{
-    std::string blobName;
-    uint stride{0};
-    uint gridSize{0};
-    uint numClasses{0};
-    uint numBBoxes{0};
-    uint64_t volume{0};
-    std::vector<uint> masks;
-    std::vector<float> anchors;
-    int bindingIndex{-1};
-    float* hostBuffer{nullptr};
+    uint preNMSTopK;
+    uint maxDetections;
+    std::string nmsEngine;
+    bool batchedNMS;
+    std::string nmsType;
+    float softNMSSigma;
+    bool logitDecode;
+    std::string letterboxFilter;
 };
 
 class Yolo
@@ -87,16 +87,26 @@ class Yolo
 public:
     std::string getNetworkType() const { return m_NetworkType; }
     float getNMSThresh() const { return m_NMSThresh; }
+    NMSParams getNMSParams() const
+    {
+        return NMSParams{m_NMSThresh, m_MaxDetections, m_NMSEngine, m_BatchedNMS,
+                         m_NMSType,   m_SoftNMSSigma,  m_ProbThresh};
+    }
     std::string getClassName(const int& label) const { return m_ClassNames.at(label); }
     int getClassId(const int& label) const { return m_ClassIds.at(label); }
     uint getInputH() const { return m_InputH; }
     uint getInputW() const { return m_InputW; }
+    LetterboxFilter getLetterboxFilter() const { return m_LetterboxFilter; }
     uint getNumClasses() const { return m_ClassNames.size(); }
+    uint getMaxProposals() const;
     bool isPrintPredictions() const { return m_PrintPredictions; }
     bool isPrintPerfInfo() const { return m_PrintPerfInfo; }
     void doInference(const unsigned char* input, const uint batchSize);
     std::vector<BBoxInfo> decodeDetections(const int& imageIdx, const int& imageH,
                                            const int& imageW);
+    // Same as above, but reuses the caller's buffer instead of returning a new one
+    void decodeDetections(const int& imageIdx, const int& imageH, const int& imageW,
+                          std::vector<BBoxInfo>& binfo);
 
     virtual ~Yolo();
 
@@ -106,6 +116,7 @@ protected:
     const std::string m_NetworkType;
     const std::string m_ConfigFilePath;
     const std::string m_WtsFilePath;
+    const std::string m_WeightsCachePath;
     const std::string m_LabelsFilePath;
     const std::string m_Precision;
     const std::string m_DeviceType;
@@ -114,13 +125,23 @@ protected:
     std::string m_CalibTableFilePath;
     const std::string m_InputBlobName;
     std::vector<TensorInfo> m_OutputTensors;
-    std::vector<std::map<std::string, std::string>> m_configBlocks;
+    NetworkDesc m_NetworkDesc;
     uint m_InputH;
     uint m_InputW;
     uint m_InputC;
     uint64_t m_InputSize;
     const float m_ProbThresh;
     const float m_NMSThresh;
+    const uint m_PreNMSTopK;
+    const uint m_MaxDetections;
+    const NMSEngine m_NMSEngine;
+    const bool m_BatchedNMS;
+    const NMSType m_NMSType;
+    const float m_SoftNMSSigma;
+    // yolo layers return raw logits, which are thresholded before any activation is applied
+    const bool m_LogitDecode;
+    // filter the network inputs are resized with, also when calibrating
+    const LetterboxFilter m_LetterboxFilter;
     std::vector<std::string> m_ClassNames;
     // Class ids for coco benchmarking
     const std::vector<int> m_ClassIds{
@@ -144,38 +165,22 @@ protected:
     cudaStream_t m_CudaStream;
     PluginFactory* m_PluginFactory;
     std::unique_ptr<YoloTinyMaxpoolPaddingFormula> m_TinyMaxpoolPaddingFormula;
-
-    virtual std::vector<BBoxInfo> decodeTensor(const int imageIdx, const int imageH,
-                                               const int imageW, const TensorInfo& tensor)
-        = 0;
-
-    inline void addBBoxProposal(const float bx, const float by, const float bw, const float bh,
-                                const uint stride, const float scalingFactor, const float xOffset,
-                                const float yOffset, const int maxIndex, const float maxProb,
-                                std::vector<BBoxInfo>& binfo)
-    {
-        BBoxInfo bbi;
-        bbi.box = convertBBoxNetRes(bx, by, bw, bh, stride, m_InputW, m_InputH);
-        if ((bbi.box.x1 > bbi.box.x2) || (bbi.box.y1 > bbi.box.y2))
-        {
-            return;
-        }
-        convertBBoxImgRes(scalingFactor, xOffset, yOffset, bbi.box);
-        bbi.label = maxIndex;
-        bbi.prob = maxProb;
-        bbi.classId = getClassId(maxIndex);
-        binfo.push_back(bbi);
-    };
+    // nullptr unless an engine cache directory is configured, m_EnginePath is used as is then
+    std::unique_ptr<EngineCache> m_EngineCache;
+    // checksum of m_WtsFilePath for the engine cache key
+    uint64_t m_WeightsChecksum;
+    // nullptr unless an up to date weights cache is configured, released once the engine exists
+    std::unique_ptr<WeightsCache> m_WeightsCache;
 
 private:
     void createYOLOEngine(const nvinfer1::DataType dataType = nvinfer1::DataType::kFLOAT,
                           Int8EntropyCalibrator* calibrator = nullptr);
-    std::vector<std::map<std::string, std::string>> parseConfigFile(const std::string cfgFilePath);
     void parseConfigBlocks();
     void allocateBuffers();
     bool verifyYoloEngine();
     void destroyNetworkUtils(std::vector<nvinfer1::Weights>& trtWeights);
     void writePlanFileToDisk();
+    EngineCacheKey getEngineCacheKey() const;
 };
 
 #endif // _YOLO_H_
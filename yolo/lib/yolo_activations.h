@@ -0,0 +1,76 @@
+/**
+MIT License
+
+Copyright (c) 2018 NVIDIA CORPORATION. All rights reserved.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*
+*/
+
+#ifndef _YOLO_ACTIVATIONS_H_
+#define _YOLO_ACTIVATIONS_H_
+
+#include <cmath>
+#include <stdint.h>
+
+/**
+ * Host versions of the activations the YoloLayerV3 plugin applies on the GPU. They have no CUDA
+ * or TensorRT dependencies, so the raw output decode can be checked on machines without a GPU.
+ */
+
+inline float sigmoid(const float x) { return 1.0f / (1.0f + std::exp(-x)); }
+
+// Inverse of sigmoid. Maps a probability threshold onto the raw network outputs.
+inline float logit(const float p) { return std::log(p / (1.0f - p)); }
+
+// Element-wise activations over contiguous buffers, written as plain loops the compiler can
+// vectorize
+inline void sigmoid(const float* input, float* output, const uint n)
+{
+    for (uint i = 0; i < n; ++i) output[i] = 1.0f / (1.0f + std::exp(-input[i]));
+}
+
+inline void exponential(const float* input, float* output, const uint n)
+{
+    for (uint i = 0; i < n; ++i) output[i] = std::exp(input[i]);
+}
+
+/**
+ * Reference for the gpuYoloLayerV3 kernel on one image: sigmoid on x, y, objectness and the class
+ * scores and exp on w and h. The tensor is channel-major, so every channel is a contiguous plane
+ * of gridW * gridH values and is activated in a single pass.
+ */
+inline void yoloLayerV3Activations(const float* input, float* output, const uint gridW,
+                                   const uint gridH, const uint numClasses, const uint numBBoxes)
+{
+    const uint numGridCells = gridW * gridH;
+    for (uint b = 0; b < numBBoxes; ++b)
+    {
+        for (uint c = 0; c < 5 + numClasses; ++c)
+        {
+            const uint offset = numGridCells * (b * (5 + numClasses) + c);
+            if ((c == 2) || (c == 3))
+                exponential(input + offset, output + offset, numGridCells);
+            else
+                sigmoid(input + offset, output + offset, numGridCells);
+        }
+    }
+}
+
+#endif // _YOLO_ACTIVATIONS_H_
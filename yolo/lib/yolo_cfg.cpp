@@ -0,0 +1,518 @@
+/**
+MIT License
+
+Copyright (c) 2018 NVIDIA CORPORATION. All rights reserved.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*
+*/
+
+#include "yolo_cfg.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <map>
+
+/**
+ * Raw key/value pairs of one cfg section, with the lines they were read from.
+ */
+struct CfgValue
+{
+    std::string value;
+    uint lineNumber;
+};
+
+struct CfgSection
+{
+    std::string type;
+    uint lineNumber;
+    std::map<std::string, CfgValue> values;
+};
+
+static void reportCfgError(const std::string& cfgFilePath, const uint lineNumber,
+                           const std::string& msg)
+{
+    std::cout << cfgFilePath << ":" << lineNumber << ": " << msg << std::endl;
+    assert(0);
+}
+
+static std::string trimBlanks(std::string s)
+{
+    s.erase(s.begin(), std::find_if(s.begin(), s.end(), [](int ch) { return !isspace(ch); }));
+    s.erase(std::find_if(s.rbegin(), s.rend(), [](int ch) { return !isspace(ch); }).base(),
+            s.end());
+    return s;
+}
+
+// Splits a comma separated list such as the layers of a route or the anchors of a yolo layer
+static std::vector<std::string> splitList(const std::string& list)
+{
+    std::vector<std::string> items;
+    size_t begin = 0;
+    while (begin <= list.size())
+    {
+        size_t end = list.find(',', begin);
+        if (end == std::string::npos) end = list.size();
+        const std::string item = trimBlanks(list.substr(begin, end - begin));
+        // tolerate a trailing comma
+        if (!item.empty() || end != list.size()) items.push_back(item);
+        begin = end + 1;
+    }
+    return items;
+}
+
+static bool parseInt(const std::string& s, int& value)
+{
+    char* end = nullptr;
+    const long parsed = std::strtol(s.c_str(), &end, 10);
+    if (s.empty() || *end != '\0') return false;
+    value = static_cast<int>(parsed);
+    return true;
+}
+
+static bool parseFloat(const std::string& s, float& value)
+{
+    char* end = nullptr;
+    value = std::strtof(s.c_str(), &end);
+    return !s.empty() && *end == '\0';
+}
+
+/**
+ * Typed access to the values of a section. Missing or malformed values are reported at the line
+ * they were expected on.
+ */
+class CfgSectionReader
+{
+public:
+    CfgSectionReader(const std::string& cfgFilePath, const CfgSection& section) :
+        m_CfgFilePath(cfgFilePath),
+        m_Section(section)
+    {
+    }
+
+    bool has(const std::string& key) const
+    {
+        return m_Section.values.find(key) != m_Section.values.end();
+    }
+    void error(const std::string& msg) const
+    {
+        reportCfgError(m_CfgFilePath, m_Section.lineNumber, "[" + m_Section.type + "] " + msg);
+    }
+    void error(const std::string& key, const std::string& msg) const
+    {
+        reportCfgError(m_CfgFilePath, get(key).lineNumber, "[" + m_Section.type + "] " + msg);
+    }
+
+    std::string getString(const std::string& key) const { return get(key).value; }
+    std::string getString(const std::string& key, const std::string& defaultValue) const
+    {
+        return has(key) ? getString(key) : defaultValue;
+    }
+    int getInt(const std::string& key) const
+    {
+        int value = 0;
+        if (!parseInt(getString(key), value))
+            error(key, "'" + key + "' expects an integer, got '" + getString(key) + "'");
+        return value;
+    }
+    int getInt(const std::string& key, const int defaultValue) const
+    {
+        return has(key) ? getInt(key) : defaultValue;
+    }
+    uint getPositive(const std::string& key) const
+    {
+        const int value = getInt(key);
+        if (value <= 0)
+            error(key, "'" + key + "' has to be positive, got " + std::to_string(value));
+        return value;
+    }
+    uint getPositive(const std::string& key, const uint defaultValue) const
+    {
+        return has(key) ? getPositive(key) : defaultValue;
+    }
+    std::vector<int> getIntList(const std::string& key) const
+    {
+        std::vector<int> values;
+        for (const std::string& item : splitList(getString(key)))
+        {
+            int value = 0;
+            if (!parseInt(item, value))
+                error(key, "'" + key + "' expects a list of integers, got '" + item + "'");
+            values.push_back(value);
+        }
+        if (values.empty()) error(key, "'" + key + "' is empty");
+        return values;
+    }
+    std::vector<float> getFloatList(const std::string& key) const
+    {
+        std::vector<float> values;
+        for (const std::string& item : splitList(getString(key)))
+        {
+            float value = 0;
+            if (!parseFloat(item, value))
+                error(key, "'" + key + "' expects a list of numbers, got '" + item + "'");
+            values.push_back(value);
+        }
+        if (values.empty()) error(key, "'" + key + "' is empty");
+        return values;
+    }
+
+private:
+    const CfgValue& get(const std::string& key) const
+    {
+        auto it = m_Section.values.find(key);
+        if (it == m_Section.values.end()) error("missing '" + key + "'");
+        return it->second;
+    }
+
+    const std::string& m_CfgFilePath;
+    const CfgSection& m_Section;
+};
+
+static std::string gridToString(const LayerShape& shape)
+{
+    return std::to_string(shape.width) + "x" + std::to_string(shape.height);
+}
+
+static std::vector<CfgSection> readCfgSections(const std::string& cfgFilePath)
+{
+    std::ifstream file(cfgFilePath);
+    if (!file.good())
+    {
+        std::cout << "Unable to open cfg file : " << cfgFilePath << std::endl;
+        assert(0);
+    }
+    std::vector<CfgSection> sections;
+    std::string line;
+    uint lineNumber = 0;
+    while (getline(file, line))
+    {
+        ++lineNumber;
+        line = trimBlanks(line);
+        if (line.empty() || line.front() == '#' || line.front() == ';') continue;
+        if (line.front() == '[')
+        {
+            if (line.back() != ']')
+                reportCfgError(cfgFilePath, lineNumber, "unterminated section header " + line);
+            sections.push_back(
+                CfgSection{trimBlanks(line.substr(1, line.size() - 2)), lineNumber, {}});
+            continue;
+        }
+        const size_t cpos = line.find('=');
+        if (cpos == std::string::npos)
+            reportCfgError(cfgFilePath, lineNumber, "expected key=value, got '" + line + "'");
+        if (sections.empty())
+            reportCfgError(cfgFilePath, lineNumber, "'" + line + "' is outside of any section");
+        const std::string key = trimBlanks(line.substr(0, cpos));
+        const std::string value = trimBlanks(line.substr(cpos + 1));
+        if (key.empty()) reportCfgError(cfgFilePath, lineNumber, "missing key in '" + line + "'");
+        CfgSection& section = sections.back();
+        auto inserted = section.values.insert({key, CfgValue{value, lineNumber}});
+        if (!inserted.second)
+            reportCfgError(cfgFilePath, lineNumber,
+                           "duplicate '" + key + "', first set on line "
+                               + std::to_string(inserted.first->second.lineNumber));
+    }
+    return sections;
+}
+
+static Activation parseActivation(const CfgSectionReader& reader, const std::string& defaultValue)
+{
+    const std::string activation = reader.getString("activation", defaultValue);
+    if (activation == "leaky") return Activation::kLeaky;
+    if (activation != "linear")
+        reader.error("activation", "unsupported activation '" + activation + "'");
+    return Activation::kLinear;
+}
+
+// Resolves a relative (negative) or absolute layer reference made by the layer at layers index
+// current. The referenced layer has to come before limit
+static uint resolveLayerRef(const CfgSectionReader& reader, const std::string& key,
+                            const int ref, const uint current, const uint limit)
+{
+    const int idx = ref < 0 ? static_cast<int>(current) + ref : ref;
+    if (idx < 0 || idx >= static_cast<int>(limit))
+        reader.error(key, "'" + key + "' refers to layer " + std::to_string(ref)
+                         + ", which is out of range");
+    return idx;
+}
+
+static void parseConvolutional(const CfgSectionReader& reader, LayerDesc& layer)
+{
+    ConvParams& conv = layer.conv;
+    conv.filters = reader.getPositive("filters");
+    conv.kernelSize = reader.getPositive("size", 1);
+    conv.stride = reader.getPositive("stride", 1);
+    conv.pad = reader.getInt("pad", 0) ? (conv.kernelSize - 1) / 2 : 0;
+    conv.batchNormalize = reader.getInt("batch_normalize", 0) != 0;
+    conv.activation = parseActivation(reader, "logistic");
+    // the engine only knows conv-bn-leaky and conv-linear blocks
+    if (conv.batchNormalize != (conv.activation == Activation::kLeaky))
+        reader.error("only batch normalized leaky and linear convolutions without batch "
+                     "normalization are supported");
+    if (reader.getInt("groups", 1) != 1)
+        reader.error("groups", "grouped convolutions are not supported");
+    if (std::min(layer.input.height, layer.input.width) + 2 * conv.pad < conv.kernelSize)
+        reader.error("kernel of size " + std::to_string(conv.kernelSize)
+                     + " does not fit a grid of " + gridToString(layer.input));
+
+    layer.output.channels = conv.filters;
+    layer.output.height = (layer.input.height + 2 * conv.pad - conv.kernelSize) / conv.stride + 1;
+    layer.output.width = (layer.input.width + 2 * conv.pad - conv.kernelSize) / conv.stride + 1;
+}
+
+static void parseMaxpool(const CfgSectionReader& reader, LayerDesc& layer)
+{
+    MaxpoolParams& maxpool = layer.maxpool;
+    maxpool.stride = reader.getPositive("stride", 1);
+    maxpool.size = reader.getPositive("size", maxpool.stride);
+    layer.output = layer.input;
+    // size 2 stride 1 layers get same padding and keep their size, see
+    // YoloTinyMaxpoolPaddingFormula
+    if (maxpool.size == 2 && maxpool.stride == 1) return;
+    if (std::min(layer.input.height, layer.input.width) < maxpool.size)
+        reader.error("window of size " + std::to_string(maxpool.size)
+                     + " does not fit a grid of " + gridToString(layer.input));
+    layer.output.height = (layer.input.height - maxpool.size) / maxpool.stride + 1;
+    layer.output.width = (layer.input.width - maxpool.size) / maxpool.stride + 1;
+}
+
+static void parseRoute(const CfgSectionReader& reader, const std::vector<LayerDesc>& layers,
+                       LayerDesc& layer)
+{
+    const uint current = layers.size();
+    layer.output.channels = 0;
+    for (const int ref : reader.getIntList("layers"))
+    {
+        const uint idx = resolveLayerRef(reader, "layers", ref, current, current);
+        const LayerShape& shape = layers.at(idx).output;
+        if (!layer.route.inputs.empty()
+            && (shape.height != layer.output.height || shape.width != layer.output.width))
+            reader.error("layers", "routed layers have different grid sizes");
+        layer.route.inputs.push_back(idx);
+        layer.output.channels += shape.channels;
+        layer.output.height = shape.height;
+        layer.output.width = shape.width;
+    }
+}
+
+static void parseShortcut(const CfgSectionReader& reader, const std::vector<LayerDesc>& layers,
+                          LayerDesc& layer)
+{
+    // the previous layer is the other input of the sum, so from has to reach further back
+    const uint current = layers.size();
+    layer.shortcut.input
+        = resolveLayerRef(reader, "from", reader.getInt("from"), current, current - 1);
+    if (parseActivation(reader, "linear") != Activation::kLinear)
+        reader.error("activation", "only linear shortcuts are supported");
+    const LayerShape& shape = layers.at(layer.shortcut.input).output;
+    if (shape.channels != layer.input.channels || shape.height != layer.input.height
+        || shape.width != layer.input.width)
+        reader.error("from", "shortcut inputs have different shapes");
+    layer.output = layer.input;
+}
+
+static void parseUpsample(const CfgSectionReader& reader, LayerDesc& layer)
+{
+    layer.upsample.stride = reader.getPositive("stride", 2);
+    layer.output = layer.input;
+    layer.output.height *= layer.upsample.stride;
+    layer.output.width *= layer.upsample.stride;
+}
+
+static void parseReorg(const CfgSectionReader& reader, LayerDesc& layer)
+{
+    // the reorg plugin is always created with a stride of 2
+    layer.reorg.stride = reader.getPositive("stride", 1);
+    if (layer.reorg.stride != 2)
+        reader.error("stride", "only reorg layers of stride 2 are supported");
+    if (layer.input.height % layer.reorg.stride != 0 || layer.input.width % layer.reorg.stride != 0)
+        reader.error("grid of " + gridToString(layer.input) + " is not divisible by the stride");
+    layer.output.channels = layer.input.channels * layer.reorg.stride * layer.reorg.stride;
+    layer.output.height = layer.input.height / layer.reorg.stride;
+    layer.output.width = layer.input.width / layer.reorg.stride;
+}
+
+static void parseDetection(const CfgSectionReader& reader, const NetworkDesc& network,
+                           LayerDesc& layer)
+{
+    DetectionParams& detection = layer.detection;
+    detection.numClasses = reader.getPositive("classes");
+    const uint num = reader.getPositive("num");
+    detection.anchors = reader.getFloatList("anchors");
+    if (detection.anchors.size() != 2 * num)
+        reader.error("anchors", "expected " + std::to_string(num) + " anchor pairs, got "
+                         + std::to_string(detection.anchors.size()) + " values");
+
+    if (layer.type == LayerType::kYolo)
+    {
+        if (reader.has("mask"))
+        {
+            for (const int mask : reader.getIntList("mask"))
+            {
+                if (mask < 0 || mask >= static_cast<int>(num))
+                    reader.error("mask", "mask " + std::to_string(mask) + " is not an anchor");
+                detection.masks.push_back(mask);
+            }
+        }
+        else
+        {
+            for (uint i = 0; i < num; ++i) detection.masks.push_back(i);
+        }
+        detection.numBBoxes = detection.masks.size();
+    }
+    else
+    {
+        if (reader.getInt("coords", 4) != 4)
+            reader.error("coords", "only region layers with 4 coords are supported");
+        detection.numBBoxes = num;
+    }
+
+    // boxes are scaled back to the input with a single stride
+    if (network.inputW * layer.input.height != network.inputH * layer.input.width)
+        reader.error("grid of " + gridToString(layer.input)
+                     + " does not have the aspect ratio of the input, "
+                     + std::to_string(network.inputW) + "x" + std::to_string(network.inputH)
+                     + " is not divisible by the network stride");
+
+    const uint expectedChannels = detection.numBBoxes * (5 + detection.numClasses);
+    if (layer.input.channels != expectedChannels)
+        reader.error("expects " + std::to_string(expectedChannels)
+                     + " input channels, the previous layer has "
+                     + std::to_string(layer.input.channels));
+    layer.output = layer.input;
+}
+
+const char* getLayerTypeName(const LayerType type)
+{
+    switch (type)
+    {
+    case LayerType::kConvolutional: return "convolutional";
+    case LayerType::kMaxpool: return "maxpool";
+    case LayerType::kRoute: return "route";
+    case LayerType::kShortcut: return "shortcut";
+    case LayerType::kUpsample: return "upsample";
+    case LayerType::kYolo: return "yolo";
+    case LayerType::kRegion: return "region";
+    case LayerType::kReorg: return "reorg";
+    }
+    return "unknown";
+}
+
+NetworkDesc parseNetworkCfg(const std::string cfgFilePath, const uint inputW, const uint inputH)
+{
+    const std::vector<CfgSection> sections = readCfgSections(cfgFilePath);
+    if (sections.empty() || (sections.front().type != "net" && sections.front().type != "network"))
+        reportCfgError(cfgFilePath, sections.empty() ? 0 : sections.front().lineNumber,
+                       "the first section has to be [net]");
+
+    NetworkDesc network;
+    network.cfgFilePath = cfgFilePath;
+    const CfgSectionReader net(cfgFilePath, sections.front());
+    network.inputW = net.getPositive("width");
+    network.inputH = net.getPositive("height");
+    network.inputC = net.getPositive("channels");
+    if (inputW > 0) network.inputW = inputW;
+    if (inputH > 0) network.inputH = inputH;
+
+    static const std::map<std::string, LayerType> kLayerTypes
+        = {{"convolutional", LayerType::kConvolutional},
+           {"maxpool", LayerType::kMaxpool},
+           {"route", LayerType::kRoute},
+           {"shortcut", LayerType::kShortcut},
+           {"upsample", LayerType::kUpsample},
+           {"yolo", LayerType::kYolo},
+           {"region", LayerType::kRegion},
+           {"reorg", LayerType::kReorg}};
+
+    LayerShape shape{network.inputC, network.inputH, network.inputW};
+    bool hasOutput = false;
+    for (uint i = 1; i < sections.size(); ++i)
+    {
+        const CfgSection& section = sections.at(i);
+        const CfgSectionReader reader(cfgFilePath, section);
+        auto type = kLayerTypes.find(section.type);
+        if (type == kLayerTypes.end()) reader.error("unsupported layer type");
+
+        LayerDesc layer{};
+        layer.type = type->second;
+        layer.layerIdx = i;
+        layer.lineNumber = section.lineNumber;
+        layer.input = shape;
+        switch (layer.type)
+        {
+        case LayerType::kConvolutional: parseConvolutional(reader, layer); break;
+        case LayerType::kMaxpool: parseMaxpool(reader, layer); break;
+        case LayerType::kRoute: parseRoute(reader, network.layers, layer); break;
+        case LayerType::kShortcut: parseShortcut(reader, network.layers, layer); break;
+        case LayerType::kUpsample: parseUpsample(reader, layer); break;
+        case LayerType::kReorg: parseReorg(reader, layer); break;
+        case LayerType::kYolo:
+        case LayerType::kRegion:
+            parseDetection(reader, network, layer);
+            hasOutput = true;
+            break;
+        }
+        shape = layer.output;
+        network.layers.push_back(layer);
+    }
+    if (!hasOutput) net.error("the network has no yolo or region layer");
+    return network;
+}
+
+std::vector<ConvLayerInfo> getConvLayers(const NetworkDesc& network)
+{
+    std::vector<ConvLayerInfo> convLayers;
+    for (const LayerDesc& layer : network.layers)
+    {
+        if (layer.type != LayerType::kConvolutional) continue;
+        ConvLayerInfo conv;
+        conv.layerIdx = layer.layerIdx;
+        conv.batchNormalize = layer.conv.batchNormalize;
+        conv.filters = layer.conv.filters;
+        conv.inputChannels = layer.input.channels;
+        conv.kernelSize = layer.conv.kernelSize;
+        convLayers.push_back(conv);
+    }
+    return convLayers;
+}
+
+std::vector<OutputLayerInfo> getOutputLayers(const NetworkDesc& network)
+{
+    std::vector<OutputLayerInfo> outputLayers;
+    for (const LayerDesc& layer : network.layers)
+    {
+        if ((layer.type != LayerType::kYolo) && (layer.type != LayerType::kRegion)) continue;
+        OutputLayerInfo output;
+        output.layerIdx = layer.layerIdx;
+        output.blobName = getLayerTypeName(layer.type) + std::string("_")
+            + std::to_string(layer.layerIdx);
+        output.gridW = layer.output.width;
+        output.gridH = layer.output.height;
+        output.stride = network.inputW / output.gridW;
+        output.numBBoxes = layer.detection.numBBoxes;
+        output.numClasses = layer.detection.numClasses;
+        output.volume = layer.output.volume();
+        outputLayers.push_back(output);
+    }
+    return outputLayers;
+}
@@ -0,0 +1,213 @@
+/**
+MIT License
+
+Copyright (c) 2018 NVIDIA CORPORATION. All rights reserved.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*
+*/
+
+#ifndef _YOLO_CFG_H_
+#define _YOLO_CFG_H_
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+/**
+ * Darknet cfg helpers that need neither TensorRT nor CUDA, so they can be shared by the
+ * engine builder and the offline tools.
+ *
+ * The cfg is parsed and validated once into a NetworkDesc, a flat array of typed layers. Errors
+ * are reported with the cfg line they come from.
+ */
+
+enum class LayerType : uint8_t
+{
+    kConvolutional,
+    kMaxpool,
+    kRoute,
+    kShortcut,
+    kUpsample,
+    kYolo,
+    kRegion,
+    kReorg
+};
+
+enum class Activation : uint8_t
+{
+    kLinear,
+    kLeaky
+};
+
+/**
+ * Output of a layer, as the engine builder will lay it out (CHW).
+ */
+struct LayerShape
+{
+    uint channels;
+    uint height;
+    uint width;
+
+    uint64_t volume() const { return static_cast<uint64_t>(channels) * height * width; }
+};
+
+struct ConvParams
+{
+    uint filters;
+    uint kernelSize;
+    uint stride;
+    // padding in pixels, already derived from the cfg's pad flag
+    uint pad;
+    bool batchNormalize;
+    Activation activation;
+};
+
+struct MaxpoolParams
+{
+    uint size;
+    uint stride;
+};
+
+struct RouteParams
+{
+    // indices into NetworkDesc::layers, concatenated along the channels in this order
+    std::vector<uint> inputs;
+};
+
+struct ShortcutParams
+{
+    // index into NetworkDesc::layers of the layer added to the previous one
+    uint input;
+};
+
+struct UpsampleParams
+{
+    uint stride;
+};
+
+struct ReorgParams
+{
+    uint stride;
+};
+
+/**
+ * Parameters shared by yolo and region layers.
+ */
+struct DetectionParams
+{
+    uint numClasses;
+    uint numBBoxes;
+    // anchor (w, h) pairs as written in the cfg
+    std::vector<float> anchors;
+    // anchors used by a yolo layer, empty for region layers
+    std::vector<uint> masks;
+};
+
+/**
+ * One layer of the network. Only the params matching the type are meaningful.
+ */
+struct LayerDesc
+{
+    LayerType type;
+    // index of the block in the cfg, [net] being block 0
+    uint layerIdx;
+    // line of the section header in the cfg
+    uint lineNumber;
+    LayerShape input;
+    LayerShape output;
+
+    ConvParams conv;
+    MaxpoolParams maxpool;
+    RouteParams route;
+    ShortcutParams shortcut;
+    UpsampleParams upsample;
+    ReorgParams reorg;
+    DetectionParams detection;
+};
+
+/**
+ * A parsed and validated darknet cfg. layers.at(k) is block k + 1, which is how route and
+ * shortcut layers refer to it.
+ */
+struct NetworkDesc
+{
+    std::string cfgFilePath;
+    uint inputC;
+    uint inputH;
+    uint inputW;
+    std::vector<LayerDesc> layers;
+
+    const LayerDesc& getLayer(const uint layerIdx) const { return layers.at(layerIdx - 1); }
+};
+
+/**
+ * Shape of a convolutional layer as far as its darknet weights are concerned.
+ */
+struct ConvLayerInfo
+{
+    // index of the block in the parsed cfg, [net] being block 0
+    uint layerIdx;
+    bool batchNormalize;
+    uint filters;
+    uint inputChannels;
+    uint kernelSize;
+
+    // per filter volume of the kernel (CRS)
+    uint64_t kernelVolume() const
+    {
+        return static_cast<uint64_t>(inputChannels) * kernelSize * kernelSize;
+    }
+    // number of floats the layer occupies in a darknet .weights file
+    uint64_t numDarknetWeights() const
+    {
+        return filters * kernelVolume() + (batchNormalize ? 4 * filters : filters);
+    }
+};
+
+/**
+ * Output tensor of a yolo or region layer, everything the decoders need to know about it that
+ * does not depend on the built engine.
+ */
+struct OutputLayerInfo
+{
+    // index of the block in the parsed cfg, [net] being block 0
+    uint layerIdx;
+    std::string blobName;
+    uint gridW;
+    uint gridH;
+    // same along both axes
+    uint stride;
+    uint numBBoxes;
+    uint numClasses;
+    uint64_t volume;
+};
+
+// Section name of a layer type in a darknet cfg
+const char* getLayerTypeName(const LayerType type);
+// Parses and validates a darknet cfg. Malformed or unsupported cfgs are reported as
+// <cfg>:<line>: <reason>. A non zero inputW or inputH replaces the width or height of the cfg
+NetworkDesc parseNetworkCfg(const std::string cfgFilePath, const uint inputW = 0,
+                            const uint inputH = 0);
+// Returns every convolutional layer in order
+std::vector<ConvLayerInfo> getConvLayers(const NetworkDesc& network);
+// Returns every yolo and region layer in order
+std::vector<OutputLayerInfo> getOutputLayers(const NetworkDesc& network);
+
+#endif // _YOLO_CFG_H_
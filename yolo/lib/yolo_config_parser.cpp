@@ -27,6 +27,7 @@ SOFTWARE.
 
 #include <assert.h>
 #include <iostream>
+#include <sstream>
 
 DEFINE_string(network_type, "not-specified",
               "[REQUIRED] Type of network architecture. Choose from yolov2, yolov2-tiny, "
@@ -44,6 +45,18 @@ DEFINE_string(calibration_table_path, "not-specified",
 DEFINE_string(engine_file_path, "not-specified",
               "[OPTIONAL] Path to pre-generated engine(PLAN) file. If flag is not set, a new "
               "engine <network-type>-<precision>-<batch-size>.engine will be generated");
+DEFINE_string(weights_cache_path, "not-specified",
+              "[OPTIONAL] Pre-packed conv weights generated from config_file_path and "
+              "wts_file_path by yolo-weights-cache. If set and up to date, engine builds read "
+              "the folded conv layers from it instead of the darknet weights file");
+DEFINE_string(engine_cache_dir, "not-specified",
+              "[OPTIONAL] Directory of engines keyed by a hash of the cfg, weights, calibration "
+              "table, precision, batch size, device type and TensorRT version. If set, it "
+              "replaces engine_file_path and a change to any of them builds a new engine "
+              "instead of reusing a stale one");
+DEFINE_uint64(engine_cache_max_size_mb, 0,
+              "[OPTIONAL] Size cap of engine_cache_dir. Least recently used engines are evicted "
+              "when a new one does not fit. 0 means no limit");
 DEFINE_string(input_blob_name, "data",
               "[OPTIONAL] Name of the input layer in the tensorRT engine file");
 DEFINE_bool(print_perf_info, false, "[OPTIONAl] Print performance info on the console");
@@ -67,6 +80,32 @@ DEFINE_string(calibration_images_path, "not-specified",
 DEFINE_uint64(batch_size, 1, "[OPTIONAL] Batch size for the inference engine.");
 DEFINE_double(prob_thresh, 0.5, "[OPTIONAL] Probability threshold for detected objects");
 DEFINE_double(nms_thresh, 0.5, "[OPTIONAL] IOU threshold for bounding box candidates");
+DEFINE_uint64(pre_nms_top_k, 0,
+              "[OPTIONAL] Number of highest-probability candidates per image passed on to NMS. "
+              "0 passes all of them");
+DEFINE_uint64(max_detections, 0,
+              "[OPTIONAL] Maximum number of detections per image kept after NMS. 0 keeps all of "
+              "them");
+DEFINE_string(nms_engine, "greedy",
+              "[OPTIONAL] NMS implementation. Choose from greedy, grid and simd. grid only "
+              "compares boxes against their spatial neighbours, simd compares them against 8 or "
+              "16 kept boxes at a time. Both keep the same detections as greedy");
+DEFINE_bool(batched_nms, false,
+            "[OPTIONAL] Run NMS on all classes in a single pass over one sort of the detections "
+            "instead of bucketing and sorting them per class. Keeps the same detections");
+DEFINE_string(nms_type, "hard",
+              "[OPTIONAL] Suppression rule. Choose from hard, soft_linear, soft_gaussian and "
+              "diou. nms_engine only applies to hard");
+DEFINE_bool(logit_decode, false,
+            "[OPTIONAL] yolov3 and yolov3-tiny only. yolo layers return the raw conv outputs and "
+            "the host applies sigmoid/exp only to the cells whose objectness passes prob_thresh. "
+            "Engines built with this flag get a -logit suffix. Ignored for yolov2 and yolov2-tiny");
+DEFINE_string(letterbox_filter, "cubic",
+              "[OPTIONAL] Filter used to resize images into the network input. Choose from "
+              "cubic and bilinear. cubic uses the taps of OpenCV INTER_CUBIC as before the "
+              "letterbox was fused, bilinear is faster but its accuracy is not measured yet");
+DEFINE_double(soft_nms_sigma, 0.5,
+              "[OPTIONAL] Width of the score decay used when nms_type is soft_gaussian");
 DEFINE_bool(do_benchmark, false,
             "[OPTIONAL] Generate JSON file with detection info in coco benchmark format");
 DEFINE_bool(save_detections, false,
@@ -79,12 +118,61 @@ DEFINE_bool(
     decode, true,
     "[OPTIONAL] Decode the detections. This can be set to false if benchmarking network for "
     "throughput only");
+DEFINE_bool(reduced_jpeg_decode, false,
+            "[OPTIONAL] Decode test JPEGs at the largest 1/2, 1/4 or 1/8 scale that still covers "
+            "the letterboxed network input. Detections keep the original image size, saved and "
+            "viewed images are at the decoded size");
+DEFINE_uint64(load_threads, 2,
+              "[OPTIONAL] Number of trt-yolo-app threads reading and decoding test images");
+DEFINE_uint64(preprocess_threads, 1,
+              "[OPTIONAL] Number of trt-yolo-app threads letterboxing loaded batches into "
+              "network input blobs");
+DEFINE_uint64(post_threads, 1,
+              "[OPTIONAL] Number of trt-yolo-app threads running NMS and drawing detections");
+DEFINE_uint64(pipeline_depth, 2,
+              "[OPTIONAL] Number of batches trt-yolo-app queues between two pipeline stages");
+DEFINE_uint64(pre_process_workers, 1,
+              "[OPTIONAL] Number of threads letterboxing the images of a batch in parallel, in "
+              "the yolo plugin and in each trt-yolo-app preprocess thread. 1 letterboxes them "
+              "one after the other on the calling thread");
+DEFINE_uint64(post_process_workers, 1,
+              "[OPTIONAL] Number of threads the yolo plugin uses to decode and run NMS on the "
+              "images of a batch in parallel. 1 runs post-processing on the streaming thread");
+DEFINE_string(batch_buckets, "not-specified",
+              "[OPTIONAL] Comma separated batch sizes the yolo plugin builds an engine for each, "
+              "e.g. 1,2,4,8. Every batch runs on the smallest one that holds its filled frames. "
+              "Sizes above the pipeline batch size are dropped and the pipeline batch size is "
+              "always added. Not set builds a single engine at the pipeline batch size");
+DEFINE_string(input_sizes, "not-specified",
+              "[OPTIONAL] Comma separated input sizes to build an engine for each, given as "
+              "<size> or <width>x<height>, e.g. 320,416,608. Not set builds a single engine at "
+              "the size of the cfg");
+DEFINE_double(latency_slo_ms, 0.0,
+              "[OPTIONAL] Per batch inference + post-processing latency target of the yolo "
+              "plugin. With several input_sizes, batches switch to a smaller engine when it is "
+              "exceeded and back to a larger one when there is headroom. 0 disables switching");
+DEFINE_double(slo_headroom, 0.8,
+              "[OPTIONAL] Fraction of latency_slo_ms a larger engine is predicted to stay under "
+              "before the yolo plugin switches to it");
+DEFINE_uint64(slo_window, 8,
+              "[OPTIONAL] Number of batches the yolo plugin averages before each resolution "
+              "switching decision");
 DEFINE_uint64(seed, std::time(0), "[OPTIONAL] Seed for the random number generator");
 DEFINE_bool(shuffle_test_set, false,
             "[OPTIONAL] Shuffle the test set images before running inference");
 
 static bool isFlagDefault(std::string flag) { return flag == "not-specified" ? true : false; }
 
+static std::string getDefaultEnginePath(const uint batchSize)
+{
+    int npos = FLAGS_wts_file_path.find(".weights");
+    assert(npos != std::string::npos
+           && "wts file file not recognised. File needs to be of '.weights' format");
+    std::string dataPath = FLAGS_wts_file_path.substr(0, npos);
+    return dataPath + "-" + FLAGS_precision + "-" + FLAGS_deviceType + "-batch"
+        + std::to_string(batchSize) + (FLAGS_logit_decode ? "-logit" : "") + ".engine";
+}
+
 static bool networkTypeValidator(const char* flagName, std::string value)
 {
     if (((FLAGS_network_type) == "yolov2") || ((FLAGS_network_type) == "yolov2-tiny")
@@ -107,6 +195,35 @@ static bool precisionTypeValidator(const char* flagName, std::string value)
     return false;
 }
 
+static bool nmsEngineValidator(const char* flagName, std::string value)
+{
+    if ((FLAGS_nms_engine == "greedy") || (FLAGS_nms_engine == "grid")
+        || (FLAGS_nms_engine == "simd"))
+        return true;
+    else
+        std::cout << "Invalid value for --" << flagName << ": " << value << std::endl;
+    return false;
+}
+
+static bool nmsTypeValidator(const char* flagName, std::string value)
+{
+    if ((FLAGS_nms_type == "hard") || (FLAGS_nms_type == "soft_linear")
+        || (FLAGS_nms_type == "soft_gaussian") || (FLAGS_nms_type == "diou"))
+        return true;
+    else
+        std::cout << "Invalid value for --" << flagName << ": " << value << std::endl;
+    return false;
+}
+
+static bool letterboxFilterValidator(const char* flagName, std::string value)
+{
+    if ((FLAGS_letterbox_filter == "bilinear") || (FLAGS_letterbox_filter == "cubic"))
+        return true;
+    else
+        std::cout << "Invalid value for --" << flagName << ": " << value << std::endl;
+    return false;
+}
+
 static bool verifyRequiredFlags()
 {
     assert(!isFlagDefault(FLAGS_network_type)
@@ -121,7 +238,10 @@ static bool verifyRequiredFlags()
     assert((FLAGS_config_file_path.find(".cfg") != std::string::npos)
            && "config file not recognised. File needs to be of '.cfg' format");
     if (!(networkTypeValidator("network_type", FLAGS_network_type)
-          && precisionTypeValidator("precision", FLAGS_precision)))
+          && precisionTypeValidator("precision", FLAGS_precision)
+          && nmsEngineValidator("nms_engine", FLAGS_nms_engine)
+          && nmsTypeValidator("nms_type", FLAGS_nms_type)
+          && letterboxFilterValidator("letterbox_filter", FLAGS_letterbox_filter)))
         return false;
 
     return true;
@@ -132,19 +252,20 @@ void yoloConfigParserInit(int argc, char** argv)
     gflags::ParseCommandLineFlags(&argc, &argv, false);
     assert(verifyRequiredFlags());
 
+    // region layers have no raw output mode, so yolov2 engines are built and named as usual
+    if (FLAGS_logit_decode && (FLAGS_network_type.find("yolov2") == 0))
+    {
+        std::cerr << "WARNING: --logit_decode only applies to yolov3 and yolov3-tiny, ignored for "
+                  << FLAGS_network_type << std::endl;
+        FLAGS_logit_decode = false;
+    }
+
     FLAGS_calibration_images_path
         = isFlagDefault(FLAGS_calibration_images_path) ? "" : FLAGS_calibration_images_path;
     FLAGS_test_images_path = isFlagDefault(FLAGS_test_images_path) ? "" : FLAGS_test_images_path;
 
     if (isFlagDefault(FLAGS_engine_file_path))
-    {
-        int npos = FLAGS_wts_file_path.find(".weights");
-        assert(npos != std::string::npos
-               && "wts file file not recognised. File needs to be of '.weights' format");
-        std::string dataPath = FLAGS_wts_file_path.substr(0, npos);
-        FLAGS_engine_file_path = dataPath + "-" + FLAGS_precision + "-" + FLAGS_deviceType + "-batch"
-            + std::to_string(FLAGS_batch_size) + ".engine";
-    }
+        FLAGS_engine_file_path = getDefaultEnginePath(FLAGS_batch_size);
 
     if (isFlagDefault(FLAGS_calibration_table_path))
     {
@@ -160,15 +281,28 @@ NetworkInfo getYoloNetworkInfo()
 {
     return NetworkInfo{FLAGS_network_type,     FLAGS_config_file_path, FLAGS_wts_file_path,
                        FLAGS_labels_file_path, FLAGS_precision,        FLAGS_deviceType,
-                       FLAGS_calibration_table_path, FLAGS_engine_file_path, FLAGS_input_blob_name};
+                       FLAGS_calibration_table_path, FLAGS_engine_file_path, FLAGS_input_blob_name,
+                       FLAGS_weights_cache_path, FLAGS_engine_cache_dir,
+                       FLAGS_engine_cache_max_size_mb, 0, 0};
 }
 
 InferParams getYoloInferParams()
 {
 
-    return InferParams{FLAGS_print_perf_info,    FLAGS_print_prediction_info,
-                       FLAGS_calibration_images, FLAGS_calibration_images_path,
-                       FLAGS_prob_thresh,        FLAGS_nms_thresh};
+    return InferParams{FLAGS_print_perf_info,
+                       FLAGS_print_prediction_info,
+                       FLAGS_calibration_images,
+                       FLAGS_calibration_images_path,
+                       static_cast<float>(FLAGS_prob_thresh),
+                       static_cast<float>(FLAGS_nms_thresh),
+                       static_cast<uint>(FLAGS_pre_nms_top_k),
+                       static_cast<uint>(FLAGS_max_detections),
+                       FLAGS_nms_engine,
+                       FLAGS_batched_nms,
+                       FLAGS_nms_type,
+                       static_cast<float>(FLAGS_soft_nms_sigma),
+                       FLAGS_logit_decode,
+                       FLAGS_letterbox_filter};
 }
 
 uint64_t getSeed() { return FLAGS_seed; }
@@ -202,4 +336,70 @@ std::string getSaveDetectionsPath() { return FLAGS_save_detections_path; }
 
 uint getBatchSize() { return FLAGS_batch_size; }
 
+uint getPreProcessWorkers() { return FLAGS_pre_process_workers; }
+uint getPostProcessWorkers() { return FLAGS_post_process_workers; }
+
+NetworkInfo getYoloNetworkInfo(const uint batchSize)
+{
+    NetworkInfo networkInfo = getYoloNetworkInfo();
+    if (batchSize != FLAGS_batch_size) networkInfo.enginePath = getDefaultEnginePath(batchSize);
+    return networkInfo;
+}
+
+std::vector<uint> getBatchBuckets()
+{
+    std::vector<uint> batchBuckets;
+    if (isFlagDefault(FLAGS_batch_buckets)) return batchBuckets;
+
+    std::stringstream ss(FLAGS_batch_buckets);
+    std::string batchSize;
+    while (std::getline(ss, batchSize, ','))
+    {
+        if (batchSize.empty() || (batchSize.find_first_not_of("0123456789") != std::string::npos)
+            || (std::stoul(batchSize) == 0))
+        {
+            std::cout << "Invalid value for --batch_buckets: " << FLAGS_batch_buckets << std::endl;
+            assert(0);
+        }
+        batchBuckets.push_back(std::stoul(batchSize));
+    }
+    return batchBuckets;
+}
+
+std::vector<std::pair<uint, uint>> getInputSizes()
+{
+    std::vector<std::pair<uint, uint>> inputSizes;
+    if (isFlagDefault(FLAGS_input_sizes)) return inputSizes;
+
+    std::stringstream ss(FLAGS_input_sizes);
+    std::string size;
+    while (std::getline(ss, size, ','))
+    {
+        const size_t sep = size.find('x');
+        const std::string width = size.substr(0, sep);
+        const std::string height = sep == std::string::npos ? width : size.substr(sep + 1);
+        if (width.empty() || height.empty()
+            || (width.find_first_not_of("0123456789") != std::string::npos)
+            || (height.find_first_not_of("0123456789") != std::string::npos))
+        {
+            std::cout << "Invalid value for --input_sizes: " << FLAGS_input_sizes << std::endl;
+            assert(0);
+        }
+        inputSizes.push_back({std::stoul(width), std::stoul(height)});
+    }
+    return inputSizes;
+}
+
+ResolutionControllerParams getResolutionControllerParams()
+{
+    return ResolutionControllerParams{static_cast<float>(FLAGS_latency_slo_ms),
+                                      static_cast<float>(FLAGS_slo_headroom),
+                                      static_cast<uint>(FLAGS_slo_window)};
+}
+
 bool getShuffleTestSet() { return FLAGS_shuffle_test_set; }
+bool getReducedJpegDecode() { return FLAGS_reduced_jpeg_decode; }
+uint getLoadThreads() { return FLAGS_load_threads; }
+uint getPreprocessThreads() { return FLAGS_preprocess_threads; }
+uint getPostThreads() { return FLAGS_post_threads; }
+uint getPipelineDepth() { return FLAGS_pipeline_depth; }
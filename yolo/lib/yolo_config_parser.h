@@ -26,15 +26,20 @@ SOFTWARE.
 #ifndef _YOLO_CONFIG_PARSER_
 #define _YOLO_CONFIG_PARSER_
 
+#include "resolution_controller.h"
 #include "yolo.h"
 
 #include <ctime>
 #include <gflags/gflags.h>
+#include <utility>
+#include <vector>
 
 // Init to be called at the very beginning to verify all config params are valid
 void yoloConfigParserInit(int argc, char** argv);
 
 NetworkInfo getYoloNetworkInfo();
+// Same as above, with the engine path of an engine built for batchSize
+NetworkInfo getYoloNetworkInfo(const uint batchSize);
 InferParams getYoloInferParams();
 uint64_t getSeed();
 std::string getNetworkType();
@@ -47,6 +52,19 @@ bool getViewDetections();
 bool getSaveDetections();
 std::string getSaveDetectionsPath();
 uint getBatchSize();
+uint getPreProcessWorkers();
+uint getPostProcessWorkers();
+// Empty unless batch_buckets is set
+std::vector<uint> getBatchBuckets();
+// Empty unless input_sizes is set, entries are {width, height}
+std::vector<std::pair<uint, uint>> getInputSizes();
+ResolutionControllerParams getResolutionControllerParams();
 bool getShuffleTestSet();
+bool getReducedJpegDecode();
+// Thread counts and queue depth of the trt-yolo-app pipeline
+uint getLoadThreads();
+uint getPreprocessThreads();
+uint getPostThreads();
+uint getPipelineDepth();
 
 #endif //_YOLO_CONFIG_PARSER_
\ No newline at end of file
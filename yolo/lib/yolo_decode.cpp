@@ -0,0 +1,286 @@
+/**
+MIT License
+
+Copyright (c) 2018 NVIDIA CORPORATION. All rights reserved.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*
+*/
+
+#include "yolo_decode.h"
+#include "yolo_activations.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <iostream>
+
+BBox convertBBoxNetRes(const float& bx, const float& by, const float& bw, const float& bh,
+                       const uint& stride, const uint& netW, const uint& netH)
+{
+    BBox b;
+    // Restore coordinates to network input resolution
+    float x = bx * stride;
+    float y = by * stride;
+
+    b.x1 = x - bw / 2;
+    b.x2 = x + bw / 2;
+
+    b.y1 = y - bh / 2;
+    b.y2 = y + bh / 2;
+
+    b.x1 = std::min(static_cast<float>(netW), std::max(0.0f, b.x1));
+    b.x2 = std::min(static_cast<float>(netW), std::max(0.0f, b.x2));
+    b.y1 = std::min(static_cast<float>(netH), std::max(0.0f, b.y1));
+    b.y2 = std::min(static_cast<float>(netH), std::max(0.0f, b.y2));
+
+    return b;
+}
+
+void convertBBoxImgRes(const float scalingFactor, const float& xOffset, const float& yOffset,
+                       BBox& bbox)
+{
+    // Undo Letterbox
+    bbox.x1 -= xOffset;
+    bbox.x2 -= xOffset;
+    bbox.y1 -= yOffset;
+    bbox.y2 -= yOffset;
+
+    // Restore to input resolution
+    bbox.x1 /= scalingFactor;
+    bbox.x2 /= scalingFactor;
+    bbox.y1 /= scalingFactor;
+    bbox.y2 /= scalingFactor;
+}
+
+/**
+ * Scale and offsets of the letterbox the image was fitted into the network input with.
+ */
+struct LetterboxGeometry
+{
+    explicit LetterboxGeometry(const DecodeParams& params) :
+        scalingFactor(std::min(static_cast<float>(params.inputW) / params.imageW,
+                               static_cast<float>(params.inputH) / params.imageH)),
+        xOffset((params.inputW - scalingFactor * params.imageW) / 2),
+        yOffset((params.inputH - scalingFactor * params.imageH) / 2)
+    {
+    }
+    const float scalingFactor;
+    const float xOffset;
+    const float yOffset;
+};
+
+static inline void addBBoxProposal(const float bx, const float by, const float bw,
+                                   const float bh, const uint stride,
+                                   const LetterboxGeometry& letterbox, const int maxIndex,
+                                   const float maxProb, const DecodeParams& params,
+                                   std::vector<BBoxInfo>& binfo)
+{
+    BBoxInfo bbi;
+    bbi.box = convertBBoxNetRes(bx, by, bw, bh, stride, params.inputW, params.inputH);
+    if ((bbi.box.x1 > bbi.box.x2) || (bbi.box.y1 > bbi.box.y2))
+    {
+        return;
+    }
+    convertBBoxImgRes(letterbox.scalingFactor, letterbox.xOffset, letterbox.yOffset, bbi.box);
+    bbi.label = maxIndex;
+    bbi.prob = maxProb;
+    bbi.classId = params.classIds[maxIndex];
+    binfo.push_back(bbi);
+}
+
+// Decoder of region layers
+static void decodeRegionTensor(const TensorInfo& tensor, const float* detections,
+                               const DecodeParams& params, std::vector<BBoxInfo>& binfo)
+{
+    const LetterboxGeometry letterbox(params);
+    const uint numGridCells = tensor.gridW * tensor.gridH;
+    const uint numChannels = 5 + tensor.numClasses;
+
+    for (uint y = 0; y < tensor.gridH; y++)
+    {
+        for (uint x = 0; x < tensor.gridW; x++)
+        {
+            const int bbindex = y * tensor.gridW + x;
+            for (uint b = 0; b < tensor.numBBoxes; b++)
+            {
+                const float* anchorDetections
+                    = detections + bbindex + numGridCells * (b * numChannels);
+
+                // Softmaxed class probabilities never exceed 1, so a cell whose objectness alone
+                // can't clear the threshold is skipped before the exp() and class scan
+                const float objectness = anchorDetections[numGridCells * 4];
+                if (objectness <= params.probThresh) continue;
+
+                int maxIndex = -1;
+                float maxProb = findMaxClassProb(anchorDetections + numGridCells * 5,
+                                                 numGridCells, tensor.numClasses, maxIndex);
+                maxProb = objectness * maxProb;
+
+                if (maxProb > params.probThresh)
+                {
+                    const float pw = tensor.anchors[2 * b];
+                    const float ph = tensor.anchors[2 * b + 1];
+
+                    const float bx = x + anchorDetections[0];
+                    const float by = y + anchorDetections[numGridCells * 1];
+                    const float bw = pw * std::exp(anchorDetections[numGridCells * 2]);
+                    const float bh = ph * std::exp(anchorDetections[numGridCells * 3]);
+
+                    addBBoxProposal(bx, by, bw, bh, tensor.stride, letterbox, maxIndex, maxProb,
+                                    params, binfo);
+                }
+            }
+        }
+    }
+}
+
+// Decoder of yolo layers
+static void decodeYoloTensor(const TensorInfo& tensor, const float* detections,
+                             const DecodeParams& params, std::vector<BBoxInfo>& binfo)
+{
+    const LetterboxGeometry letterbox(params);
+    const uint numGridCells = tensor.gridW * tensor.gridH;
+    const uint numChannels = 5 + tensor.numClasses;
+
+    for (uint y = 0; y < tensor.gridH; ++y)
+    {
+        for (uint x = 0; x < tensor.gridW; ++x)
+        {
+            const int bbindex = y * tensor.gridW + x;
+            for (uint b = 0; b < tensor.numBBoxes; ++b)
+            {
+                const float* anchorDetections
+                    = detections + bbindex + numGridCells * (b * numChannels);
+
+                // Class probabilities never exceed 1, so a cell whose objectness alone can't
+                // clear the threshold is skipped before any box or class work is done
+                const float objectness = anchorDetections[numGridCells * 4];
+                if (objectness <= params.probThresh) continue;
+
+                int maxIndex = -1;
+                float maxProb = findMaxClassProb(anchorDetections + numGridCells * 5,
+                                                 numGridCells, tensor.numClasses, maxIndex);
+                maxProb = objectness * maxProb;
+
+                if (maxProb > params.probThresh)
+                {
+                    const float pw = tensor.anchors[tensor.masks[b] * 2];
+                    const float ph = tensor.anchors[tensor.masks[b] * 2 + 1];
+
+                    const float bx = x + anchorDetections[0];
+                    const float by = y + anchorDetections[numGridCells * 1];
+                    const float bw = pw * anchorDetections[numGridCells * 2];
+                    const float bh = ph * anchorDetections[numGridCells * 3];
+
+                    addBBoxProposal(bx, by, bw, bh, tensor.stride, letterbox, maxIndex, maxProb,
+                                    params, binfo);
+                }
+            }
+        }
+    }
+}
+
+// Decoder of yolo layers holding raw conv outputs, see --logit_decode
+static void decodeRawYoloTensor(const TensorInfo& tensor, const float* detections,
+                                const DecodeParams& params, std::vector<BBoxInfo>& binfo)
+{
+    const LetterboxGeometry letterbox(params);
+    const uint numGridCells = tensor.gridW * tensor.gridH;
+    const uint numChannels = 5 + tensor.numClasses;
+    // sigmoid is monotonic, so comparing raw objectness against logit(prob_thresh) rejects the
+    // same cells as thresholding the activated value, without evaluating a single exp
+    const float objectnessThresh = logit(params.probThresh);
+
+    for (uint y = 0; y < tensor.gridH; ++y)
+    {
+        for (uint x = 0; x < tensor.gridW; ++x)
+        {
+            const int bbindex = y * tensor.gridW + x;
+            for (uint b = 0; b < tensor.numBBoxes; ++b)
+            {
+                const float* anchorDetections
+                    = detections + bbindex + numGridCells * (b * numChannels);
+
+                const float objectnessLogit = anchorDetections[numGridCells * 4];
+                if (objectnessLogit <= objectnessThresh) continue;
+
+                // The arg-max of the logits is the arg-max of the class probabilities
+                int maxIndex = -1;
+                float maxLogit = findMaxClassProb(anchorDetections + numGridCells * 5,
+                                                  numGridCells, tensor.numClasses, maxIndex,
+                                                  -FLT_MAX);
+                if (maxIndex == -1) continue;
+                float maxProb = sigmoid(objectnessLogit) * sigmoid(maxLogit);
+
+                if (maxProb > params.probThresh)
+                {
+                    const float pw = tensor.anchors[tensor.masks[b] * 2];
+                    const float ph = tensor.anchors[tensor.masks[b] * 2 + 1];
+
+                    const float bx = x + sigmoid(anchorDetections[0]);
+                    const float by = y + sigmoid(anchorDetections[numGridCells * 1]);
+                    const float bw = pw * std::exp(anchorDetections[numGridCells * 2]);
+                    const float bh = ph * std::exp(anchorDetections[numGridCells * 3]);
+
+                    addBBoxProposal(bx, by, bw, bh, tensor.stride, letterbox, maxIndex, maxProb,
+                                    params, binfo);
+                }
+            }
+        }
+    }
+}
+
+TensorDecoder getTensorDecoder(const TensorInfo& tensor, const bool isRegion,
+                               const bool logitDecode)
+{
+    if (isRegion) return &decodeRegionTensor;
+    if (logitDecode) return &decodeRawYoloTensor;
+    return &decodeYoloTensor;
+}
+
+std::vector<TensorInfo> getOutputTensors(const NetworkDesc& network, const bool logitDecode)
+{
+    // grid sizes, strides, blob names and volumes only depend on the cfg
+    std::vector<TensorInfo> tensors;
+    for (const OutputLayerInfo& outputLayer : getOutputLayers(network))
+    {
+        const LayerDesc& layer = network.getLayer(outputLayer.layerIdx);
+        TensorInfo tensor;
+        tensor.anchors = layer.detection.anchors;
+        tensor.masks = layer.detection.masks;
+        tensor.numBBoxes = outputLayer.numBBoxes;
+        tensor.numClasses = outputLayer.numClasses;
+        tensor.blobName = outputLayer.blobName;
+        tensor.gridW = outputLayer.gridW;
+        tensor.gridH = outputLayer.gridH;
+        tensor.stride = outputLayer.stride;
+        tensor.volume = outputLayer.volume;
+        const bool isRegion = (layer.type == LayerType::kRegion);
+        if (isRegion)
+        {
+            std::cout << "Anchors are being converted to network input resolution i.e. Anchors x "
+                      << tensor.stride << " (stride)" << std::endl;
+            for (auto& anchor : tensor.anchors) anchor *= tensor.stride;
+        }
+        tensor.decoder = getTensorDecoder(tensor, isRegion, logitDecode);
+        tensors.push_back(tensor);
+    }
+    return tensors;
+}
@@ -0,0 +1,147 @@
+/**
+MIT License
+
+Copyright (c) 2018 NVIDIA CORPORATION. All rights reserved.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*
+*/
+
+#ifndef _YOLO_DECODE_H_
+#define _YOLO_DECODE_H_
+
+#include "nms.h"
+#include "yolo_cfg.h"
+
+#include <stdint.h>
+#include <string>
+#include <sys/types.h>
+#include <vector>
+
+/**
+ * Host side decoding of the yolo and region output tensors into box proposals. Needs neither
+ * CUDA nor TensorRT, so decoders can be tested and benchmarked on synthetic tensors.
+ */
+
+struct TensorInfo;
+
+/**
+ * Everything about the image being decoded that is not part of the tensor.
+ */
+struct DecodeParams
+{
+    // network input the tensor was computed from
+    uint inputW;
+    uint inputH;
+    // size of the image that was letterboxed into it, boxes are mapped back to it
+    int imageW;
+    int imageH;
+    float probThresh;
+    // coco category of every label, indexed by label
+    const int* classIds;
+};
+
+// Appends the proposals decoded from the detections of one image to binfo
+typedef void (*TensorDecoder)(const TensorInfo& tensor, const float* detections,
+                              const DecodeParams& params, std::vector<BBoxInfo>& binfo);
+
+/**
+ * Holds information about an output tensor of the yolo network.
+ */
+struct TensorInfo
+{
+    std::string blobName;
+    uint stride{0};
+    uint gridW{0};
+    uint gridH{0};
+    uint numClasses{0};
+    uint numBBoxes{0};
+    uint64_t volume{0};
+    std::vector<uint> masks;
+    std::vector<float> anchors;
+    int bindingIndex{-1};
+    float* hostBuffer{nullptr};
+    // picked once from the layer type and shape of the tensor, see getTensorDecoder
+    TensorDecoder decoder{nullptr};
+};
+
+// Returns the decoder of a region (yolov2) or yolo (yolov3) output tensor. logitDecode selects
+// the decoder of yolo layers that return raw conv outputs, it doesn't apply to region layers.
+TensorDecoder getTensorDecoder(const TensorInfo& tensor, const bool isRegion,
+                               const bool logitDecode);
+
+// Output tensors of every yolo and region layer of the network, with their decoders. Only
+// depends on the cfg, the binding index and host buffer are left for the engine to fill in
+std::vector<TensorInfo> getOutputTensors(const NetworkDesc& network, const bool logitDecode);
+
+// Arg-max over the class scores of one anchor. The output tensors are channel-major, so
+// consecutive class scores are 'stride' floats apart. The scan is split across independent
+// lanes so the strided loads and compares don't serialize on a single running max. Only
+// scores above minProb are considered, raw logits pass -FLT_MAX.
+inline float findMaxClassProb(const float* probs, const uint stride, const uint numClasses,
+                              int& maxIndex, const float minProb = 0.0f)
+{
+    const uint kLanes = 4;
+    float laneProb[kLanes] = {minProb, minProb, minProb, minProb};
+    int laneIndex[kLanes] = {-1, -1, -1, -1};
+
+    uint i = 0;
+    for (; i + kLanes <= numClasses; i += kLanes)
+    {
+        for (uint l = 0; l < kLanes; ++l)
+        {
+            const float prob = probs[(i + l) * stride];
+            if (prob > laneProb[l])
+            {
+                laneProb[l] = prob;
+                laneIndex[l] = i + l;
+            }
+        }
+    }
+    for (; i < numClasses; ++i)
+    {
+        const float prob = probs[i * stride];
+        if (prob > laneProb[i % kLanes])
+        {
+            laneProb[i % kLanes] = prob;
+            laneIndex[i % kLanes] = i;
+        }
+    }
+
+    // Ties resolve to the lowest class index, same as a serial scan
+    float maxProb = minProb;
+    maxIndex = -1;
+    for (uint l = 0; l < kLanes; ++l)
+    {
+        if ((laneProb[l] > maxProb)
+            || ((laneIndex[l] != -1) && (laneProb[l] == maxProb) && (laneIndex[l] < maxIndex)))
+        {
+            maxProb = laneProb[l];
+            maxIndex = laneIndex[l];
+        }
+    }
+    return maxProb;
+}
+
+BBox convertBBoxNetRes(const float& bx, const float& by, const float& bw, const float& bh,
+                       const uint& stride, const uint& netW, const uint& netH);
+void convertBBoxImgRes(const float scalingFactor, const float& xOffset, const float& yOffset,
+                       BBox& bbox);
+
+#endif // _YOLO_DECODE_H_
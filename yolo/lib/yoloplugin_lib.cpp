@@ -24,22 +24,59 @@ SOFTWARE.
 */
 
 #include "yoloplugin_lib.h"
+#include "cost_model.h"
+#include "letterbox.h"
 #include "yolo_config_parser.h"
 #include "yolov2.h"
 #include "yolov3.h"
 
+#include <algorithm>
 #include <iomanip>
 #include <sys/time.h>
+#include <time.h>
 
-static void decodeBatchDetections(const YoloPluginCtx* ctx, std::vector<YoloPluginOutput*>& outputs)
+static double elapsedMs(const struct timeval& start, const struct timeval& end)
 {
-    for (uint p = 0; p < ctx->batchSize; ++p)
+    return ((end.tv_sec - start.tv_sec) + (end.tv_usec - start.tv_usec) / 1000000.0) * 1000;
+}
+
+static Yolo* createInferenceNetwork(const NetworkInfo& networkInfo, const InferParams& inferParams,
+                                    const uint batchSize)
+{
+    if ((networkInfo.networkType == "yolov2") || (networkInfo.networkType == "yolov2-tiny"))
+    {
+        return new YoloV2(batchSize, networkInfo, inferParams);
+    }
+    else if ((networkInfo.networkType == "yolov3") || (networkInfo.networkType == "yolov3-tiny"))
+    {
+        return new YoloV3(batchSize, networkInfo, inferParams);
+    }
+    std::cerr << "ERROR: Unrecognized network type " << networkInfo.networkType << std::endl;
+    std::cerr << "Network Type has to be one among the following : yolov2, yolov2-tiny, yolov3 "
+                 "and yolov3-tiny"
+              << std::endl;
+    return nullptr;
+}
+
+static void decodeBatchDetections(YoloPluginCtx* ctx, Yolo& network,
+                                  std::vector<YoloPluginOutput*>& outputs)
+{
+    // The output struct has room for a fixed number of objects per frame
+    NMSParams nmsParams = network.getNMSParams();
+    if ((nmsParams.maxDetections == 0) || (nmsParams.maxDetections > MAX_OBJECTS_PER_FRAME))
     {
+        nmsParams.maxDetections = MAX_OBJECTS_PER_FRAME;
+    }
+
+    // Each slot only reads the network's output buffers and writes its own arena and output
+    // entry, so the slots can be decoded concurrently and the output order stays the batch order
+    ctx->postProcessPool->parallelFor(outputs.size(), [&](const uint p) {
         YoloPluginOutput* out = new YoloPluginOutput;
-        std::vector<BBoxInfo> binfo = ctx->inferenceNetwork->decodeDetections(
-            p, ctx->initParams.processingHeight, ctx->initParams.processingWidth);
-        std::vector<BBoxInfo> remaining = nmsAllClasses(
-            ctx->inferenceNetwork->getNMSThresh(), binfo, ctx->inferenceNetwork->getNumClasses());
+        DetectionArena& arena = ctx->detectionArenas.at(p);
+        network.decodeDetections(p, ctx->initParams.processingHeight,
+                                 ctx->initParams.processingWidth, arena.proposals);
+        nmsAllClasses(nmsParams, network.getNumClasses(), arena);
+        const std::vector<BBoxInfo>& remaining = arena.detections;
         out->numObjects = remaining.size();
         assert(out->numObjects <= MAX_OBJECTS_PER_FRAME);
         for (uint j = 0; j < remaining.size(); ++j)
@@ -50,46 +87,55 @@ static void decodeBatchDetections(const YoloPluginCtx* ctx, std::vector<YoloPlug
             obj.top = static_cast<int>(b.box.y1);
             obj.width = static_cast<int>(b.box.x2 - b.box.x1);
             obj.height = static_cast<int>(b.box.y2 - b.box.y1);
-            strcpy(obj.label, ctx->inferenceNetwork->getClassName(b.label).c_str());
+            strcpy(obj.label, network.getClassName(b.label).c_str());
             out->object[j] = obj;
+        }
+        outputs.at(p) = out;
+    });
 
-            if (ctx->inferParams.printPredictionInfo)
+    if (ctx->inferParams.printPredictionInfo)
+    {
+        for (uint p = 0; p < outputs.size(); ++p)
+        {
+            for (auto& b : ctx->detectionArenas.at(p).detections)
             {
-                printPredictions(b, ctx->inferenceNetwork->getClassName(b.label));
+                printPredictions(b, network.getClassName(b.label));
             }
         }
-        outputs.at(p) = out;
     }
 }
 
-static void dsPreProcessBatchInput(const std::vector<cv::Mat*>& cvmats, cv::Mat& batchBlob,
-                                   const int& processingHeight, const int& processingWidth,
-                                   const int& inputH, const int& inputW)
+// Letterboxes the frames into ctx->inputBuffer, spread over the preprocessing workers. Plans
+// come from the cache and the buffer is allocated once, so a steady stream of frames is
+// preprocessed without any allocation
+static void dsPreProcessBatchInput(YoloPluginCtx* ctx, const std::vector<cv::Mat*>& cvmats,
+                                   const uint inputH, const uint inputW)
 {
-
-    std::vector<cv::Mat> batch_images(
-        cvmats.size(), cv::Mat(cv::Size(processingWidth, processingHeight), CV_8UC3));
+    assert(cvmats.size() * 3 * inputH * inputW <= ctx->inputBuffer.size());
+    // the cache is not thread safe, it holds at least a batch worth of plans
     for (uint i = 0; i < cvmats.size(); ++i)
     {
-        cv::Mat imageResize, imageBorder, inputImage;
-        inputImage = *cvmats.at(i);
-        int maxBorder = std::max(inputImage.size().width, inputImage.size().height);
-
-        assert((maxBorder - inputImage.size().height) % 2 == 0);
-        assert((maxBorder - inputImage.size().width) % 2 == 0);
-
-        int yOffset = (maxBorder - inputImage.size().height) / 2;
-        int xOffset = (maxBorder - inputImage.size().width) / 2;
-
-        // Letterbox and resize to maintain aspect ratio
-        cv::copyMakeBorder(inputImage, imageBorder, yOffset, yOffset, xOffset, xOffset,
-                           cv::BORDER_CONSTANT, cv::Scalar(127.5, 127.5, 127.5));
-        cv::resize(imageBorder, imageResize, cv::Size(inputW, inputH), 0, 0, cv::INTER_CUBIC);
-        batch_images.at(i) = imageResize;
+        const cv::Mat& image = *cvmats.at(i);
+        ctx->batchPlans.at(i)
+            = &ctx->letterboxPlans.getPlan(image.cols, image.rows, inputW, inputH);
     }
 
-    batchBlob = cv::dnn::blobFromImages(batch_images, 1.0, cv::Size(inputW, inputH),
-                                        cv::Scalar(0.0, 0.0, 0.0), false, false);
+    // Each slot is written to its own part of the input buffer. The captures fit in the
+    // std::function small buffer, so no task allocates
+    ctx->preProcessPool->parallelFor(cvmats.size(), [ctx, &cvmats](const uint i) {
+        // CPU time of the worker, wall time would also count the time it was preempted
+        struct timespec slotStart, slotEnd;
+        clock_gettime(CLOCK_THREAD_CPUTIME_ID, &slotStart);
+        const cv::Mat& image = *cvmats.at(i);
+        const LetterboxPlan& plan = *ctx->batchPlans.at(i);
+        // channels are passed in the order the gst plugin converts frames to, as before the
+        // letterbox was fused
+        letterboxToCHW(plan, image.data, image.step[0], false,
+                       ctx->inputBuffer.data() + i * 3 * plan.dstH * plan.dstW);
+        clock_gettime(CLOCK_THREAD_CPUTIME_ID, &slotEnd);
+        ctx->preSlotTime.at(i) += (slotEnd.tv_sec - slotStart.tv_sec) * 1000.0
+            + (slotEnd.tv_nsec - slotStart.tv_nsec) / 1000000.0;
+    });
 }
 
 YoloPluginCtx* YoloPluginCtxInit(YoloPluginInitParams* initParams, size_t batchSize)
@@ -104,9 +150,11 @@ YoloPluginCtx* YoloPluginCtxInit(YoloPluginInitParams* initParams, size_t batchS
     YoloPluginCtx* ctx = new YoloPluginCtx;
     ctx->initParams = *initParams;
     ctx->batchSize = batchSize;
-    ctx->networkInfo = getYoloNetworkInfo();
+    ctx->networkInfo = getYoloNetworkInfo(ctx->batchSize);
     ctx->inferParams = getYoloInferParams();
     uint configBatchSize = getBatchSize();
+    ctx->preProcessPool = new WorkerPool(getPreProcessWorkers());
+    ctx->postProcessPool = new WorkerPool(getPostProcessWorkers());
 
     // Check if config batchsize matches buffer batch size in the pipeline
     if (ctx->batchSize != configBatchSize)
@@ -114,32 +162,98 @@ YoloPluginCtx* YoloPluginCtxInit(YoloPluginInitParams* initParams, size_t batchS
         std::cerr
             << "WARNING: Batchsize set in config file overriden by pipeline. New batchsize is "
             << ctx->batchSize << std::endl;
-        int npos = ctx->networkInfo.wtsFilePath.find(".weights");
-        assert(npos != std::string::npos
-               && "wts file file not recognised. File needs to be of '.weights' format");
-        std::string dataPath = ctx->networkInfo.wtsFilePath.substr(0, npos);
-        ctx->networkInfo.enginePath = dataPath + "-" + ctx->networkInfo.precision + "-batch"
-            + std::to_string(ctx->batchSize) + ".engine";
     }
 
-    if ((ctx->networkInfo.networkType == "yolov2")
-        || (ctx->networkInfo.networkType == "yolov2-tiny"))
+    // Buckets above the pipeline batch size could never be selected, the pipeline batch size
+    // itself is always a bucket
+    std::vector<uint> batchBuckets = getBatchBuckets();
+    batchBuckets.erase(std::remove_if(batchBuckets.begin(), batchBuckets.end(),
+                                      [ctx](const uint b) { return b > ctx->batchSize; }),
+                       batchBuckets.end());
+    batchBuckets.push_back(ctx->batchSize);
+
+    // One set of engines per input size, ordered by the MACs the cost model predicts for them.
+    // {0, 0} builds the engines at the size of the cfg. Sizes costing the same, e.g. 608x352
+    // and 352x608, would be the same level for the resolution controller, so only the first
+    // listed is kept
+    std::vector<std::pair<uint, uint>> inputSizes = getInputSizes();
+    if (inputSizes.empty()) inputSizes.push_back({0, 0});
+    std::vector<std::pair<double, std::pair<uint, uint>>> sizesByCost;
+    for (const auto& size : inputSizes)
     {
-        ctx->inferenceNetwork = new YoloV2(batchSize, ctx->networkInfo, ctx->inferParams);
+        const NetworkDesc network
+            = parseNetworkCfg(ctx->networkInfo.configFilePath, size.first, size.second);
+        sizesByCost.push_back({static_cast<double>(getNetworkCost(network, 1, 1).totalMACs), size});
     }
-    else if ((ctx->networkInfo.networkType == "yolov3")
-             || (ctx->networkInfo.networkType == "yolov3-tiny"))
+    std::stable_sort(sizesByCost.begin(), sizesByCost.end(),
+                     [](const std::pair<double, std::pair<uint, uint>>& a,
+                        const std::pair<double, std::pair<uint, uint>>& b) {
+                         return a.first < b.first;
+                     });
+    std::vector<double> levelCosts;
+    std::vector<std::pair<uint, uint>> levelSizes;
+    for (const auto& sizeCost : sizesByCost)
     {
-        ctx->inferenceNetwork = new YoloV3(batchSize, ctx->networkInfo, ctx->inferParams);
+        if (!levelCosts.empty() && (sizeCost.first == levelCosts.back()))
+        {
+            std::cerr << "WARNING: input_sizes " << sizeCost.second.first << "x"
+                      << sizeCost.second.second << " costs the same as "
+                      << levelSizes.back().first << "x" << levelSizes.back().second
+                      << ", only " << levelSizes.back().first << "x" << levelSizes.back().second
+                      << " is used" << std::endl;
+            continue;
+        }
+        levelCosts.push_back(sizeCost.first);
+        levelSizes.push_back(sizeCost.second);
     }
-    else
+
+    for (const std::pair<uint, uint>& inputSize : levelSizes)
     {
-        std::cerr << "ERROR: Unrecognized network type " << ctx->networkInfo.networkType
-                  << std::endl;
-        std::cerr << "Network Type has to be one among the following : yolov2, yolov2-tiny, yolov3 "
-                     "and yolov3-tiny"
+        ctx->inferenceNetworks.push_back(
+            new BatchBucketSet<Yolo>(batchBuckets, [ctx, inputSize](const uint bucketSize) {
+                NetworkInfo networkInfo = getYoloNetworkInfo(bucketSize);
+                networkInfo.inputW = inputSize.first;
+                networkInfo.inputH = inputSize.second;
+                return std::unique_ptr<Yolo>(
+                    createInferenceNetwork(networkInfo, ctx->inferParams, bucketSize));
+            }));
+    }
+    ctx->networkBatchCount.assign(ctx->inferenceNetworks.size(), 0);
+    ctx->bucketBatchCount.assign(ctx->inferenceNetworks.back()->getNumBuckets(), 0);
+
+    // The controller starts at the most expensive input size, so does a fixed set
+    ctx->networkLevel = ctx->inferenceNetworks.size() - 1;
+    const ResolutionControllerParams sloParams = getResolutionControllerParams();
+    if ((ctx->inferenceNetworks.size() > 1) && (sloParams.latencySLOMs > 0.0f))
+    {
+        ctx->resolutionController = new ResolutionController(levelCosts, sloParams);
+    }
+    else if (ctx->inferenceNetworks.size() > 1)
+    {
+        std::cerr << "WARNING: latency_slo_ms is not set, only the largest of input_sizes is used"
                   << std::endl;
-        return nullptr;
+    }
+
+    // Decode buffers are sized for the input size with the most proposals, the input buffer
+    // for the largest input size
+    uint maxProposals = 0;
+    size_t maxInputSize = 0;
+    for (const BatchBucketSet<Yolo>* network : ctx->inferenceNetworks)
+    {
+        const Yolo& engine = network->getEngine(0);
+        maxProposals = std::max(maxProposals, engine.getMaxProposals());
+        maxInputSize
+            = std::max(maxInputSize, static_cast<size_t>(engine.getInputH()) * engine.getInputW());
+    }
+    ctx->inputBuffer.resize(ctx->batchSize * 3 * maxInputSize);
+    ctx->letterboxPlans = LetterboxPlanCache(
+        std::max(ctx->batchSize, 16u), parseLetterboxFilter(ctx->inferParams.letterboxFilter));
+    ctx->batchPlans.resize(ctx->batchSize, nullptr);
+    ctx->preSlotTime.resize(ctx->batchSize, 0.0);
+    ctx->detectionArenas.resize(ctx->batchSize);
+    for (auto& arena : ctx->detectionArenas)
+    {
+        arena.reserve(ctx->inferenceNetworks.back()->getEngine(0).getNumClasses(), maxProposals);
     }
 
     delete[] gArgV;
@@ -150,40 +264,46 @@ std::vector<YoloPluginOutput*> YoloPluginProcess(YoloPluginCtx* ctx, std::vector
 {
     assert((cvmats.size() <= ctx->batchSize) && "Image batch size exceeds TRT engines batch size");
     std::vector<YoloPluginOutput*> outputs = std::vector<YoloPluginOutput*>(cvmats.size(), nullptr);
-    cv::Mat preprocessedImages;
     struct timeval preStart, preEnd, inferStart, inferEnd, postStart, postEnd;
     double preElapsed = 0.0, inferElapsed = 0.0, postElapsed = 0.0;
 
     if (cvmats.size() > 0)
     {
+        // Smallest batch bucket that holds the filled frames, at the current input size
+        const BatchBucketSet<Yolo>& buckets = *ctx->inferenceNetworks.at(ctx->networkLevel);
+        const uint bucket = buckets.selectBucket(cvmats.size());
+        Yolo& network = buckets.getEngine(bucket);
+
         gettimeofday(&preStart, NULL);
-        dsPreProcessBatchInput(cvmats, preprocessedImages, ctx->initParams.processingWidth,
-                               ctx->initParams.processingHeight, ctx->inferenceNetwork->getInputH(),
-                               ctx->inferenceNetwork->getInputW());
+        dsPreProcessBatchInput(ctx, cvmats, network.getInputH(), network.getInputW());
         gettimeofday(&preEnd, NULL);
 
         gettimeofday(&inferStart, NULL);
-        ctx->inferenceNetwork->doInference(preprocessedImages.data, cvmats.size());
+        network.doInference(reinterpret_cast<const unsigned char*>(ctx->inputBuffer.data()),
+                            cvmats.size());
         gettimeofday(&inferEnd, NULL);
 
         gettimeofday(&postStart, NULL);
-        decodeBatchDetections(ctx, outputs);
+        decodeBatchDetections(ctx, network, outputs);
         gettimeofday(&postEnd, NULL);
+
+        preElapsed = elapsedMs(preStart, preEnd);
+        inferElapsed = elapsedMs(inferStart, inferEnd);
+        postElapsed = elapsedMs(postStart, postEnd);
+
+        // The next batch runs at the input size picked from this one's latency, the outputs of
+        // this batch are already decoded with the engine that produced them
+        ++ctx->networkBatchCount.at(ctx->networkLevel);
+        ++ctx->bucketBatchCount.at(bucket);
+        if (ctx->resolutionController)
+        {
+            ctx->networkLevel = ctx->resolutionController->update(inferElapsed + postElapsed);
+        }
     }
 
     // Perf calc
     if (ctx->inferParams.printPerfInfo)
     {
-        preElapsed
-            = ((preEnd.tv_sec - preStart.tv_sec) + (preEnd.tv_usec - preStart.tv_usec) / 1000000.0)
-            * 1000;
-        inferElapsed = ((inferEnd.tv_sec - inferStart.tv_sec)
-                        + (inferEnd.tv_usec - inferStart.tv_usec) / 1000000.0)
-            * 1000;
-        postElapsed = ((postEnd.tv_sec - postStart.tv_sec)
-                       + (postEnd.tv_usec - postStart.tv_usec) / 1000000.0)
-            * 1000;
-
         ctx->inferTime += inferElapsed;
         ctx->preTime += preElapsed;
         ctx->postTime += postElapsed;
@@ -197,15 +317,53 @@ void YoloPluginCtxDeinit(YoloPluginCtx* ctx)
     if (ctx->inferParams.printPerfInfo)
     {
         std::cout << "Yolo Plugin Perf Summary " << std::endl;
-        std::cout << "Batch Size : " << ctx->batchSize << std::endl;
+        std::cout << "Batch Size : " << ctx->batchSize
+                  << " Pre-processing workers : " << ctx->preProcessPool->getNumWorkers()
+                  << " Post-processing workers : " << ctx->postProcessPool->getNumWorkers()
+                  << std::endl;
         std::cout << std::fixed << std::setprecision(4)
                   << "PreProcess : " << ctx->preTime / ctx->imageCount
                   << " ms Inference : " << ctx->inferTime / ctx->imageCount
                   << " ms PostProcess : " << ctx->postTime / ctx->imageCount << " ms Total : "
                   << (ctx->preTime + ctx->postTime + ctx->inferTime) / ctx->imageCount
                   << " ms per Image" << std::endl;
+        // what preprocessing would have taken on a single thread, the sum over all the slots
+        double preSerialTime = 0.0;
+        for (const double slotTime : ctx->preSlotTime) preSerialTime += slotTime;
+        std::cout << "PreProcess serial-equivalent : " << preSerialTime / ctx->imageCount
+                  << " ms per Image, parallel speedup : "
+                  << (ctx->preTime > 0 ? preSerialTime / ctx->preTime : 0.0) << "x"
+                  << std::endl;
+        std::cout << "Letterbox plans computed : " << ctx->letterboxPlans.getNumMisses()
+                  << " cached : " << ctx->letterboxPlans.getNumPlans() << std::endl;
+        if (ctx->inferenceNetworks.size() > 1)
+        {
+            for (uint i = 0; i < ctx->inferenceNetworks.size(); ++i)
+            {
+                const Yolo& network = ctx->inferenceNetworks.at(i)->getEngine(0);
+                std::cout << "Input " << network.getInputW() << "x" << network.getInputH()
+                          << " : " << ctx->networkBatchCount.at(i) << " batches" << std::endl;
+            }
+            if (ctx->resolutionController)
+            {
+                std::cout << "Resolution switches : "
+                          << ctx->resolutionController->getNumSwitches() << std::endl;
+            }
+        }
+        const BatchBucketSet<Yolo>& buckets = *ctx->inferenceNetworks.back();
+        if (buckets.getNumBuckets() > 1)
+        {
+            for (uint i = 0; i < buckets.getNumBuckets(); ++i)
+            {
+                std::cout << "Batch bucket " << buckets.getBatchSize(i) << " : "
+                          << ctx->bucketBatchCount.at(i) << " batches" << std::endl;
+            }
+        }
     }
 
-    delete ctx->inferenceNetwork;
+    delete ctx->resolutionController;
+    delete ctx->preProcessPool;
+    delete ctx->postProcessPool;
+    for (BatchBucketSet<Yolo>* network : ctx->inferenceNetworks) delete network;
     delete ctx;
 }
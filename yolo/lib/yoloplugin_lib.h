@@ -27,8 +27,12 @@ SOFTWARE.
 
 #include <glib.h>
 
+#include "batch_buckets.h"
 #include "calibrator.h"
+#include "letterbox.h"
+#include "resolution_controller.h"
 #include "trt_utils.h"
+#include "worker_pool.h"
 #include "yolo.h"
 
 #ifdef __cplusplus
@@ -56,12 +60,36 @@ struct YoloPluginCtx
     YoloPluginInitParams initParams;
     NetworkInfo networkInfo;
     InferParams inferParams;
-    Yolo* inferenceNetwork;
+    // One set of engines per input size, ordered from the cheapest to the most expensive. Each
+    // set holds an engine per batch bucket
+    std::vector<BatchBucketSet<Yolo>*> inferenceNetworks;
+    // Index in inferenceNetworks of the input size the next batch runs at
+    uint networkLevel = 0;
+    // Picks networkLevel from the measured batch latency, nullptr unless latency_slo_ms is set
+    // and there are several input sizes
+    ResolutionController* resolutionController = nullptr;
+    // Letterboxes the images of a batch in parallel
+    WorkerPool* preProcessPool;
+    // Decodes and runs NMS on the images of a batch in parallel
+    WorkerPool* postProcessPool;
+    // Reusable decode/NMS buffers, one per batch slot
+    std::vector<DetectionArena> detectionArenas;
+    // Letterbox plans of the frame sizes seen so far, frames of a stream all share one
+    LetterboxPlanCache letterboxPlans;
+    // Plan of each batch slot, looked up before the slots are letterboxed in parallel
+    std::vector<const LetterboxPlan*> batchPlans;
+    // Network input of a batch, sized for the largest batch and input size
+    std::vector<float> inputBuffer;
 
     // perf vars
     float inferTime = 0.0, preTime = 0.0, postTime = 0.0;
+    // letterbox time of each batch slot, their sum is what preprocessing takes on one thread
+    std::vector<double> preSlotTime;
     uint batchSize = 0;
     uint64_t imageCount = 0;
+    // batches run at each of inferenceNetworks and in each batch bucket
+    std::vector<uint64_t> networkBatchCount;
+    std::vector<uint64_t> bucketBatchCount;
 };
 
 // Detected/Labelled object structure, stores bounding box info along with label
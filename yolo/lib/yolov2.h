@@ -36,10 +36,6 @@ class YoloV2 : public Yolo
 {
 public:
     YoloV2(const uint batchSize, const NetworkInfo& networkInfo, const InferParams& inferParams);
-
-private:
-    std::vector<BBoxInfo> decodeTensor(const int imageIdx, const int imageH, const int imageW,
-                                       const TensorInfo& tensor) override;
 };
 
 #endif // _YOLO_V2_
\ No newline at end of file
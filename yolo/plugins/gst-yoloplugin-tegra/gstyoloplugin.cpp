@@ -524,9 +524,11 @@ gst_yoloplugin_transform_ip (GstBaseTransform * btrans, GstBuffer * inbuf)
       }
     }
 
-    // Process to get the outputs
-    outputs =
-        YoloPluginProcess (yoloplugin->yolopluginlib_ctx, yoloplugin->cvmats);
+    // Process to get the outputs. Only the filled frames are passed, so a
+    // partially filled batch runs on the smallest batch bucket that holds it
+    std::vector < cv::Mat * >filled (yoloplugin->cvmats.begin (),
+        yoloplugin->cvmats.begin () + batch_size);
+    outputs = YoloPluginProcess (yoloplugin->yolopluginlib_ctx, filled);
 
     for (uint k = 0; k < outputs.size (); ++k) {
       if (!outputs.at (k))
@@ -577,9 +579,11 @@ gst_yoloplugin_transform_ip (GstBaseTransform * btrans, GstBuffer * inbuf)
           bbparams->num_strings++;
         }
       }
-      // Process the object crop to obtain label
-      outputs =
-          YoloPluginProcess (yoloplugin->yolopluginlib_ctx, yoloplugin->cvmats);
+      // Process the object crops to obtain labels
+      std::vector < cv::Mat * >crops (yoloplugin->cvmats.begin (),
+          yoloplugin->cvmats.begin () + MIN (bbparams->num_rects,
+              (guint) yoloplugin->cvmats.size ()));
+      outputs = YoloPluginProcess (yoloplugin->yolopluginlib_ctx, crops);
 
       for (uint k = 0; k < outputs.size (); ++k) {
         if (!outputs.at (k))
@@ -61,11 +61,16 @@ PYBIND11_MODULE(YoloV3, m) {
       deviceType,
       calibrationTablePath,
       enginePath,
-      inputBlobName
+      inputBlobName,
+      weightsCachePath,
+      engineCacheDir,
+      engineCacheMaxSizeMB,
+      inputW,
+      inputH
     }
 
     )pbdoc")
-    .def(py::init<>())
+    .def(py::init([]() { return NetworkInfo{}; }))
     .def_readwrite("networkType", &NetworkInfo::networkType)
     .def_readwrite("configFilePath", &NetworkInfo::configFilePath)
     .def_readwrite("wtsFilePath", &NetworkInfo::wtsFilePath)
@@ -74,7 +79,12 @@ PYBIND11_MODULE(YoloV3, m) {
     .def_readwrite("deviceType", &NetworkInfo::deviceType)
     .def_readwrite("calibrationTablePath", &NetworkInfo::calibrationTablePath)
     .def_readwrite("enginePath", &NetworkInfo::enginePath)
-    .def_readwrite("inputBlobName", &NetworkInfo::inputBlobName);
+    .def_readwrite("inputBlobName", &NetworkInfo::inputBlobName)
+    .def_readwrite("weightsCachePath", &NetworkInfo::weightsCachePath)
+    .def_readwrite("engineCacheDir", &NetworkInfo::engineCacheDir)
+    .def_readwrite("engineCacheMaxSizeMB", &NetworkInfo::engineCacheMaxSizeMB)
+    .def_readwrite("inputW", &NetworkInfo::inputW)
+    .def_readwrite("inputH", &NetworkInfo::inputH);
   
   py::class_<InferParams>(m, "InferParams", R"pbdoc(
     class to hold InferParams struct with the following info:
@@ -85,17 +95,40 @@ PYBIND11_MODULE(YoloV3, m) {
       calibImages,
       calibImagesPath,
       probThresh,
-      nmsThresh
+      nmsThresh,
+      preNMSTopK,
+      maxDetections,
+      nmsEngine,
+      batchedNMS,
+      nmsType,
+      softNMSSigma,
+      logitDecode,
+      letterboxFilter
     }
 
     )pbdoc")
-    .def(py::init<>())
+    .def(py::init([]() {
+      InferParams params{};
+      params.nmsEngine = "greedy";
+      params.nmsType = "hard";
+      params.softNMSSigma = 0.5;
+      params.letterboxFilter = "cubic";
+      return params;
+    }))
     .def_readwrite("printPerfInfo", &InferParams::printPerfInfo)
     .def_readwrite("printPredictionInfo", &InferParams::printPredictionInfo)
     .def_readwrite("calibImages", &InferParams::calibImages)
     .def_readwrite("calibImagesPath", &InferParams::calibImagesPath)
     .def_readwrite("probThresh", &InferParams::probThresh)
-    .def_readwrite("nmsThresh", &InferParams::nmsThresh);
+    .def_readwrite("nmsThresh", &InferParams::nmsThresh)
+    .def_readwrite("preNMSTopK", &InferParams::preNMSTopK)
+    .def_readwrite("maxDetections", &InferParams::maxDetections)
+    .def_readwrite("nmsEngine", &InferParams::nmsEngine)
+    .def_readwrite("batchedNMS", &InferParams::batchedNMS)
+    .def_readwrite("nmsType", &InferParams::nmsType)
+    .def_readwrite("softNMSSigma", &InferParams::softNMSSigma)
+    .def_readwrite("logitDecode", &InferParams::logitDecode)
+    .def_readwrite("letterboxFilter", &InferParams::letterboxFilter);
 
   py::class_<Yolo>(m, "Yolo");
 
@@ -117,7 +150,9 @@ PYBIND11_MODULE(YoloV3, m) {
     .def("getInputH", &YoloV3::getInputH)
     .def("getInputW", &YoloV3::getInputW)
     .def("doInference", &YoloV3::doInference)
-    .def("decodeDetections", &YoloV3::decodeDetections)
+    .def("decodeDetections",
+         static_cast<std::vector<BBoxInfo> (YoloV3::*)(const int&, const int&, const int&)>(
+             &YoloV3::decodeDetections))
     .def("getNMSThresh", &YoloV3::getNMSThresh)
     .def("getNumClasses", &YoloV3::getNumClasses)
     .def("getClassName", &YoloV3::getClassName)
@@ -126,7 +161,8 @@ PYBIND11_MODULE(YoloV3, m) {
       py::buffer_info buf1 = image.request();
 
       cv::Mat matx(static_cast<int>(buf1.shape[0]), static_cast<int>(buf1.shape[1]), CV_8UC3, (void *)buf1.ptr);
-      cv::Mat letterBoxImage = getLetterBoxBlob(matx, self.getInputH(), self.getInputW());
+      cv::Mat letterBoxImage = getLetterBoxBlob(matx, self.getInputH(), self.getInputW(),
+                                                    self.getLetterboxFilter());
 
       self.doInference((unsigned char*) letterBoxImage.data, 1);
 
@@ -145,7 +181,10 @@ PYBIND11_MODULE(YoloV3, m) {
 
     )pbdoc");
 
-  m.def("nmsAllClasses", &nmsAllClasses, R"pbdoc(
+  m.def("nmsAllClasses",
+        static_cast<std::vector<BBoxInfo> (*)(const float, std::vector<BBoxInfo>&, const uint)>(
+            &nmsAllClasses),
+        R"pbdoc(
     decode results of TensorRT inference into a vector of Python class:
 
       class BBoxInfo:
@@ -11,64 +11,32 @@
 #include <iostream>
 #include <cassert>
 
+#include "letterbox.h"
+
 using namespace cv;
 using namespace std;
 
 static inline Mat getLetterBoxBlob(const Mat& origImage, const int& inputH,
-                         const int& inputW)
+                         const int& inputW, const LetterboxFilter filter)
 {
-  int m_Height;
-  int m_Width;
-  int m_XOffset;
-  int m_YOffset;
-  float m_ScalingFactor;
-
-  // letterboxed Image given to the network as input
-  cv::Mat m_LetterboxImage;
-
   if (!origImage.data || origImage.cols <= 0 || origImage.rows <= 0)
   {
     cout << "Image is not valid" << endl;
     assert(0);
   }
 
-  if (origImage.channels() != 3)
+  if (origImage.channels() != 3 || origImage.depth() != CV_8U)
   {
     cout << "Non RGB images are not supported " << endl;
     assert(0);
   }
 
-  m_Height = origImage.rows;
-  m_Width = origImage.cols;
-
-  // resize the DsImage with scale
-  float dim = max(m_Height, m_Width);
-  int resizeH = ((m_Height / dim) * inputH);
-  int resizeW = ((m_Width / dim) * inputW);
-  m_ScalingFactor = static_cast<float>(resizeH) / static_cast<float>(m_Height);
-
-  // Additional checks for images with non even dims
-  if ((inputW - resizeW) % 2) resizeW--;
-  if ((inputH - resizeH) % 2) resizeH--;
-  assert((inputW - resizeW) % 2 == 0);
-  assert((inputH - resizeH) % 2 == 0);
-
-  m_XOffset = (inputW - resizeW) / 2;
-  m_YOffset = (inputH - resizeH) / 2;
-
-  assert(2 * m_XOffset + resizeW == inputW);
-  assert(2 * m_YOffset + resizeH == inputH);
-
-  // resizing
-  resize(origImage, m_LetterboxImage, Size(resizeW, resizeH), 0, 0, INTER_CUBIC);
-  // letterboxing
-  copyMakeBorder(m_LetterboxImage, m_LetterboxImage, m_YOffset, m_YOffset, m_XOffset,
-                      m_XOffset, BORDER_CONSTANT, Scalar(128, 128, 128));
-  // converting to RGB
-  cvtColor(m_LetterboxImage, m_LetterboxImage, CV_BGR2RGB);
-
-  return dnn::blobFromImage(m_LetterboxImage, 1.0, Size(inputW, inputH),
-                                  Scalar(0.0, 0.0, 0.0), false, false);                             
+  // letterbox the BGR image straight into an RGB planar blob
+  const int dims[] = {1, 3, inputH, inputW};
+  Mat blob(4, dims, CV_32F);
+  letterboxToCHW(getLetterboxPlan(origImage.cols, origImage.rows, inputW, inputH, 1, filter),
+                 origImage.data, origImage.step[0], true, blob.ptr<float>(0));
+  return blob;
 }
 
 #endif
\ No newline at end of file
@@ -0,0 +1,109 @@
+/**
+MIT License
+
+Copyright (c) 2018 NVIDIA CORPORATION. All rights reserved.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*
+*/
+
+#include "batch_buckets.h"
+
+#include <cassert>
+#include <iostream>
+#include <memory>
+#include <vector>
+
+namespace
+{
+// Stands in for a TensorRT engine, counts how many were built and destroyed
+struct StubEngine
+{
+    static uint numCreated;
+    static uint numDestroyed;
+    explicit StubEngine(const uint size) : batchSize(size) { ++numCreated; }
+    ~StubEngine() { ++numDestroyed; }
+    const uint batchSize;
+};
+uint StubEngine::numCreated = 0;
+uint StubEngine::numDestroyed = 0;
+
+void testBucketSelection()
+{
+    std::vector<uint> factoryCalls;
+    {
+        BatchBucketSet<StubEngine> buckets(
+            {8, 1, 4, 2, 4, 16}, [&factoryCalls](const uint batchSize) {
+                factoryCalls.push_back(batchSize);
+                return std::unique_ptr<StubEngine>(new StubEngine(batchSize));
+            });
+
+        // sorted and deduplicated, with the factory called once per bucket in that order
+        const std::vector<uint> expectedSizes{1, 2, 4, 8, 16};
+        assert(factoryCalls == expectedSizes);
+        assert(buckets.getNumBuckets() == expectedSizes.size());
+        for (uint b = 0; b < buckets.getNumBuckets(); ++b)
+        {
+            assert(buckets.getBatchSize(b) == expectedSizes.at(b));
+            assert(buckets.getEngine(b).batchSize == expectedSizes.at(b));
+        }
+        assert(buckets.getMaxBatchSize() == 16);
+        assert(StubEngine::numCreated == 5);
+        assert(StubEngine::numDestroyed == 0);
+
+        // every fill runs on the smallest bucket that holds it
+        const uint expectedBatch[17] = {1, 1, 2, 4, 4, 8, 8, 8, 8, 16, 16, 16, 16, 16, 16, 16, 16};
+        for (uint numFilled = 0; numFilled <= 16; ++numFilled)
+        {
+            const uint bucket = buckets.selectBucket(numFilled);
+            assert(buckets.getBatchSize(bucket) == expectedBatch[numFilled]);
+            assert(buckets.select(numFilled).batchSize == expectedBatch[numFilled]);
+            assert(&buckets.select(numFilled) == &buckets.getEngine(bucket));
+        }
+        // selecting never builds another engine
+        assert(StubEngine::numCreated == 5);
+    }
+    // the set owns the engines
+    assert(StubEngine::numDestroyed == 5);
+}
+
+void testSingleBucket()
+{
+    StubEngine::numCreated = 0;
+    StubEngine::numDestroyed = 0;
+    {
+        BatchBucketSet<StubEngine> buckets({4, 4}, [](const uint batchSize) {
+            return std::unique_ptr<StubEngine>(new StubEngine(batchSize));
+        });
+        assert(buckets.getNumBuckets() == 1);
+        for (uint numFilled = 0; numFilled <= 4; ++numFilled)
+            assert(buckets.selectBucket(numFilled) == 0);
+    }
+    assert(StubEngine::numCreated == 1);
+    assert(StubEngine::numDestroyed == 1);
+}
+} // namespace
+
+int main()
+{
+    testBucketSelection();
+    testSingleBucket();
+    std::cout << "batch_buckets_test passed" << std::endl;
+    return 0;
+}
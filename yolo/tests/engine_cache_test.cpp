@@ -0,0 +1,218 @@
+/**
+MIT License
+
+Copyright (c) 2018 NVIDIA CORPORATION. All rights reserved.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*
+*/
+
+#include "engine_cache.h"
+#include "mapped_file.h"
+
+#include <cassert>
+#include <chrono>
+#include <cstdlib>
+#include <experimental/filesystem>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace fs = std::experimental::filesystem;
+
+namespace
+{
+std::string g_TmpDir;
+
+EngineCacheKey getKey(const std::string& batchSize)
+{
+    EngineCacheKey key;
+    key.add("networkType", "yolov3");
+    key.add("precision", "kHALF");
+    key.add("batchSize", batchSize);
+    return key;
+}
+
+std::string readFile(const std::string& path)
+{
+    std::ifstream file(path, std::ios_base::binary);
+    std::stringstream content;
+    content << file.rdbuf();
+    return content.str();
+}
+
+// lastUsed has a resolution of a millisecond, keep entries apart in the LRU order
+void nextMs() { std::this_thread::sleep_for(std::chrono::milliseconds(3)); }
+
+void testDigest()
+{
+    // the digest names cache entries on disk, so it must not change between runs or builds
+    assert(getKey("4").getDigest() == getKey("4").getDigest());
+    assert(getKey("4").getDigest() == "97b8f523daabb72d");
+    assert(getKey("4").getDigest().size() == 16);
+
+    // every field counts, and so does their order
+    assert(getKey("8").getDigest() != getKey("4").getDigest());
+    EngineCacheKey reordered;
+    reordered.add("precision", "kHALF");
+    reordered.add("networkType", "yolov3");
+    reordered.add("batchSize", "4");
+    assert(reordered.getDigest() != getKey("4").getDigest());
+    // names and values don't run into each other
+    EngineCacheKey a, b;
+    a.add("ab", "c");
+    b.add("a", "bc");
+    assert(a.getDigest() != b.getDigest());
+
+    const std::string filePath = g_TmpDir + "/weights";
+    std::ofstream(filePath) << "darknet weights";
+    EngineCacheKey withFile;
+    withFile.addFileChecksum("weights", filePath);
+    withFile.addFileChecksum("calibrationTable", g_TmpDir + "/missing.table");
+    assert(withFile.getFields().size() == 2);
+    assert(withFile.getFields().at(0).second == "35f2a4a4177a9154");
+    assert(withFile.getFields().at(1).second == "none");
+    std::ofstream(filePath) << "other weights";
+    EngineCacheKey changed;
+    changed.addFileChecksum("weights", filePath);
+    assert(changed.getFields().at(0).second != withFile.getFields().at(0).second);
+    // a checksum recorded elsewhere, e.g. by a weights cache, keys the same as the file
+    EngineCacheKey recorded;
+    recorded.addChecksum("weights", fileChecksum(filePath));
+    assert(recorded.getFields() == changed.getFields());
+    fs::remove(filePath);
+}
+
+void testMissInsertHit()
+{
+    const EngineCache cache(g_TmpDir + "/hit", 0);
+    const EngineCacheKey key = getKey("1");
+    assert(!cache.lookup(key));
+
+    const std::string plan(1000, 'p');
+    cache.insert(key, plan.data(), plan.size());
+    assert(cache.getPlanPath(key) == g_TmpDir + "/hit/" + key.getDigest() + ".engine");
+    assert(readFile(cache.getPlanPath(key)) == plan);
+    const std::string manifest = readFile(cache.getManifestPath(key));
+    assert(manifest.find("\"planSize\": 1000,") != std::string::npos);
+    assert(manifest.find("\"batchSize\": \"1\"") != std::string::npos);
+    assert(cache.lookup(key));
+    assert(!cache.lookup(getKey("2")));
+
+    // a second cache on the same directory sees the entry
+    const EngineCache reopened(g_TmpDir + "/hit", 0);
+    assert(reopened.lookup(key));
+}
+
+void testLRUEviction()
+{
+    // room for three plans of 100 bytes
+    const EngineCache cache(g_TmpDir + "/lru", 300);
+    const std::string plan(100, 'p');
+    for (const char* batchSize : {"1", "2", "3"})
+    {
+        cache.insert(getKey(batchSize), plan.data(), plan.size());
+        nextMs();
+    }
+    // using the oldest entry makes the second one the least recently used
+    assert(cache.lookup(getKey("1")));
+    nextMs();
+    cache.insert(getKey("4"), plan.data(), plan.size());
+    assert(!fs::exists(cache.getPlanPath(getKey("2"))));
+    assert(!fs::exists(cache.getManifestPath(getKey("2"))));
+    assert(!cache.lookup(getKey("2")));
+    for (const char* batchSize : {"1", "3", "4"})
+    {
+        assert(cache.lookup(getKey(batchSize)));
+        nextMs();
+    }
+
+    // the lookups above left 1 as the least recently used
+    cache.insert(getKey("5"), plan.data(), plan.size());
+    assert(!cache.lookup(getKey("1")));
+    assert(cache.lookup(getKey("3")) && cache.lookup(getKey("4")) && cache.lookup(getKey("5")));
+}
+
+void testOversizedEntry()
+{
+    const EngineCache cache(g_TmpDir + "/oversized", 300);
+    const std::string plan(100, 'p');
+    cache.insert(getKey("1"), plan.data(), plan.size());
+    nextMs();
+    cache.insert(getKey("2"), plan.data(), plan.size());
+    nextMs();
+
+    // a plan above the cap on its own evicts everything else but is kept
+    const std::string bigPlan(1000, 'b');
+    cache.insert(getKey("16"), bigPlan.data(), bigPlan.size());
+    assert(cache.lookup(getKey("16")));
+    assert(readFile(cache.getPlanPath(getKey("16"))) == bigPlan);
+    assert(!cache.lookup(getKey("1")));
+    assert(!cache.lookup(getKey("2")));
+    nextMs();
+
+    // and is the first to go once anything else is inserted
+    cache.insert(getKey("1"), plan.data(), plan.size());
+    assert(!cache.lookup(getKey("16")));
+    assert(cache.lookup(getKey("1")));
+}
+
+void testTruncatedPlan()
+{
+    const EngineCache cache(g_TmpDir + "/truncated", 0);
+    const std::string plan(1000, 'p');
+    cache.insert(getKey("1"), plan.data(), plan.size());
+    cache.insert(getKey("2"), plan.data(), plan.size());
+
+    // e.g. a copy that was interrupted, the plan no longer has the size of the manifest
+    fs::resize_file(cache.getPlanPath(getKey("1")), 500);
+    assert(!cache.lookup(getKey("1")));
+    assert(!fs::exists(cache.getPlanPath(getKey("1"))));
+    assert(!fs::exists(cache.getManifestPath(getKey("1"))));
+
+    // a missing plan is dropped the same way
+    fs::remove(cache.getPlanPath(getKey("2")));
+    assert(!cache.lookup(getKey("2")));
+    assert(!fs::exists(cache.getManifestPath(getKey("2"))));
+
+    // and the entry can be built again
+    cache.insert(getKey("1"), plan.data(), plan.size());
+    assert(cache.lookup(getKey("1")));
+}
+} // namespace
+
+int main()
+{
+    char tmpDir[] = "/tmp/engine_cache_test.XXXXXX";
+    assert(mkdtemp(tmpDir) != nullptr);
+    g_TmpDir = tmpDir;
+
+    testDigest();
+    testMissInsertHit();
+    testLRUEviction();
+    testOversizedEntry();
+    testTruncatedPlan();
+
+    fs::remove_all(g_TmpDir);
+    std::cout << "engine_cache_test passed" << std::endl;
+    return 0;
+}
@@ -0,0 +1,276 @@
+/**
+MIT License
+
+Copyright (c) 2018 NVIDIA CORPORATION. All rights reserved.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*
+*/
+
+#include "letterbox.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+namespace
+{
+std::string g_DataDir;
+
+struct Frame
+{
+    uint width;
+    uint height;
+    // packed RGB rows
+    std::vector<uint8_t> pixels;
+};
+
+// Binary PPM, as written by most image tools
+Frame readPPM(const std::string& path)
+{
+    std::ifstream file(path, std::ios_base::binary);
+    assert(file.good() && "Unable to open test frame");
+    std::string magic;
+    uint maxValue = 0;
+    Frame frame;
+    file >> magic >> frame.width >> frame.height >> maxValue;
+    assert((magic == "P6") && (maxValue == 255));
+    file.get();
+    frame.pixels.resize(static_cast<size_t>(frame.width) * frame.height * 3);
+    file.read(reinterpret_cast<char*>(frame.pixels.data()), frame.pixels.size());
+    assert(file.good());
+    return frame;
+}
+
+std::vector<uint8_t> readBytes(const std::string& path)
+{
+    std::ifstream file(path, std::ios_base::binary);
+    assert(file.good() && "Unable to open golden blob");
+    return std::vector<uint8_t>(std::istreambuf_iterator<char>(file),
+                                std::istreambuf_iterator<char>());
+}
+
+/**
+ * Input size of the network and the CHW bytes the source frame letterboxes to, generated with
+ * the letterbox before plans were cached. The frame is swapped from RGB to BGR.
+ */
+struct Golden
+{
+    uint dstW;
+    uint dstH;
+    std::vector<uint8_t> chw;
+};
+
+void checkAgainstGolden(const Frame& frame, const LetterboxPlan& plan, const Golden& golden)
+{
+    assert((plan.dstW == golden.dstW) && (plan.dstH == golden.dstH));
+    std::vector<uint8_t> bytes(golden.chw.size());
+    letterboxToCHW(plan, frame.pixels.data(), frame.width * 3, true, bytes.data());
+    assert(bytes == golden.chw);
+
+    // the float blob holds the same values before rounding
+    std::vector<float> floats(golden.chw.size());
+    letterboxToCHW(plan, frame.pixels.data(), frame.width * 3, true, floats.data());
+    for (uint i = 0; i < floats.size(); ++i)
+        assert(std::fabs(floats.at(i) - golden.chw.at(i)) <= 0.5f);
+}
+
+void testGoldenBlobsThroughPlanCache()
+{
+    const Frame frame = readPPM(g_DataDir + "/letterbox_src.ppm");
+    assert((frame.width == 61) && (frame.height == 37));
+    std::vector<Golden> goldens;
+    for (const auto& size : {std::make_pair(32u, 32u), std::make_pair(96u, 64u),
+                             std::make_pair(40u, 80u)})
+    {
+        const std::string name = "/letterbox_" + std::to_string(size.first) + "x"
+            + std::to_string(size.second) + ".chw";
+        goldens.push_back(Golden{size.first, size.second, readBytes(g_DataDir + name)});
+        assert(goldens.back().chw.size() == 3u * size.first * size.second);
+    }
+
+    // as in the yolo plugin, the cache holds as many plans as the batch has slots, one per
+    // stream. Here every slot letterboxes the frame into a different input size
+    const uint batchSize = goldens.size();
+    LetterboxPlanCache cache(batchSize);
+    std::vector<const LetterboxPlan*> batchPlans(batchSize);
+    for (uint batch = 0; batch < 5; ++batch)
+    {
+        for (uint slot = 0; slot < batchSize; ++slot)
+        {
+            const Golden& golden = goldens.at(slot);
+            batchPlans.at(slot)
+                = &cache.getPlan(frame.width, frame.height, golden.dstW, golden.dstH);
+            checkAgainstGolden(frame, *batchPlans.at(slot), golden);
+        }
+    }
+    // only the first batch computed plans
+    assert(cache.getNumPlans() == batchSize);
+    assert(cache.getNumMisses() == batchSize);
+
+    // a new stream replaces the least recently used plan, that of slot 0, and leaves the
+    // others where they are
+    const LetterboxPlan& cropPlan = cache.getPlan(50, 30, 32, 32);
+    assert(cache.getNumPlans() == batchSize);
+    assert(cache.getNumMisses() == batchSize + 1);
+    assert(&cropPlan == batchPlans.at(0));
+    assert(&cache.getPlan(frame.width, frame.height, 96, 64) == batchPlans.at(1));
+    assert(&cache.getPlan(frame.width, frame.height, 40, 80) == batchPlans.at(2));
+    assert(cache.getNumMisses() == batchSize + 1);
+
+    // the reused entry is overwritten completely, a crop of the frame letterboxes as with a
+    // plan of its own
+    const LetterboxPlan fresh = getLetterboxPlan(50, 30, 32, 32);
+    assert((cropPlan.srcW == 50) && (cropPlan.srcH == 30));
+    assert((cropPlan.xTap0 == fresh.xTap0) && (cropPlan.xWeight == fresh.xWeight));
+    assert((cropPlan.yTap0 == fresh.yTap0) && (cropPlan.yWeight == fresh.yWeight));
+    std::vector<uint8_t> fromCache(3 * 32 * 32), fromFresh(3 * 32 * 32);
+    letterboxToCHW(cropPlan, frame.pixels.data(), frame.width * 3, true, fromCache.data());
+    letterboxToCHW(fresh, frame.pixels.data(), frame.width * 3, true, fromFresh.data());
+    assert(fromCache == fromFresh);
+
+    // the evicted size misses again and still matches its golden blob. The crop was used less
+    // recently than the two other sizes, so it is the one replaced this time
+    const LetterboxPlan& again = cache.getPlan(frame.width, frame.height, 32, 32);
+    assert(cache.getNumMisses() == batchSize + 2);
+    assert(&again == &cropPlan);
+    checkAgainstGolden(frame, again, goldens.at(0));
+    assert(cache.getNumPlans() == batchSize);
+}
+
+void testSingleEntryCache()
+{
+    // a batch size of 1 alternating between two streams misses on every frame, but stays
+    // correct
+    const Frame frame = readPPM(g_DataDir + "/letterbox_src.ppm");
+    const Golden golden{32, 32, readBytes(g_DataDir + "/letterbox_32x32.chw")};
+    LetterboxPlanCache cache(1);
+    for (uint i = 0; i < 4; ++i)
+    {
+        checkAgainstGolden(frame, cache.getPlan(frame.width, frame.height, 32, 32), golden);
+        assert(cache.getPlan(50, 30, 32, 32).srcW == 50);
+    }
+    assert(cache.getNumPlans() == 1);
+    assert(cache.getNumMisses() == 8);
+}
+// cv::INTER_CUBIC kernel
+double cubicWeight(const double x)
+{
+    const double a = -0.75;
+    const double d = std::fabs(x);
+    if (d <= 1) return ((a + 2) * d - (a + 3)) * d * d + 1;
+    if (d < 2) return ((a * d - 5 * a) * d + 8 * a) * d - 4 * a;
+    return 0;
+}
+
+// Samples channel c of the frame at (x, y) of its resized image, all in double precision
+double sampleCubic(const Frame& frame, const double xScale, const double yScale, const uint x,
+                   const uint y, const uint c)
+{
+    const double sx = (x + 0.5) * xScale - 0.5;
+    const double sy = (y + 0.5) * yScale - 0.5;
+    double value = 0;
+    for (int j = std::floor(sy) - 1; j <= std::floor(sy) + 2; ++j)
+    {
+        const int row = std::min(std::max(j, 0), static_cast<int>(frame.height) - 1);
+        for (int i = std::floor(sx) - 1; i <= std::floor(sx) + 2; ++i)
+        {
+            const int col = std::min(std::max(i, 0), static_cast<int>(frame.width) - 1);
+            value += cubicWeight(sx - i) * cubicWeight(sy - j)
+                * frame.pixels.at((static_cast<size_t>(row) * frame.width + col) * 3 + c);
+        }
+    }
+    return std::min(std::max(value, 0.0), 255.0);
+}
+
+void testCubicAgainstReference()
+{
+    const Frame frame = readPPM(g_DataDir + "/letterbox_src.ppm");
+    LetterboxPlanCache cache(4, LetterboxFilter::kCUBIC);
+    for (const auto& size : {std::make_pair(32u, 32u), std::make_pair(96u, 64u),
+                             std::make_pair(40u, 80u), std::make_pair(61u, 37u)})
+    {
+        const LetterboxPlan& plan = cache.getPlan(frame.width, frame.height, size.first,
+                                                  size.second);
+        assert(plan.filter == LetterboxFilter::kCUBIC);
+        assert(plan.xTap0.empty() && plan.yTap0.empty());
+        for (uint i = 0; i < plan.resizeW; ++i)
+        {
+            float sum = 0;
+            for (uint k = 0; k < kLetterboxCubicTaps; ++k)
+                sum += plan.xCubicWeights.at(i * kLetterboxCubicTaps + k);
+            assert(std::fabs(sum - 1) < 1e-5f);
+        }
+
+        const size_t planeSize = plan.dstW * plan.dstH;
+        std::vector<float> floats(3 * planeSize);
+        std::vector<uint8_t> bytes(3 * planeSize);
+        letterboxToCHW(plan, frame.pixels.data(), frame.width * 3, true, floats.data());
+        letterboxToCHW(plan, frame.pixels.data(), frame.width * 3, true, bytes.data());
+        const double xScale = static_cast<double>(frame.width) / plan.resizeW;
+        const double yScale = static_cast<double>(frame.height) / plan.resizeH;
+        for (uint c = 0; c < 3; ++c)
+        {
+            for (uint y = 0; y < plan.dstH; ++y)
+            {
+                for (uint x = 0; x < plan.dstW; ++x)
+                {
+                    const bool inside = (x >= plan.xOffset) && (x < plan.xOffset + plan.resizeW)
+                        && (y >= plan.yOffset) && (y < plan.yOffset + plan.resizeH);
+                    // swapRB, the first plane holds the last channel of the frame
+                    const double expected = inside
+                        ? sampleCubic(frame, xScale, yScale, x - plan.xOffset, y - plan.yOffset,
+                                      2 - c)
+                        : kLetterboxPadValue;
+                    const size_t i = c * planeSize + y * plan.dstW + x;
+                    assert(std::fabs(floats.at(i) - expected) < 1e-3);
+                    assert(std::fabs(bytes.at(i) - floats.at(i)) <= 0.5f);
+                }
+            }
+        }
+
+        // at the size of the frame the taps land on pixel centres and copy the frame
+        if ((plan.dstW == frame.width) && (plan.dstH == frame.height))
+        {
+            assert((plan.resizeW == frame.width) && (plan.resizeH == frame.height));
+            std::vector<uint8_t> packed(3 * planeSize);
+            letterboxToCHW(plan, frame.pixels.data(), frame.width * 3, false, packed.data());
+            for (uint c = 0; c < 3; ++c)
+                for (size_t p = 0; p < planeSize; ++p)
+                    assert(packed.at(c * planeSize + p) == frame.pixels.at(p * 3 + c));
+        }
+    }
+}
+} // namespace
+
+int main(int argc, char** argv)
+{
+    assert((argc == 2) && "usage: letterbox_test <dir of the test data>");
+    g_DataDir = argv[1];
+    testGoldenBlobsThroughPlanCache();
+    testSingleEntryCache();
+    testCubicAgainstReference();
+    std::cout << "letterbox_test passed" << std::endl;
+    return 0;
+}
@@ -0,0 +1,296 @@
+/**
+MIT License
+
+Copyright (c) 2018 NVIDIA CORPORATION. All rights reserved.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*
+*/
+
+#include "nms.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <iostream>
+#include <random>
+#include <vector>
+
+namespace
+{
+const NMSType kTypes[] = {NMSType::kHARD, NMSType::kSOFT_LINEAR, NMSType::kSOFT_GAUSSIAN,
+                          NMSType::kDIOU};
+const NMSEngine kEngines[] = {NMSEngine::kGREEDY, NMSEngine::kGRID, NMSEngine::kSIMD};
+
+BBoxInfo makeBox(const float x1, const float y1, const float x2, const float y2,
+                 const float prob, const int label = 0)
+{
+    BBoxInfo b;
+    b.box = BBox{x1, y1, x2, y2};
+    b.label = label;
+    b.classId = label;
+    b.prob = prob;
+    return b;
+}
+
+// Proposals clustered around numBoxes / 8 objects of a 1280x720 frame, as decoded proposals are.
+// Scores are quantized so equal scores, and the tie-breaks between them, are exercised too.
+std::vector<BBoxInfo> makeProposals(const uint numBoxes, const uint numClasses,
+                                    std::mt19937& rng)
+{
+    std::uniform_real_distribution<float> uniform(0.0f, 1.0f);
+    const uint numObjects = std::max(numBoxes / 8, 1u);
+    std::vector<BBoxInfo> objects;
+    for (uint i = 0; i < numObjects; ++i)
+    {
+        const float w = 16 + 200 * uniform(rng);
+        const float h = 16 + 200 * uniform(rng);
+        const float x = (1280 - w) * uniform(rng);
+        const float y = (720 - h) * uniform(rng);
+        objects.push_back(makeBox(x, y, x + w, y + h, 0, rng() % numClasses));
+    }
+    std::vector<BBoxInfo> proposals;
+    for (uint i = 0; i < numBoxes; ++i)
+    {
+        BBoxInfo b = objects.at(rng() % numObjects);
+        const float w = b.box.x2 - b.box.x1;
+        const float h = b.box.y2 - b.box.y1;
+        b.box.x1 += w * (0.3f * uniform(rng) - 0.15f);
+        b.box.y1 += h * (0.3f * uniform(rng) - 0.15f);
+        b.box.x2 += w * (0.3f * uniform(rng) - 0.15f);
+        b.box.y2 += h * (0.3f * uniform(rng) - 0.15f);
+        b.prob = std::round(10 + 90 * uniform(rng)) / 100.0f;
+        proposals.push_back(b);
+    }
+    return proposals;
+}
+
+bool sameDetections(const std::vector<BBoxInfo>& a, const std::vector<BBoxInfo>& b)
+{
+    if (a.size() != b.size()) return false;
+    for (uint i = 0; i < a.size(); ++i)
+    {
+        if ((a.at(i).box.x1 != b.at(i).box.x1) || (a.at(i).box.y1 != b.at(i).box.y1)
+            || (a.at(i).box.x2 != b.at(i).box.x2) || (a.at(i).box.y2 != b.at(i).box.y2)
+            || (a.at(i).label != b.at(i).label) || (a.at(i).classId != b.at(i).classId)
+            || (a.at(i).prob != b.at(i).prob))
+            return false;
+    }
+    return true;
+}
+
+std::vector<BBoxInfo> runNMS(const NMSParams& params, const std::vector<BBoxInfo>& proposals,
+                             const uint numClasses)
+{
+    DetectionArena arena;
+    arena.proposals = proposals;
+    nmsAllClasses(params, numClasses, arena);
+    return arena.detections;
+}
+
+NMSParams getParams(const NMSType type, const NMSEngine engine, const bool batched,
+                    const uint maxDetections = 0)
+{
+    return NMSParams{0.45f, maxDetections, engine, batched, type, 0.5f, 0.1f};
+}
+
+void testHandComputed()
+{
+    // b overlaps a with an IoU of 90 / 110, c overlaps nothing
+    const std::vector<BBoxInfo> boxes{makeBox(0, 0, 10, 10, 0.9f), makeBox(1, 0, 11, 10, 0.8f),
+                                      makeBox(20, 20, 30, 30, 0.7f)};
+    const float iou = 90.0f / 110.0f;
+
+    std::vector<BBoxInfo> kept = runNMS(getParams(NMSType::kHARD, NMSEngine::kGREEDY, false),
+                                        boxes, 1);
+    assert(kept.size() == 2);
+    assert(kept.at(0).prob == 0.9f && kept.at(1).prob == 0.7f);
+
+    // soft-NMS keeps b with a decayed score, after c
+    kept = runNMS(getParams(NMSType::kSOFT_LINEAR, NMSEngine::kGREEDY, false), boxes, 1);
+    assert(kept.size() == 3);
+    assert(kept.at(1).prob == 0.7f);
+    assert(std::fabs(kept.at(2).prob - 0.8f * (1 - iou)) < 1e-6f);
+    kept = runNMS(getParams(NMSType::kSOFT_GAUSSIAN, NMSEngine::kGREEDY, false), boxes, 1);
+    assert(kept.size() == 3);
+    assert(kept.at(1).prob == 0.7f);
+    assert(std::fabs(kept.at(2).prob - 0.8f * std::exp(-iou * iou / 0.5f)) < 1e-6f);
+    // decayed below probThresh, the box is dropped
+    NMSParams strict = getParams(NMSType::kSOFT_LINEAR, NMSEngine::kGREEDY, false);
+    strict.probThresh = 0.2f;
+    assert(runNMS(strict, boxes, 1).size() == 2);
+
+    // d overlaps a with an IoU of 60 / 140, above the threshold, but the distance between their
+    // centers, 16 / 296 of the enclosing diagonal, brings it below for DIoU
+    const std::vector<BBoxInfo> neighbours{makeBox(0, 0, 10, 10, 0.9f),
+                                           makeBox(4, 0, 14, 10, 0.8f)};
+    NMSParams params = getParams(NMSType::kHARD, NMSEngine::kGREEDY, false);
+    params.nmsThresh = 0.4f;
+    assert(runNMS(params, neighbours, 1).size() == 1);
+    params.type = NMSType::kDIOU;
+    assert(runNMS(params, neighbours, 1).size() == 2);
+
+    // boxes of different classes never suppress each other
+    std::vector<BBoxInfo> twoClasses = boxes;
+    twoClasses.at(1).label = 1;
+    assert(runNMS(getParams(NMSType::kHARD, NMSEngine::kGREEDY, false), twoClasses, 2).size()
+           == 3);
+    assert(runNMS(getParams(NMSType::kHARD, NMSEngine::kGREEDY, true), twoClasses, 2).size()
+           == 3);
+}
+
+void testBatchedMatchesPerClass()
+{
+    std::mt19937 rng(1234);
+    for (const uint numClasses : {1u, 6u, 80u})
+    {
+        for (const uint numBoxes : {0u, 1u, 40u, 300u, 1000u})
+        {
+            const std::vector<BBoxInfo> proposals = makeProposals(numBoxes, numClasses, rng);
+            for (const NMSType type : kTypes)
+            {
+                for (const NMSEngine engine : kEngines)
+                {
+                    for (const uint maxDetections : {0u, 20u})
+                    {
+                        const std::vector<BBoxInfo> perClass = runNMS(
+                            getParams(type, engine, false, maxDetections), proposals, numClasses);
+                        const std::vector<BBoxInfo> batched = runNMS(
+                            getParams(type, engine, true, maxDetections), proposals, numClasses);
+                        assert(sameDetections(perClass, batched));
+                    }
+                }
+            }
+        }
+    }
+}
+
+void checkEnginesMatchGreedy(const std::vector<BBoxInfo>& boxes, const float nmsThresh)
+{
+    std::vector<uint> order;
+    NMSGrid grid;
+    NMSKeptBoxes keptBoxes;
+    std::vector<BBoxInfo> greedy, gridOut, simd;
+    nonMaximumSuppression(nmsThresh, boxes, order, greedy);
+    gridNonMaximumSuppression(nmsThresh, boxes, order, grid, gridOut);
+    simdNonMaximumSuppression(nmsThresh, boxes, order, keptBoxes, simd);
+    assert(sameDetections(greedy, gridOut));
+    assert(sameDetections(greedy, simd));
+    assert(sameDetections(greedy, nonMaximumSuppression(nmsThresh, boxes)));
+}
+
+void testEnginesMatchGreedy()
+{
+    std::mt19937 rng(5678);
+    // around the number of proposals below which the grid engine falls back to the greedy loop
+    for (const uint numBoxes : {1u, 10u, 63u, 64u, 65u, 500u, 2000u})
+    {
+        const std::vector<BBoxInfo> boxes = makeProposals(numBoxes, 1, rng);
+        for (const float nmsThresh : {0.0f, 0.3f, 0.45f, 0.7f, 1.0f})
+            checkEnginesMatchGreedy(boxes, nmsThresh);
+        // a negative threshold suppresses everything but the first box, also a fallback
+        checkEnginesMatchGreedy(boxes, -1.0f);
+
+        // a few inverted boxes make both engines fall back to the greedy loop
+        std::vector<BBoxInfo> inverted = boxes;
+        for (uint i = 0; i < inverted.size(); i += 7)
+            std::swap(inverted.at(i).box.x1, inverted.at(i).box.x2);
+        checkEnginesMatchGreedy(inverted, 0.45f);
+        for (uint i = 3; i < inverted.size(); i += 11)
+            std::swap(inverted.at(i).box.y1, inverted.at(i).box.y2);
+        checkEnginesMatchGreedy(inverted, 0.45f);
+    }
+
+    // the arenas are reused across frames of different sizes, as in the plugin
+    DetectionArena arena;
+    for (const uint numBoxes : {2000u, 10u, 500u, 64u})
+    {
+        arena.proposals = makeProposals(numBoxes, 80, rng);
+        const std::vector<BBoxInfo> greedy = runNMS(
+            getParams(NMSType::kHARD, NMSEngine::kGREEDY, false), arena.proposals, 80);
+        for (const NMSEngine engine : {NMSEngine::kGRID, NMSEngine::kSIMD})
+        {
+            nmsAllClasses(getParams(NMSType::kHARD, engine, false), 80, arena);
+            assert(sameDetections(greedy, arena.detections));
+        }
+    }
+}
+
+bool byProb(const BBoxInfo& a, const BBoxInfo& b) { return a.prob > b.prob; }
+
+void testTopK()
+{
+    std::mt19937 rng(42);
+    const std::vector<BBoxInfo> proposals = makeProposals(500, 1, rng);
+    std::vector<float> probs;
+    for (const BBoxInfo& b : proposals) probs.push_back(b.prob);
+    std::sort(probs.begin(), probs.end(), std::greater<float>());
+
+    // selectTopK keeps the k best scores, in no particular order
+    for (const uint k : {1u, 10u, 100u, 499u})
+    {
+        std::vector<BBoxInfo> top = proposals;
+        selectTopK(k, top);
+        assert(top.size() == k);
+        std::vector<float> topProbs;
+        for (const BBoxInfo& b : top) topProbs.push_back(b.prob);
+        std::sort(topProbs.begin(), topProbs.end(), std::greater<float>());
+        assert(std::equal(topProbs.begin(), topProbs.end(), probs.begin()));
+    }
+    // 0 and k >= size keep everything untouched
+    for (const uint k : {0u, 500u, 501u})
+    {
+        std::vector<BBoxInfo> all = proposals;
+        selectTopK(k, all);
+        assert(sameDetections(all, proposals));
+    }
+
+    // maxDetections keeps the highest scoring detections, sorted by score
+    for (const NMSType type : kTypes)
+    {
+        const std::vector<BBoxInfo> proposals80 = makeProposals(1000, 80, rng);
+        std::vector<BBoxInfo> all = runNMS(getParams(type, NMSEngine::kGREEDY, false),
+                                           proposals80, 80);
+        assert(all.size() > 25);
+        for (const uint maxDetections : {1u, 25u})
+        {
+            const std::vector<BBoxInfo> capped = runNMS(
+                getParams(type, NMSEngine::kGREEDY, false, maxDetections), proposals80, 80);
+            assert(capped.size() == maxDetections);
+            assert(std::is_sorted(capped.begin(), capped.end(), byProb));
+            std::stable_sort(all.begin(), all.end(), byProb);
+            for (uint i = 0; i < maxDetections; ++i) assert(capped.at(i).prob == all.at(i).prob);
+        }
+        const uint numAll = all.size();
+        assert(runNMS(getParams(type, NMSEngine::kGREEDY, false, numAll), proposals80, 80).size()
+               == numAll);
+    }
+}
+} // namespace
+
+int main()
+{
+    testHandComputed();
+    testBatchedMatchesPerClass();
+    testEnginesMatchGreedy();
+    testTopK();
+
+    std::cout << "nms_test passed" << std::endl;
+    return 0;
+}
@@ -0,0 +1,228 @@
+/**
+MIT License
+
+Copyright (c) 2018 NVIDIA CORPORATION. All rights reserved.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*
+*/
+
+#include "pipeline.h"
+
+#include <atomic>
+#include <cassert>
+#include <chrono>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+namespace
+{
+struct Item
+{
+    uint index;
+    // number of images the item stands for
+    uint count;
+    uint value;
+};
+
+void sleepUs(const uint us) { std::this_thread::sleep_for(std::chrono::microseconds(us)); }
+
+void testQueueCloseAndDrain()
+{
+    BoundedQueue<uint> queue(4);
+    for (uint i = 0; i < 3; ++i) assert(queue.push(i));
+    queue.close();
+    // items pushed after the close are dropped, the ones already queued are still delivered
+    assert(!queue.push(100));
+    uint item = 0;
+    for (uint i = 0; i < 3; ++i)
+    {
+        assert(queue.pop(item));
+        assert(item == i);
+    }
+    assert(!queue.pop(item));
+    assert(!queue.pop(item));
+}
+
+void testQueueCloseWakesWaiters()
+{
+    // a producer blocked on a full queue gives up when it is closed
+    BoundedQueue<uint> full(1);
+    assert(full.push(0));
+    bool pushed = true;
+    std::thread producer([&full, &pushed]() { pushed = full.push(1); });
+    sleepUs(10000);
+    full.close();
+    producer.join();
+    assert(!pushed);
+
+    // a consumer blocked on an empty queue returns once it is closed
+    BoundedQueue<uint> empty(1);
+    bool popped = true;
+    std::thread consumer([&empty, &popped]() {
+        uint item;
+        popped = empty.pop(item);
+    });
+    sleepUs(10000);
+    empty.close();
+    consumer.join();
+    assert(!popped);
+}
+
+void testQueueBoundsItemsInFlight()
+{
+    BoundedQueue<uint> queue(2);
+    std::atomic<uint> numPushed(0);
+    std::thread producer([&queue, &numPushed]() {
+        for (uint i = 0; i < 5; ++i)
+        {
+            queue.push(i);
+            ++numPushed;
+        }
+        queue.close();
+    });
+    sleepUs(20000);
+    // the producer can't get ahead of the consumer by more than the capacity
+    assert(numPushed <= 2);
+    uint item = 0;
+    for (uint i = 0; i < 5; ++i) assert(queue.pop(item) && (item == i));
+    assert(!queue.pop(item));
+    producer.join();
+    assert(numPushed == 5);
+}
+
+void testStagesKeepOrderThroughReorder()
+{
+    const uint numItems = 200;
+    BoundedQueue<Item> input(3), middle(3), output(3);
+    std::thread feeder([&input, numItems]() {
+        for (uint i = 0; i < numItems; ++i) input.push(Item{i, 1 + i % 4, i});
+        input.close();
+    });
+
+    // uneven work per item, so items overtake each other inside both stages
+    PipelineStage<Item> first(
+        "first", 4, input, middle,
+        [](Item& item) {
+            sleepUs(50 * ((item.index * 7) % 5));
+            item.value = item.value * 2;
+        },
+        [](const Item& item) { return item.count; });
+    PipelineStage<Item> second("second", 3, middle, output, [](Item& item) {
+        sleepUs(50 * ((item.index * 3) % 4));
+        item.value = item.value + 1;
+    });
+
+    ReorderBuffer<Item> reorder;
+    std::vector<uint> written;
+    Item item;
+    while (output.pop(item))
+    {
+        reorder.push(item.index, item);
+        Item next;
+        while (reorder.pop(next))
+        {
+            assert(next.value == next.index * 2 + 1);
+            written.push_back(next.index);
+        }
+    }
+    feeder.join();
+    first.join();
+    second.join();
+
+    assert(reorder.getNumPending() == 0);
+    assert(written.size() == numItems);
+    for (uint i = 0; i < numItems; ++i) assert(written.at(i) == i);
+
+    // the first stage counts images, the second one items
+    uint numImages = 0;
+    for (uint i = 0; i < numItems; ++i) numImages += 1 + i % 4;
+    const PipelineStageStats& firstStats = first.getStats();
+    assert(firstStats.name == "first");
+    assert(firstStats.numThreads == 4);
+    assert(firstStats.numItems == numImages);
+    assert(firstStats.busyMs > 0.0);
+    assert(firstStats.getThroughput() > 0.0);
+    const PipelineStageStats& secondStats = second.getStats();
+    assert(secondStats.numThreads == 3);
+    assert(secondStats.numItems == numItems);
+}
+
+void testReorderBuffer()
+{
+    ReorderBuffer<uint> reorder;
+    uint item = 0;
+    assert(!reorder.pop(item));
+    reorder.push(2, 20);
+    reorder.push(1, 10);
+    // nothing is released until item 0 arrives
+    assert(!reorder.pop(item));
+    assert(reorder.getNumPending() == 2);
+    reorder.push(0, 0);
+    for (uint i = 0; i < 3; ++i)
+    {
+        assert(reorder.pop(item));
+        assert(item == i * 10);
+    }
+    assert(!reorder.pop(item));
+    reorder.push(4, 40);
+    assert(!reorder.pop(item));
+    reorder.push(3, 30);
+    assert(reorder.pop(item) && (item == 30));
+    assert(reorder.pop(item) && (item == 40));
+    assert(reorder.getNumPending() == 0);
+}
+
+void testStageStats()
+{
+    BoundedQueue<Item> input(8), output(8);
+    for (uint i = 0; i < 8; ++i) input.push(Item{i, 2, i});
+    input.close();
+    PipelineStage<Item> stage(
+        "sleep", 0, input, output, [](Item&) { sleepUs(2000); },
+        [](const Item& item) { return item.count; });
+    stage.join();
+
+    // at least one thread, and the output closes with the stage
+    const PipelineStageStats& stats = stage.getStats();
+    assert(stats.numThreads == 1);
+    assert(stats.numItems == 16);
+    assert(stats.busyMs >= 16.0);
+    assert(stats.starvedMs >= 0.0);
+    assert(stats.blockedMs >= 0.0);
+    // 2 images every 2 ms at most
+    assert(stats.getThroughput() <= 1000.0);
+    Item item;
+    for (uint i = 0; i < 8; ++i) assert(output.pop(item) && (item.index == i));
+    assert(!output.pop(item));
+}
+} // namespace
+
+int main()
+{
+    testQueueCloseAndDrain();
+    testQueueCloseWakesWaiters();
+    testQueueBoundsItemsInFlight();
+    testReorderBuffer();
+    testStagesKeepOrderThroughReorder();
+    testStageStats();
+    std::cout << "pipeline_test passed" << std::endl;
+    return 0;
+}
@@ -0,0 +1,142 @@
+/**
+MIT License
+
+Copyright (c) 2018 NVIDIA CORPORATION. All rights reserved.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*
+*/
+
+#include "resolution_controller.h"
+
+#include <cassert>
+#include <iostream>
+#include <random>
+#include <vector>
+
+namespace
+{
+// relative MACs of three input sizes of one network
+const std::vector<double> kLevelCosts{1.0, 2.0, 4.0};
+
+ResolutionControllerParams getParams()
+{
+    ResolutionControllerParams params;
+    params.latencySLOMs = 10.0f;
+    params.headroom = 0.8f;
+    params.windowSize = 4;
+    return params;
+}
+
+// Simulated engine, every batch takes msPerCost times the cost of the level it ran at
+uint runBatches(ResolutionController& controller, const float msPerCost, const uint numBatches)
+{
+    for (uint b = 0; b < numBatches; ++b)
+        controller.update(msPerCost * kLevelCosts.at(controller.getLevel()));
+    return controller.getLevel();
+}
+
+void testDropOnSLO()
+{
+    ResolutionController controller(kLevelCosts, getParams());
+    assert(controller.getNumLevels() == 3);
+    assert(controller.getLevel() == 2);
+
+    // 16 ms at the largest level, nothing happens before a full window has been measured
+    for (uint b = 0; b < 3; ++b) assert(controller.update(16.0f) == 2);
+    // predicted 8 ms at level 1 meets the SLO, so it drops there rather than to level 0
+    assert(controller.update(16.0f) == 1);
+    assert(controller.getNumSwitches() == 1);
+
+    // a network that can't meet the SLO at all ends up at the cheapest level and stays there
+    ResolutionController slow(kLevelCosts, getParams());
+    assert(runBatches(slow, 20.0f, 4) == 0);
+    assert(runBatches(slow, 20.0f, 100) == 0);
+    assert(slow.getNumSwitches() == 1);
+}
+
+void testRaiseUnderHeadroom()
+{
+    // drop to the cheapest level first
+    ResolutionController tight(kLevelCosts, getParams());
+    assert(runBatches(tight, 12.0f, 4) == 0);
+    // 9 ms predicted at level 1 meets the SLO but not the headroom, so the level is kept
+    assert(runBatches(tight, 4.5f, 40) == 0);
+    assert(tight.getNumSwitches() == 1);
+
+    ResolutionController controller(kLevelCosts, getParams());
+    assert(runBatches(controller, 12.0f, 4) == 0);
+    // both larger levels are predicted under the headroom, but only one level is raised per
+    // window
+    assert(runBatches(controller, 1.5f, 4) == 1);
+    assert(controller.getNumSwitches() == 2);
+    assert(runBatches(controller, 1.5f, 3) == 1);
+    assert(runBatches(controller, 1.5f, 1) == 2);
+    assert(controller.getNumSwitches() == 3);
+}
+
+void testWindowResetOnSwitch()
+{
+    ResolutionController controller(kLevelCosts, getParams());
+    assert(runBatches(controller, 4.0f, 4) == 1);
+
+    // the slow batches measured at level 2 don't count at level 1, which needs a window of its
+    // own before the next decision
+    for (uint b = 0; b < 3; ++b) assert(controller.update(100.0f) == 1);
+    assert(controller.update(100.0f) == 0);
+    assert(controller.getNumSwitches() == 2);
+
+    // same after a raise, fast batches at level 0 don't move level 1 further up
+    for (uint b = 0; b < 4; ++b) controller.update(1.0f);
+    assert(controller.getLevel() == 1);
+    for (uint b = 0; b < 3; ++b) assert(controller.update(2.0f) == 1);
+    assert(controller.update(2.0f) == 2);
+}
+
+void testBoundedSwitchesUnderNoise()
+{
+    std::mt19937 rng(1234);
+    std::uniform_real_distribution<float> noise(0.85f, 1.15f);
+
+    // level 2 runs around the SLO, level 1 around half of it. Once dropped, level 2 is
+    // predicted above the headroom, so noise alone must not make it switch back and forth
+    ResolutionController controller(kLevelCosts, getParams());
+    for (uint b = 0; b < 10000; ++b)
+        controller.update(2.45f * kLevelCosts.at(controller.getLevel()) * noise(rng));
+    assert(controller.getLevel() == 1);
+    assert(controller.getNumSwitches() <= 2);
+
+    // a level comfortably under the SLO never switches at all
+    ResolutionController fast(kLevelCosts, getParams());
+    for (uint b = 0; b < 10000; ++b)
+        fast.update(1.5f * kLevelCosts.at(fast.getLevel()) * noise(rng));
+    assert(fast.getLevel() == 2);
+    assert(fast.getNumSwitches() == 0);
+}
+} // namespace
+
+int main()
+{
+    testDropOnSLO();
+    testRaiseUnderHeadroom();
+    testWindowResetOnSwitch();
+    testBoundedSwitchesUnderNoise();
+    std::cout << "resolution_controller_test passed" << std::endl;
+    return 0;
+}
@@ -0,0 +1,164 @@
+/**
+MIT License
+
+Copyright (c) 2018 NVIDIA CORPORATION. All rights reserved.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*
+*/
+
+#include "mapped_file.h"
+#include "weights_cache.h"
+
+#include <cassert>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <fcntl.h>
+#include <fstream>
+#include <iostream>
+#include <stdint.h>
+#include <string>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <vector>
+
+namespace
+{
+std::string g_TmpDir;
+
+// a batch normalized conv feeding a linear one, 496 + 306 darknet weights
+const std::string kCfg = "[net]\nwidth=32\nheight=32\nchannels=3\n\n"
+                         "[convolutional]\nbatch_normalize=1\nfilters=16\nsize=3\nstride=1\npad=1\n"
+                         "activation=leaky\n\n"
+                         "[convolutional]\nfilters=18\nsize=1\nstride=1\npad=1\n"
+                         "activation=linear\n\n"
+                         "[yolo]\nmask=0,1,2\nanchors=10,14,23,27,37,58\nclasses=1\nnum=3\n";
+const uint kNumWeights = 496 + 306;
+
+void writeWeights(const std::string& path, const uint numWeights)
+{
+    std::ofstream out(path, std::ios_base::binary | std::ios_base::trunc);
+    const int32_t version[3] = {0, 2, 0};
+    const uint64_t seen = 0;
+    out.write(reinterpret_cast<const char*>(version), sizeof(version));
+    out.write(reinterpret_cast<const char*>(&seen), sizeof(seen));
+    for (uint i = 0; i < numWeights; ++i)
+    {
+        // positive, so the folded running variances are valid
+        const float value = 0.5f + (i % 97) / 97.0f;
+        out.write(reinterpret_cast<const char*>(&value), sizeof(value));
+    }
+}
+
+void setMtime(const std::string& path, const time_t seconds)
+{
+    const struct timespec times[2] = {{seconds, 0}, {seconds, 0}};
+    assert(utimensat(AT_FDCWD, path.c_str(), times, 0) == 0);
+}
+
+void testFoldedLayers(const WeightsCache& cache, const std::string& wtsFilePath)
+{
+    DarknetWeights weights(wtsFilePath);
+    const float* src = weights.data();
+    assert(weights.size() == kNumWeights);
+
+    const CachedConvWeights* bn = cache.getLayer(1);
+    assert(bn && bn->batchNormalize && bn->filters == 16 && bn->kernelVolume == 27);
+    assert(bn->numDarknetWeights() == 496);
+    std::vector<float> shift(16), scale(16), power(16);
+    foldBatchNorm(16, src, src + 16, src + 32, src + 48, shift.data(), scale.data(),
+                  power.data());
+    for (uint i = 0; i < 16; ++i)
+    {
+        assert(bn->bias[i] == shift[i] && bn->scale[i] == scale[i] && bn->power[i] == power[i]);
+    }
+    for (uint i = 0; i < 16 * 27; ++i) assert(bn->kernel[i] == src[64 + i]);
+
+    const CachedConvWeights* linear = cache.getLayer(2);
+    assert(linear && !linear->batchNormalize && linear->filters == 18);
+    assert(!linear->scale && !linear->power);
+    for (uint i = 0; i < 18; ++i) assert(linear->bias[i] == src[496 + i]);
+    for (uint i = 0; i < 18 * 16; ++i) assert(linear->kernel[i] == src[496 + 18 + i]);
+
+    assert(cache.getLayer(0) == nullptr);
+    assert(cache.getLayer(3) == nullptr);
+}
+
+void testValidation()
+{
+    const std::string cfgFilePath = g_TmpDir + "/net.cfg";
+    const std::string wtsFilePath = g_TmpDir + "/net.weights";
+    const std::string cachePath = g_TmpDir + "/net.wcache";
+    std::ofstream(cfgFilePath) << kCfg;
+    writeWeights(wtsFilePath, kNumWeights);
+    setMtime(wtsFilePath, 1000000000);
+
+    assert(loadWeightsCache(cachePath, cfgFilePath, wtsFilePath) == nullptr);
+    writeWeightsCache(cachePath, cfgFilePath, wtsFilePath);
+    std::unique_ptr<WeightsCache> cache = loadWeightsCache(cachePath, cfgFilePath, wtsFilePath);
+    assert(cache);
+    // the checksum of the .weights is recorded once, so engine cache keys don't rehash them
+    assert(cache->getWeightsChecksum() == fileChecksum(wtsFilePath));
+    assert(cache->getCfgChecksum() == fileChecksum(cfgFilePath));
+    assert(cache->getWeightsMtime() == 1000000000ull * 1000000000ull);
+    testFoldedLayers(*cache, wtsFilePath);
+
+    // touching the .weights invalidates the cache, even with the same content
+    setMtime(wtsFilePath, 1000000001);
+    assert(loadWeightsCache(cachePath, cfgFilePath, wtsFilePath) == nullptr);
+    setMtime(wtsFilePath, 1000000000);
+    assert(loadWeightsCache(cachePath, cfgFilePath, wtsFilePath) != nullptr);
+
+    // so does a .weights of another size at the same mtime
+    writeWeights(wtsFilePath, kNumWeights + 1);
+    setMtime(wtsFilePath, 1000000000);
+    assert(loadWeightsCache(cachePath, cfgFilePath, wtsFilePath) == nullptr);
+    writeWeights(wtsFilePath, kNumWeights);
+    setMtime(wtsFilePath, 1000000000);
+    assert(loadWeightsCache(cachePath, cfgFilePath, wtsFilePath) != nullptr);
+
+    // and any change to the cfg
+    std::ofstream(cfgFilePath) << kCfg << "\n";
+    assert(loadWeightsCache(cachePath, cfgFilePath, wtsFilePath) == nullptr);
+    writeWeightsCache(cachePath, cfgFilePath, wtsFilePath);
+    assert(loadWeightsCache(cachePath, cfgFilePath, wtsFilePath) != nullptr);
+
+    // files of another format or version are not used
+    std::ofstream(cachePath) << "not a weights cache";
+    assert(loadWeightsCache(cachePath, cfgFilePath, wtsFilePath) == nullptr);
+
+    std::remove(cfgFilePath.c_str());
+    std::remove(wtsFilePath.c_str());
+    std::remove(cachePath.c_str());
+}
+} // namespace
+
+int main()
+{
+    char tmpDir[] = "/tmp/weights_cache_test.XXXXXX";
+    assert(mkdtemp(tmpDir) != nullptr);
+    g_TmpDir = tmpDir;
+
+    testValidation();
+
+    rmdir(g_TmpDir.c_str());
+    std::cout << "weights_cache_test passed" << std::endl;
+    return 0;
+}
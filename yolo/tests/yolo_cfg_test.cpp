@@ -0,0 +1,306 @@
+/**
+MIT License
+
+Copyright (c) 2018 NVIDIA CORPORATION. All rights reserved.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*
+*/
+
+#include "yolo_cfg.h"
+
+#include <cassert>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <signal.h>
+#include <string>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <vector>
+
+namespace
+{
+std::string g_DataDir;
+std::string g_TmpDir;
+
+char getKind(const LayerType type)
+{
+    switch (type)
+    {
+    case LayerType::kConvolutional: return 'c';
+    case LayerType::kMaxpool: return 'm';
+    case LayerType::kRoute: return 'r';
+    case LayerType::kShortcut: return 's';
+    case LayerType::kUpsample: return 'u';
+    case LayerType::kYolo: return 'y';
+    case LayerType::kRegion: return 'R';
+    case LayerType::kReorg: return 'o';
+    }
+    return '?';
+}
+
+std::string getKinds(const NetworkDesc& network)
+{
+    std::string kinds;
+    for (const LayerDesc& layer : network.layers) kinds += getKind(layer.type);
+    return kinds;
+}
+
+bool hasShape(const LayerShape& shape, const uint c, const uint h, const uint w)
+{
+    return (shape.channels == c) && (shape.height == h) && (shape.width == w);
+}
+
+uint64_t getNumDarknetWeights(const NetworkDesc& network)
+{
+    uint64_t numWeights = 0;
+    for (const ConvLayerInfo& conv : getConvLayers(network)) numWeights += conv.numDarknetWeights();
+    return numWeights;
+}
+
+void checkOutput(const OutputLayerInfo& output, const uint layerIdx, const std::string& blobName,
+                 const uint gridW, const uint gridH, const uint stride, const uint numBBoxes)
+{
+    assert(output.layerIdx == layerIdx);
+    assert(output.blobName == blobName);
+    assert((output.gridW == gridW) && (output.gridH == gridH));
+    assert(output.stride == stride);
+    assert(output.numBBoxes == numBBoxes);
+    assert(output.numClasses == 80);
+    assert(output.volume == static_cast<uint64_t>(gridW) * gridH * numBBoxes * (5 + 80));
+}
+
+void testYoloV2()
+{
+    const NetworkDesc network = parseNetworkCfg(g_DataDir + "/yolov2.cfg");
+    assert((network.inputC == 3) && (network.inputH == 608) && (network.inputW == 608));
+    assert(getKinds(network) == "cmcmcccmcccmcccccmcccccccrcorccR");
+
+    const LayerDesc& passthrough = network.getLayer(26);
+    assert(passthrough.lineNumber == 186);
+    assert(passthrough.route.inputs == std::vector<uint>{16});
+    assert(hasShape(passthrough.output, 512, 38, 38));
+    assert(hasShape(network.getLayer(28).output, 256, 19, 19));
+    const LayerDesc& concat = network.getLayer(29);
+    assert((concat.route.inputs == std::vector<uint>{27, 24}));
+    assert(hasShape(concat.output, 1280, 19, 19));
+    assert(hasShape(network.layers.back().output, 425, 19, 19));
+
+    const std::vector<OutputLayerInfo> outputs = getOutputLayers(network);
+    assert(outputs.size() == 1);
+    checkOutput(outputs.at(0), 32, "region_32", 19, 19, 32, 5);
+    // yolov2.weights holds 50983561 floats after its header
+    assert(getNumDarknetWeights(network) == 50983561);
+}
+
+void testYoloV2Tiny()
+{
+    const NetworkDesc network = parseNetworkCfg(g_DataDir + "/yolov2-tiny.cfg");
+    assert((network.inputH == 416) && (network.inputW == 416));
+    assert(getKinds(network) == "cmcmcmcmcmcmcccR");
+    // the last maxpool keeps the grid with a stride of 1
+    assert(hasShape(network.getLayer(12).output, 512, 13, 13));
+    assert(hasShape(network.layers.back().output, 425, 13, 13));
+
+    const std::vector<OutputLayerInfo> outputs = getOutputLayers(network);
+    assert(outputs.size() == 1);
+    checkOutput(outputs.at(0), 16, "region_16", 13, 13, 32, 5);
+    assert(getNumDarknetWeights(network) == 11237145);
+}
+
+void testYoloV3()
+{
+    const NetworkDesc network = parseNetworkCfg(g_DataDir + "/yolov3.cfg");
+    assert((network.inputH == 416) && (network.inputW == 416));
+    assert(network.layers.size() == 107);
+    assert(getKinds(network)
+           == "ccccscccsccscccsccsccsccsccsccsccsccscccsccsccsccsccsccsccsccscccsccsccsccscccccc"
+              "cyrcurcccccccyrcurcccccccy");
+
+    // residual blocks add the output of the layer three blocks back
+    assert(network.getLayer(5).shortcut.input == 1);
+    assert(network.getLayer(75).shortcut.input == 71);
+    assert(network.getLayer(84).route.inputs == std::vector<uint>{79});
+    assert((network.getLayer(87).route.inputs == std::vector<uint>{85, 61}));
+    assert(hasShape(network.getLayer(87).output, 768, 26, 26));
+    assert(network.getLayer(96).route.inputs == std::vector<uint>{91});
+    assert((network.getLayer(99).route.inputs == std::vector<uint>{97, 36}));
+    assert(hasShape(network.getLayer(99).output, 384, 52, 52));
+
+    const std::vector<OutputLayerInfo> outputs = getOutputLayers(network);
+    assert(outputs.size() == 3);
+    checkOutput(outputs.at(0), 83, "yolo_83", 13, 13, 32, 3);
+    checkOutput(outputs.at(1), 95, "yolo_95", 26, 26, 16, 3);
+    checkOutput(outputs.at(2), 107, "yolo_107", 52, 52, 8, 3);
+    assert((network.getLayer(107).detection.masks == std::vector<uint>{0, 1, 2}));
+    assert(network.getLayer(107).detection.anchors.size() == 18);
+    assert(getNumDarknetWeights(network) == 62001757);
+}
+
+void testYoloV3Tiny()
+{
+    const NetworkDesc network = parseNetworkCfg(g_DataDir + "/yolov3-tiny.cfg");
+    assert(getKinds(network) == "cmcmcmcmcmcmccccyrcurccy");
+    assert(network.getLayer(18).route.inputs == std::vector<uint>{13});
+    assert((network.getLayer(21).route.inputs == std::vector<uint>{19, 8}));
+    assert(hasShape(network.getLayer(21).output, 384, 26, 26));
+    assert(hasShape(network.getLayer(20).output, 128, 26, 26));
+
+    const std::vector<OutputLayerInfo> outputs = getOutputLayers(network);
+    assert(outputs.size() == 2);
+    checkOutput(outputs.at(0), 17, "yolo_17", 13, 13, 32, 3);
+    checkOutput(outputs.at(1), 24, "yolo_24", 26, 26, 16, 3);
+    assert(getNumDarknetWeights(network) == 8858734);
+}
+
+void testRectangularInput()
+{
+    // a 16:9 input, every grid follows both sides of it
+    const NetworkDesc yoloV3 = parseNetworkCfg(g_DataDir + "/yolov3.cfg", 608, 352);
+    assert((yoloV3.inputW == 608) && (yoloV3.inputH == 352));
+    assert(hasShape(yoloV3.getLayer(87).output, 768, 22, 38));
+    assert(hasShape(yoloV3.getLayer(99).output, 384, 44, 76));
+    std::vector<OutputLayerInfo> outputs = getOutputLayers(yoloV3);
+    assert(outputs.size() == 3);
+    checkOutput(outputs.at(0), 83, "yolo_83", 19, 11, 32, 3);
+    checkOutput(outputs.at(1), 95, "yolo_95", 38, 22, 16, 3);
+    checkOutput(outputs.at(2), 107, "yolo_107", 76, 44, 8, 3);
+    // the weights don't depend on the input size
+    assert(getNumDarknetWeights(yoloV3) == 62001757);
+
+    outputs = getOutputLayers(parseNetworkCfg(g_DataDir + "/yolov3-tiny.cfg", 608, 352));
+    checkOutput(outputs.at(0), 17, "yolo_17", 19, 11, 32, 3);
+    checkOutput(outputs.at(1), 24, "yolo_24", 38, 22, 16, 3);
+
+    const NetworkDesc yoloV2 = parseNetworkCfg(g_DataDir + "/yolov2.cfg", 608, 352);
+    assert(hasShape(yoloV2.getLayer(28).output, 256, 11, 19));
+    outputs = getOutputLayers(yoloV2);
+    checkOutput(outputs.at(0), 32, "region_32", 19, 11, 32, 5);
+}
+
+// Parses a cfg in a child process, as cfg errors abort, and checks that it reported expected on
+// the given line
+void expectParseError(const std::string& name, const std::string& cfgFilePath, const uint inputW,
+                      const uint inputH, const uint lineNumber, const std::string& expected)
+{
+    int fds[2];
+    assert(pipe(fds) == 0);
+    const pid_t pid = fork();
+    assert(pid != -1);
+    if (pid == 0)
+    {
+        dup2(fds[1], STDOUT_FILENO);
+        // keep the assert message of the child out of the test output
+        assert(freopen("/dev/null", "w", stderr) != nullptr);
+        close(fds[0]);
+        parseNetworkCfg(cfgFilePath, inputW, inputH);
+        std::cout << "parsed" << std::endl;
+        _exit(0);
+    }
+    close(fds[1]);
+    std::string output;
+    char buf[256];
+    ssize_t n;
+    while ((n = read(fds[0], buf, sizeof(buf))) > 0) output.append(buf, n);
+    close(fds[0]);
+    int status = 0;
+    assert(waitpid(pid, &status, 0) == pid);
+
+    const std::string prefix = cfgFilePath + ":" + std::to_string(lineNumber) + ": " + expected;
+    if (!WIFSIGNALED(status) || (WTERMSIG(status) != SIGABRT)
+        || (output.compare(0, prefix.size(), prefix) != 0))
+    {
+        std::cout << name << ": expected '" << prefix << "', got '" << output << "'"
+                  << std::endl;
+        assert(0);
+    }
+}
+
+void expectCfgError(const std::string& name, const std::string& cfg, const uint lineNumber,
+                    const std::string& expected)
+{
+    const std::string cfgFilePath = g_TmpDir + "/" + name + ".cfg";
+    std::ofstream(cfgFilePath) << cfg;
+    expectParseError(name, cfgFilePath, 0, 0, lineNumber, expected);
+    std::remove(cfgFilePath.c_str());
+}
+
+const std::string kNet = "[net]\nwidth=416\nheight=416\nchannels=3\n\n";
+// lines 6 to 13 when following kNet
+const std::string kConv
+    = "[convolutional]\nbatch_normalize=1\nfilters=16\nsize=3\nstride=1\npad=1\n"
+      "activation=leaky\n\n";
+
+void testMalformedCfgs()
+{
+    expectCfgError("no_net", "[convolutional]\nfilters=16\n", 1,
+                   "the first section has to be [net]");
+    expectCfgError("route_out_of_range", kNet + kConv + "[route]\nlayers=-4\n", 15,
+                   "[route] 'layers' refers to layer -4, which is out of range");
+    expectCfgError("duplicate_key",
+                   kNet + "[convolutional]\nfilters=16\nsize=3\nfilters=32\n", 9,
+                   "duplicate 'filters', first set on line 7");
+    expectCfgError("missing_key", kNet + "[convolutional]\nsize=3\nstride=1\n", 6,
+                   "[convolutional] missing 'filters'");
+    expectCfgError("not_an_integer",
+                   kNet + "[convolutional]\nfilters=16\nsize=three\n", 8,
+                   "[convolutional] 'size' expects an integer, got 'three'");
+    expectCfgError("unsupported_layer", kNet + "[dropout]\nprobability=.5\n", 6,
+                   "[dropout] unsupported layer type");
+    expectCfgError("no_key_value", kNet + "[maxpool]\nsize 2\n", 7,
+                   "expected key=value, got 'size 2'");
+    expectCfgError("anchor_count",
+                   kNet
+                       + "[convolutional]\nfilters=255\nsize=1\nstride=1\npad=1\n"
+                         "activation=linear\n\n[yolo]\nmask=0,1,2\nanchors=10,13,16,30\n"
+                         "classes=80\nnum=3\n",
+                   15, "[yolo] expected 3 anchor pairs, got 4 values");
+    expectCfgError("no_output", kNet + kConv, 1, "[net] the network has no yolo or region layer");
+
+    // input sizes the strides of the network don't divide are reported on the first layer whose
+    // grid they break
+    expectParseError("yolov3_600x350", g_DataDir + "/yolov3.cfg", 600, 350, 569,
+                     "[yolo] grid of 19x11 does not have the aspect ratio of the input, 600x350 "
+                     "is not divisible by the network stride");
+    expectParseError("yolov2_608x350", g_DataDir + "/yolov2.cfg", 608, 350, 197,
+                     "[reorg] grid of 38x21 is not divisible by the stride");
+}
+} // namespace
+
+int main(int argc, char** argv)
+{
+    assert((argc == 2) && "usage: yolo_cfg_test <dir of the test cfgs>");
+    g_DataDir = argv[1];
+    char tmpDir[] = "/tmp/yolo_cfg_test.XXXXXX";
+    assert(mkdtemp(tmpDir) != nullptr);
+    g_TmpDir = tmpDir;
+
+    testYoloV2();
+    testYoloV2Tiny();
+    testYoloV3();
+    testYoloV3Tiny();
+    testRectangularInput();
+    testMalformedCfgs();
+
+    rmdir(g_TmpDir.c_str());
+    std::cout << "yolo_cfg_test passed" << std::endl;
+    return 0;
+}
@@ -0,0 +1,320 @@
+/**
+MIT License
+
+Copyright (c) 2018 NVIDIA CORPORATION. All rights reserved.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*
+*/
+
+#include "yolo_activations.h"
+#include "yolo_cfg.h"
+#include "yolo_decode.h"
+
+#include <cassert>
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace
+{
+std::string g_DataDir;
+
+std::vector<int> getClassIds(const uint numClasses)
+{
+    std::vector<int> classIds(numClasses);
+    for (uint i = 0; i < numClasses; ++i) classIds.at(i) = 100 + i;
+    return classIds;
+}
+
+// Output tensor of a yolo layer of the given shape with the anchors of yolov3's first head
+TensorInfo getYoloTensor(const uint gridW, const uint gridH, const uint stride,
+                         const uint numClasses)
+{
+    TensorInfo tensor;
+    tensor.blobName = "yolo_test";
+    tensor.stride = stride;
+    tensor.gridW = gridW;
+    tensor.gridH = gridH;
+    tensor.numClasses = numClasses;
+    tensor.numBBoxes = 3;
+    tensor.volume = static_cast<uint64_t>(gridW) * gridH * tensor.numBBoxes * (5 + numClasses);
+    tensor.masks = {6, 7, 8};
+    tensor.anchors = {10, 13, 16, 30, 33, 23, 30, 61, 62, 45, 59, 119, 116, 90, 156, 198, 373, 326};
+    return tensor;
+}
+
+// Raw conv outputs, mostly background with a few confident cells
+std::vector<float> getRawTensor(const TensorInfo& tensor, std::mt19937& rng)
+{
+    std::normal_distribution<float> logits(-4.0f, 2.0f);
+    std::normal_distribution<float> boxes(0.0f, 0.5f);
+    const uint numGridCells = tensor.gridW * tensor.gridH;
+    const uint numChannels = 5 + tensor.numClasses;
+    std::vector<float> raw(tensor.volume);
+    for (uint b = 0; b < tensor.numBBoxes; ++b)
+        for (uint c = 0; c < numChannels; ++c)
+            for (uint i = 0; i < numGridCells; ++i)
+                raw.at(numGridCells * (b * numChannels + c) + i)
+                    = (c < 4) ? boxes(rng) : logits(rng);
+
+    // confident objects in every tenth cell
+    std::uniform_int_distribution<uint> label(0, tensor.numClasses - 1);
+    for (uint i = 0; i < numGridCells * tensor.numBBoxes; i += 10)
+    {
+        const uint b = i / numGridCells;
+        const uint cell = i % numGridCells;
+        raw.at(numGridCells * (b * numChannels + 4) + cell) = 3.0f;
+        raw.at(numGridCells * (b * numChannels + 5 + label(rng)) + cell) = 2.5f;
+    }
+    return raw;
+}
+
+bool isClose(const float a, const float b, const float tolerance)
+{
+    return std::fabs(a - b) <= tolerance * std::max(1.0f, std::fabs(b));
+}
+
+// The logit decode of raw outputs has to match decoding the output of the YoloLayerV3 plugin
+void checkRawDecodeMatchesActivated(const uint gridW, const uint gridH, const uint stride,
+                                    const uint numClasses, const float probThresh)
+{
+    std::mt19937 rng(numClasses * 1000 + gridW);
+    const TensorInfo tensor = getYoloTensor(gridW, gridH, stride, numClasses);
+    const std::vector<float> raw = getRawTensor(tensor, rng);
+    std::vector<float> activated(raw.size());
+    yoloLayerV3Activations(raw.data(), activated.data(), tensor.gridW, tensor.gridH,
+                           tensor.numClasses, tensor.numBBoxes);
+    // the element-wise helpers are the scalar activations applied to every value
+    for (uint i = 0; i < raw.size(); i += 97)
+    {
+        const uint c = (i / (gridW * gridH)) % (5 + numClasses);
+        const float expected = ((c == 2) || (c == 3)) ? std::exp(raw.at(i)) : sigmoid(raw.at(i));
+        assert(activated.at(i) == expected);
+    }
+
+    const std::vector<int> classIds = getClassIds(numClasses);
+    const DecodeParams params{gridW * stride, gridH * stride, 1280, 720, probThresh,
+                              classIds.data()};
+    std::vector<BBoxInfo> fromRaw, fromActivated;
+    const TensorDecoder rawDecoder = getTensorDecoder(tensor, false, true);
+    const TensorDecoder decoder = getTensorDecoder(tensor, false, false);
+    assert(rawDecoder != decoder);
+    rawDecoder(tensor, raw.data(), params, fromRaw);
+    decoder(tensor, activated.data(), params, fromActivated);
+
+    assert(!fromActivated.empty());
+    assert(fromRaw.size() == fromActivated.size());
+    for (uint i = 0; i < fromRaw.size(); ++i)
+    {
+        const BBoxInfo& r = fromRaw.at(i);
+        const BBoxInfo& a = fromActivated.at(i);
+        assert(r.label == a.label);
+        assert(r.classId == a.classId);
+        assert(r.classId == 100 + r.label);
+        assert(r.prob > probThresh);
+        assert(isClose(r.prob, a.prob, 1e-6f));
+        assert(isClose(r.box.x1, a.box.x1, 1e-5f));
+        assert(isClose(r.box.y1, a.box.y1, 1e-5f));
+        assert(isClose(r.box.x2, a.box.x2, 1e-5f));
+        assert(isClose(r.box.y2, a.box.y2, 1e-5f));
+    }
+}
+
+void testRawDecode()
+{
+    // the class count of the coco and voc heads
+    checkRawDecodeMatchesActivated(13, 13, 32, 80, 0.5f);
+    checkRawDecodeMatchesActivated(19, 11, 32, 80, 0.3f);
+    checkRawDecodeMatchesActivated(26, 26, 16, 20, 0.5f);
+}
+
+/**
+ * Writes a box given in image coordinates into the output of one anchor, the way the network
+ * would predict it, and checks that every decoder of the tensor maps it back to the image.
+ */
+void checkPlantedBox(const TensorInfo& tensor, const bool isRegion, const DecodeParams& params,
+                     const BBox& imageBox, const uint anchor, const uint label)
+{
+    const float scale = std::min(static_cast<float>(params.inputW) / params.imageW,
+                                 static_cast<float>(params.inputH) / params.imageH);
+    const float xOffset = (params.inputW - scale * params.imageW) / 2;
+    const float yOffset = (params.inputH - scale * params.imageH) / 2;
+    // center and size in grid cells and input pixels
+    const float cx = ((imageBox.x1 + imageBox.x2) / 2 * scale + xOffset) / tensor.stride;
+    const float cy = ((imageBox.y1 + imageBox.y2) / 2 * scale + yOffset) / tensor.stride;
+    const float bw = (imageBox.x2 - imageBox.x1) * scale;
+    const float bh = (imageBox.y2 - imageBox.y1) * scale;
+    const uint x = static_cast<uint>(cx);
+    const uint y = static_cast<uint>(cy);
+    assert((x < tensor.gridW) && (y < tensor.gridH));
+    const uint anchorIdx = isRegion ? anchor : tensor.masks.at(anchor);
+    const float pw = tensor.anchors.at(anchorIdx * 2);
+    const float ph = tensor.anchors.at(anchorIdx * 2 + 1);
+
+    const uint numGridCells = tensor.gridW * tensor.gridH;
+    const uint numChannels = 5 + tensor.numClasses;
+    std::vector<float> activated(tensor.volume, 0.0f);
+    std::vector<float> raw(tensor.volume, -20.0f);
+    auto at = [&](std::vector<float>& t, const uint c) -> float& {
+        return t.at(numGridCells * (anchor * numChannels + c) + y * tensor.gridW + x);
+    };
+    // yolo layers activate w and h with exp, region layers leave it to the decoder
+    at(activated, 0) = cx - x;
+    at(activated, 1) = cy - y;
+    at(activated, 2) = isRegion ? std::log(bw / pw) : bw / pw;
+    at(activated, 3) = isRegion ? std::log(bh / ph) : bh / ph;
+    at(activated, 4) = 0.9f;
+    at(activated, 5 + label) = 0.8f;
+    at(raw, 0) = logit(cx - x);
+    at(raw, 1) = logit(cy - y);
+    at(raw, 2) = std::log(bw / pw);
+    at(raw, 3) = std::log(bh / ph);
+    at(raw, 4) = logit(0.9f);
+    at(raw, 5 + label) = logit(0.8f);
+
+    std::vector<std::pair<TensorDecoder, const std::vector<float>*>> decoders{
+        {getTensorDecoder(tensor, isRegion, false), &activated}};
+    if (!isRegion) decoders.push_back({getTensorDecoder(tensor, isRegion, true), &raw});
+    for (const auto& decoder : decoders)
+    {
+        std::vector<BBoxInfo> binfo;
+        decoder.first(tensor, decoder.second->data(), params, binfo);
+        assert(binfo.size() == 1);
+        const BBoxInfo& decoded = binfo.front();
+        assert(decoded.label == static_cast<int>(label));
+        assert(decoded.classId == params.classIds[label]);
+        assert(isClose(decoded.prob, 0.72f, 1e-5f));
+        assert(std::fabs(decoded.box.x1 - imageBox.x1) < 0.05f);
+        assert(std::fabs(decoded.box.y1 - imageBox.y1) < 0.05f);
+        assert(std::fabs(decoded.box.x2 - imageBox.x2) < 0.05f);
+        assert(std::fabs(decoded.box.y2 - imageBox.y2) < 0.05f);
+    }
+}
+
+void testPlantedBoxRoundTrip(const std::string& cfg, const bool isRegion)
+{
+    // 16:9 input and frames, the letterbox pads 5 rows above and below the image
+    const NetworkDesc network = parseNetworkCfg(g_DataDir + "/" + cfg, 608, 352);
+    const std::vector<int> classIds = getClassIds(80);
+    const DecodeParams params{608, 352, 1280, 720, 0.5f, classIds.data()};
+    const BBox boxes[] = {{500, 250, 700, 370}, {20, 30, 160, 400}, {1000, 600, 1270, 715}};
+    for (const TensorInfo& tensor : getOutputTensors(network, false))
+    {
+        assert(tensor.gridW * tensor.stride == 608);
+        assert(tensor.gridH * tensor.stride == 352);
+        for (uint b = 0; b < tensor.numBBoxes; ++b)
+            for (const BBox& box : boxes) checkPlantedBox(tensor, isRegion, params, box, b, 17);
+    }
+}
+
+void checkTensor(const TensorInfo& tensor, const std::string& blobName, const uint gridW,
+                 const uint gridH, const uint stride, const uint numBBoxes)
+{
+    assert(tensor.blobName == blobName);
+    assert((tensor.gridW == gridW) && (tensor.gridH == gridH));
+    assert(tensor.stride == stride);
+    assert(tensor.numBBoxes == numBBoxes);
+    assert(tensor.numClasses == 80);
+    assert(tensor.volume == static_cast<uint64_t>(gridW) * gridH * numBBoxes * 85);
+    // left for the engine
+    assert(tensor.bindingIndex == -1);
+    assert(tensor.hostBuffer == nullptr);
+}
+
+void testOutputTensors()
+{
+    // region anchors are given in grid cells and scaled to input pixels
+    const NetworkDesc yoloV2 = parseNetworkCfg(g_DataDir + "/yolov2.cfg");
+    std::vector<TensorInfo> tensors = getOutputTensors(yoloV2, false);
+    assert(tensors.size() == 1);
+    checkTensor(tensors.at(0), "region_32", 19, 19, 32, 5);
+    assert(tensors.at(0).masks.empty());
+    const std::vector<float>& cfgAnchors = yoloV2.getLayer(32).detection.anchors;
+    assert(tensors.at(0).anchors.size() == 10);
+    for (uint i = 0; i < cfgAnchors.size(); ++i)
+        assert(tensors.at(0).anchors.at(i) == cfgAnchors.at(i) * 32);
+    assert(tensors.at(0).decoder == getTensorDecoder(tensors.at(0), true, false));
+    // no raw mode for region layers
+    assert(getOutputTensors(yoloV2, true).at(0).decoder == tensors.at(0).decoder);
+
+    // yolo anchors are already in input pixels, each head picks three of them
+    const NetworkDesc yoloV3 = parseNetworkCfg(g_DataDir + "/yolov3.cfg", 608, 352);
+    tensors = getOutputTensors(yoloV3, false);
+    assert(tensors.size() == 3);
+    checkTensor(tensors.at(0), "yolo_83", 19, 11, 32, 3);
+    checkTensor(tensors.at(1), "yolo_95", 38, 22, 16, 3);
+    checkTensor(tensors.at(2), "yolo_107", 76, 44, 8, 3);
+    assert((tensors.at(0).masks == std::vector<uint>{6, 7, 8}));
+    assert((tensors.at(2).masks == std::vector<uint>{0, 1, 2}));
+    for (const TensorInfo& tensor : tensors)
+    {
+        assert(tensor.anchors == yoloV3.getLayer(83).detection.anchors);
+        assert(tensor.anchors.at(0) == 10.0f);
+        assert(tensor.decoder == getTensorDecoder(tensor, false, false));
+    }
+    for (const TensorInfo& tensor : getOutputTensors(yoloV3, true))
+        assert(tensor.decoder == getTensorDecoder(tensor, false, true));
+    assert(getOutputTensors(yoloV3, true).at(0).decoder != tensors.at(0).decoder);
+
+    const std::vector<TensorInfo> tiny
+        = getOutputTensors(parseNetworkCfg(g_DataDir + "/yolov3-tiny.cfg"), false);
+    assert(tiny.size() == 2);
+    checkTensor(tiny.at(0), "yolo_17", 13, 13, 32, 3);
+    checkTensor(tiny.at(1), "yolo_24", 26, 26, 16, 3);
+    assert((tiny.at(1).masks == std::vector<uint>{1, 2, 3}));
+}
+
+void testDecoderSelection()
+{
+    // the decoder only depends on the layer type and the decode mode, not on the head shape
+    const TensorInfo yolo80 = getYoloTensor(13, 13, 32, 80);
+    const TensorInfo yolo20 = getYoloTensor(13, 13, 32, 20);
+    assert(getTensorDecoder(yolo80, false, false) == getTensorDecoder(yolo20, false, false));
+    assert(getTensorDecoder(yolo80, false, true) == getTensorDecoder(yolo20, false, true));
+    assert(getTensorDecoder(yolo80, false, true) != getTensorDecoder(yolo80, false, false));
+
+    // region layers have no raw mode
+    TensorInfo region80 = yolo80;
+    region80.numBBoxes = 5;
+    TensorInfo region20 = yolo20;
+    region20.numBBoxes = 5;
+    assert(getTensorDecoder(region80, true, true) == getTensorDecoder(region80, true, false));
+    assert(getTensorDecoder(region80, true, false) == getTensorDecoder(region20, true, false));
+    assert(getTensorDecoder(region80, true, false) != getTensorDecoder(yolo80, false, false));
+}
+} // namespace
+
+int main(int argc, char** argv)
+{
+    assert((argc == 2) && "usage: yolo_decode_test <dir of the test cfgs>");
+    g_DataDir = argv[1];
+    testOutputTensors();
+    testDecoderSelection();
+    testRawDecode();
+    testPlantedBoxRoundTrip("yolov2.cfg", true);
+    testPlantedBoxRoundTrip("yolov3.cfg", false);
+    testPlantedBoxRoundTrip("yolov3-tiny.cfg", false);
+    std::cout << "yolo_decode_test passed" << std::endl;
+    return 0;
+}